@@ -16,350 +16,836 @@
 /// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
 CS280::AVLMAP::AVLmap()
     : BSTMAP::BSTMAP()
 {}
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief AVLNode constructor
-/// @tparam KEY_TYPE   - The type of key
-/// @tparam VALUE_TYPE - the type of data in the node.
-/// @param k 	       - The key
-/// @param val         - The value
-/// @param p           - The node itself.
-/// @param h 	       - The height of the node.
-/// @param b 	       - the balance of the node.
-/// @param l           - Pointer to the Node to the left of this one.
-/// @param r 	       - Pointer to the Node to the right of this one.
-//-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::AVLMAP::AVLNode::AVLNode(KEY_TYPE k, VALUE_TYPE val, AVLNode* p, int h, int b, AVLNode* l, AVLNode* r)
-    : BSTMAP::Node::Node(k, val, p, h, b, l, r)
+/// @brief AVL map range constructor, the tree BSTmap builds is already balanced.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param first       - Start of a range of (key, value) pairs.
+/// @param last        - End of the range.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+template<typename IT>
+CS280::AVLMAP::AVLmap(IT first, IT last)
+    : BSTMAP::BSTMAP(first, last)
 {}
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Updates the height of an AVLNode
-/// @tparam KEY_TYPE   - The data type of the key
-/// @tparam VALUE_TYPE - The data type of the value
+/// @brief AVL map copy on several threads, heights and balances are copied as they are.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The map to copy.
+/// @param threads     - Number of threads to copy with.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::AVLMAP::AVLmap(const AVLmap& rhs, unsigned threads)
+    : BSTMAP::BSTMAP(rhs, threads)
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief AVL map destructor, the nodes are freed by BSTmap.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::AVLMAP::~AVLmap()
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The pointer that points at a node: its parent's left or right, or the root.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node.
+/// @return Reference to the pointer (Node*&).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node*& CS280::AVLMAP::LinkTo(Node* node)
+{
+	return node->parent ? node->FindNode() : this->pRoot;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Performs left rotation on the passed in node
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node to rotate.
+/// @return The new root of the subtree (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLMAP::AVLNode::AVLNodeHeight()
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::RotateLeft(Node* node)
 {
-    // Add one to the height of the left node.
-    int leftHeight = this->left->height + 1;
-    // Add one to the height of the left node.
-    int rightHeight = this->right->height + 1;
+	Node* pivot = node->right;
 
-    // The height is whichever is greater.
-    this->height = std::max(leftHeight, rightHeight);
+	// The pivot takes the node's place under its parent.
+	LinkTo(node) = pivot;
+	pivot->parent = node->parent;
+
+	// The pivot's left subtree moves over to the node.
+	node->right = pivot->left;
+	if (node->right)
+	{
+		node->right->parent = node;
+	}
+
+	pivot->left = node;
+	node->parent = pivot;
+
+	// The node is below the pivot now, update it first.
+	this->UpdateNode(node);
+	this->UpdateNode(pivot);
+	return pivot;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Updates the balance of an AVLNode
+/// @brief Performs right rotation on the passed in node
 /// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node to rotate.
+/// @return The new root of the subtree (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLMAP::AVLNode::AVLNodeBalance()
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::RotateRight(Node* node)
 {
-    // Add one to the height of the left node.
-    int leftHeight = this->left->height + 1;
-    // Add one to the height of the left node.
-    int rightHeight = this->right->height + 1;
+	Node* pivot = node->left;
+
+	// The pivot takes the node's place under its parent.
+	LinkTo(node) = pivot;
+	pivot->parent = node->parent;
+
+	// The pivot's right subtree moves over to the node.
+	node->left = pivot->right;
+	if (node->left)
+	{
+		node->left->parent = node;
+	}
 
-    this->balance = leftHeight - rightHeight;
+	pivot->right = node;
+	node->parent = pivot;
+
+	// The node is below the pivot now, update it first.
+	this->UpdateNode(node);
+	this->UpdateNode(pivot);
+	return pivot;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Inserts a node into the tree at a specified key
+/// @brief Rotates an unbalanced node back into balance. When the heavy child is
+///        itself balanced (only after an erase) the single rotation is used.
 /// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param insertNode  - The node to be inserted
-/// @param key 		   - The position in the tree to insert at.
-/// @param parent 	   - The parent of the node we are inserting.
-/// @return Pointer to a BSTMAP Node (BSTMAP::Node*).
+/// @param node        - The unbalanced node.
+/// @return The new root of the subtree (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTMAP::Node* CS280::AVLMAP::InsertNode(typename BSTMAP::Node*& insertNode, const KEY_TYPE& key, typename BSTMAP::Node* parent)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Rebalance(Node* node)
 {
-	// Perform normal BST insertion
-	if (insertNode == nullptr)
+	// Left heavy
+	if (node->balance > 1)
 	{
-		insertNode = new typename BSTMAP::Node(key, VALUE_TYPE(), parent);
-		this->size_++;
-		return insertNode;
+		// Left Right case
+		if (node->left->balance < 0)
+		{
+			RotateLeft(node->left);
+		}
+		return RotateRight(node);
 	}
 
-	this->m_Nodes.push_front(static_cast<AVLNode*>(insertNode));
+	// Right heavy, Right Left case
+	if (node->right->balance > 0)
+	{
+		RotateRight(node->right);
+	}
+	return RotateLeft(node);
+}
 
-	// Key is smaller than the node's key 
-	if (key < insertNode->Key())
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Walks up the parent links after an insert or erase below a node, updating
+///        heights and rotating where needed. Stops as soon as a subtree keeps its old
+///        height, nothing above it can have changed.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The lowest node whose subtree changed.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::RebalanceUp(Node* node)
+{
+	while (node)
 	{
-		return InsertNode(insertNode->left, key, insertNode);
+		int oldHeight = node->height;
+		this->UpdateNode(node);
+
+		if (node->balance > 1 || node->balance < -1)
+		{
+			node = Rebalance(node);
+		}
+
+		if (node->height == oldHeight)
+		{
+			return;
+		}
+		node = node->parent;
 	}
-	// Key is greater than the node's key
-	else if (key > insertNode->Key())
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Deletes a node from the tree
+/// @tparam KEY_TYPE 	 - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node 			 - The node to be deleted.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::DeleteNode(Node* node)
+{
+	// Case: left and right, take over the predecessor's key and value and delete it instead.
+	if (node->left && node->right)
 	{
-		return InsertNode(insertNode->right, key, insertNode);
+		Node* predecessor = node->left->last();
+		node->key = std::move(predecessor->key);
+		node->value = std::move(predecessor->value);
+		node = predecessor;
 	}
-	// If the key is the same.
-	else
+
+	// The node has at most one child, which takes its place.
+	Node* child = (node->left) ? node->left : node->right;
+	Node* parent = node->parent;
+	LinkTo(node) = child;
+	if (child)
 	{
-		return insertNode;
-	}  
+		child->parent = parent;
+	}
+
+	this->DestroyNode(node);
+	this->size_--;
+
+	// Every size up to the root shrinks, rebalancing may stop earlier.
+	this->AdjustCounts(parent, -1);
+	RebalanceUp(parent);
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Performs left rotation on the passed in node
+/// @brief Index Operator Overload
+/// @tparam KEY_TYPE   - The data type of the key
+/// @tparam VALUE_TYPE - The data type of value
+/// @param key 		   - The keey to search the tree for
+/// @return A reference to the value in the node with the matching key (VALUE_TYPE)
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+VALUE_TYPE& CS280::AVLMAP::operator[](KEY_TYPE const & key)
+{
+	// Make a copy of the size
+	unsigned int sizeCopy = this->size_;
+
+	// Find the node, insert a new node if the key is not found.
+	Node* node = this->InsertNode(this->pRoot, key, nullptr);
+
+	// If a new node was inserted rebalance above it. Rotations move
+	// the links around but never the node itself.
+	if (this->size_ != sizeCopy)
+	{
+		RebalanceUp(node->parent);
+	}
+
+	return node->Value();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Moves the keys not less than key into a new map. Both maps keep using
+///        the slabs the nodes came from.
 /// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param node        - The node to rotate.
+/// @param key         - The first key that moves.
+/// @return The map with the keys not less than key (AVLmap).
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLMAP::RotateLeft(AVLNode* node)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::AVLMAP CS280::AVLMAP::split(KEY_TYPE const& key)
 {
-	AVLNode* temp = node;
-	node = static_cast<AVLNode*>(node->right);
-	temp->right = node->left;
-	node->left = temp;
-	
-	AVLNode* copy = node;
-	node->parent = temp->parent;
+	AVLmap upper;
+	upper.nodeAlloc_.share(this->nodeAlloc_);
+
+	Node* left;
+	Node* found;
+	Node* right;
+	Split(this->pRoot, key, left, found, right);
+
+	// The key itself goes with the upper half.
+	if (found)
+	{
+		right = Join(nullptr, found, right);
+	}
+
+	std::vector<Node*> none;
+	SetRoot(left, none);
+	upper.SetRoot(right, none);
+	return upper;
+}
 
-	if (temp->right)
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Appends a key and then all of another map, whose keys must all be greater.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - A key greater than every key in this map.
+/// @param value       - The value for key.
+/// @param right       - The map with the greater keys, left empty.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::join(KEY_TYPE const& key, VALUE_TYPE const& value, AVLmap&& right)
+{
+	if (&right == this)
 	{
-		temp->right->parent = temp;
+		return;
 	}
-	
-	temp->parent = node;
-	
-	temp->AVLNodeHeight();
-	temp->AVLNodeBalance();
 
-	copy->AVLNodeHeight();
-	copy->AVLNodeBalance();
+	Node* rightRoot = Adopt(right);
+	Node* middle = this->CreateNode(key, value, nullptr);
 
-	UpdateTreeHeight(copy);
+	std::vector<Node*> none;
+	SetRoot(Join(this->pRoot, middle, rightRoot), none);
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Performs right rotation on the passed in node
+/// @brief Adds the keys of another map that are not in this one.
 /// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param node        - The node to rotate.
+/// @param other       - The other map, left empty.
+/// @param threads     - Most threads to run at once.
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLMAP::RotateRight(AVLNode* node)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::set_union(AVLmap&& other, unsigned threads)
 {
-	AVLNode* temp = node;
-	node = static_cast<AVLNode*>(node->left);
-	temp->left = node->right;
-	node->right = temp;
-	
-	AVLNode* copy = node;
-	node->parent = temp->parent;
+	if (&other == this)
+	{
+		return;
+	}
 
-	if (temp->left)
+	Node* otherRoot = Adopt(other);
+	std::vector<Node*> garbage;
+	SetRoot(Union(this->pRoot, otherRoot, garbage, threads), garbage);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Keeps only the keys that are also in another map.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param other       - The other map, left empty.
+/// @param threads     - Most threads to run at once.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::set_intersection(AVLmap&& other, unsigned threads)
+{
+	if (&other == this)
 	{
-		temp->left->parent = temp;
+		return;
 	}
-	
-	temp->parent = node;
-	
-	temp->AVLNodeHeight();
-	temp->AVLNodeBalance();
 
-	copy->AVLNodeHeight();
-	copy->AVLNodeBalance();
+	Node* otherRoot = Adopt(other);
+	std::vector<Node*> garbage;
+	SetRoot(Intersection(this->pRoot, otherRoot, garbage, threads), garbage);
+}
 
-	UpdateTreeHeight(copy);
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes the keys that are in another map.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param other       - The other map, left empty.
+/// @param threads     - Most threads to run at once.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::set_difference(AVLmap&& other, unsigned threads)
+{
+	if (&other == this)
+	{
+		this->ClearTree();
+		return;
+	}
+
+	Node* otherRoot = Adopt(other);
+	std::vector<Node*> garbage;
+	SetRoot(Difference(this->pRoot, otherRoot, garbage, threads), garbage);
 }
 
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Checks the tree is a consistent AVL tree.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return True if it is (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::AVLMAP::sanityCheck() const
+{
+	return this->CheckTree(true);
+}
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Deletes a node from the tree
-/// @tparam KEY_TYPE 	 - The data type of the key.
+/// @brief Height of a subtree, -1 when it is empty.
+/// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param node 			 - The node to be deleted.
+/// @param node        - The subtree, may be null.
+/// @return The height (int).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+int CS280::AVLMAP::Height(const Node* node)
+{
+	return node ? node->height : -1;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Makes a node the parent of two subtrees.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param left        - The new left subtree, may be null.
+/// @param node        - The node.
+/// @param right       - The new right subtree, may be null.
+/// @return The node (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Link(Node* left, Node* node, Node* right)
+{
+	node->left = left;
+	node->right = right;
+	if (left)
+	{
+		left->parent = node;
+	}
+	if (right)
+	{
+		right->parent = node;
+	}
+	BSTMAP::UpdateNode(node);
+	return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Left rotation of a detached subtree.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The root of the subtree.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::RotateSubtreeLeft(Node* node)
+{
+	Node* pivot = node->right;
+	Link(node->left, node, pivot->left);
+	return Link(node, pivot, pivot->right);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Right rotation of a detached subtree.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The root of the subtree.
+/// @return The new root of the subtree (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLMAP::DeleteNode(typename BSTMAP::Node* node)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::RotateSubtreeRight(Node* node)
 {
-	typename BSTMAP::Node* parentNode = node->parent;
-	while (parentNode)
+	Node* pivot = node->left;
+	Link(pivot->right, node, node->right);
+	return Link(pivot->left, pivot, node);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Joins two AVL trees around a middle node, every key of left is less than
+///        the node's and every key of right greater. O(difference in height).
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param left        - The smaller keys, may be null.
+/// @param node        - The middle node.
+/// @param right       - The greater keys, may be null.
+/// @return The root of the joined tree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Join(Node* left, Node* node, Node* right)
+{
+	if (Height(left) > Height(right) + 1)
 	{
-		this->m_Nodes.push_front(static_cast<AVLNode*>(parentNode));
-		parentNode = parentNode->parent;
+		return JoinRight(left, node, right);
 	}
+	if (Height(right) > Height(left) + 1)
+	{
+		return JoinLeft(left, node, right);
+	}
+	return Link(left, node, right);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Join when left is the taller tree: walks down the right spine of left
+///        to a subtree about as tall as right and rebalances on the way back up.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param left        - The taller tree.
+/// @param node        - The middle node.
+/// @param right       - The shorter tree, may be null.
+/// @return The root of the joined tree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::JoinRight(Node* left, Node* node, Node* right)
+{
+	Node* outer = left->left;
+	Node* inner = left->right;
 
-  // Base Case: No left or right
-	if (!node->right && !node->left)
+	if (Height(inner) <= Height(right) + 1)
 	{
-		// If the node is not pRoot
-		if (node != this->pRoot)
+		Node* joined = Link(inner, node, right);
+		if (Height(joined) <= Height(outer) + 1)
 		{
-			// Find the address of the node.
-			typename BSTMAP::Node*& newNode = node->FindNode();
-			newNode = nullptr;
+			return Link(outer, left, joined);
 		}
-		else
+		// Two taller than the other side: double rotation.
+		return RotateSubtreeLeft(Link(outer, left, RotateSubtreeRight(joined)));
+	}
+
+	Node* joined = JoinRight(inner, node, right);
+	Node* result = Link(outer, left, joined);
+	return (Height(joined) <= Height(outer) + 1) ? result : RotateSubtreeLeft(result);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Join when right is the taller tree, the mirror of JoinRight.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param left        - The shorter tree, may be null.
+/// @param node        - The middle node.
+/// @param right       - The taller tree.
+/// @return The root of the joined tree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::JoinLeft(Node* left, Node* node, Node* right)
+{
+	Node* inner = right->left;
+	Node* outer = right->right;
+
+	if (Height(inner) <= Height(left) + 1)
+	{
+		Node* joined = Link(left, node, inner);
+		if (Height(joined) <= Height(outer) + 1)
 		{
-			this->pRoot = nullptr;
+			return Link(joined, right, outer);
 		}
-		delete node;
-		this->size_--;
+		// Two taller than the other side: double rotation.
+		return RotateSubtreeRight(Link(RotateSubtreeLeft(joined), right, outer));
+	}
+
+	Node* joined = JoinLeft(left, node, inner);
+	Node* result = Link(joined, right, outer);
+	return (Height(joined) <= Height(outer) + 1) ? result : RotateSubtreeRight(result);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Joins two AVL trees without a middle node, the last node of left is used.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param left        - The smaller keys, may be null.
+/// @param right       - The greater keys, may be null.
+/// @return The root of the joined tree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Join2(Node* left, Node* right)
+{
+	if (!left)
+	{
+		return right;
+	}
+	Node* last;
+	Node* rest = SplitLast(left, last);
+	return Join(rest, last, right);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Takes the node with the greatest key out of an AVL tree.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The tree, not null.
+/// @param last        - Set to the removed node.
+/// @return The root of the remaining tree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::SplitLast(Node* tree, Node*& last)
+{
+	if (!tree->right)
+	{
+		last = tree;
+		return tree->left;
+	}
+	Node* rest = SplitLast(tree->right, last);
+	return Join(tree->left, tree, rest);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Splits an AVL tree into the keys less than key, the node with key and the
+///        keys greater than key. O(height).
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The tree, may be null.
+/// @param key         - The key to split at.
+/// @param left        - Set to the tree of smaller keys.
+/// @param found       - Set to the node with key (its links are stale), or null.
+/// @param right       - Set to the tree of greater keys.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::Split(Node* tree, KEY_TYPE const& key, Node*& left, Node*& found, Node*& right)
+{
+	if (!tree)
+	{
+		left = found = right = nullptr;
+		return;
+	}
+
+	Node* treeLeft = tree->left;
+	Node* treeRight = tree->right;
+	if (key < tree->key)
+	{
+		Node* between;
+		Split(treeLeft, key, left, found, between);
+		right = Join(between, tree, treeRight);
 	}
-	// Case: left and right
-	else if(node->right && node->left)
+	else if (tree->key < key)
 	{
-		// Get this node's successor
-		typename BSTMAP::Node* successor = node->decrement();
-		// Copy the key and value from the successor into the current node.
-		node->key = successor->Key();
-		node->value = successor->Value();
-		// Delete the successor.
-		DeleteNode(successor);
+		Node* between;
+		Split(treeRight, key, between, found, right);
+		left = Join(treeLeft, tree, between);
 	}
 	else
 	{
-		// The child is determined by the node having a left or right.
-		typename BSTMAP::Node* child = (node->left) ? node->left : node->right;
+		left = treeLeft;
+		found = tree;
+		right = treeRight;
+	}
+}
 
-		// If the node is not the pRoot
-		if (node != this->pRoot)
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Adds every node of a subtree to the nodes to destroy.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The subtree, may be null.
+/// @param garbage     - The nodes to destroy.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::Discard(Node* tree, std::vector<Node*>& garbage)
+{
+	if (!tree)
+	{
+		return;
+	}
+
+	// The garbage list doubles as the work list.
+	std::size_t next = garbage.size();
+	garbage.push_back(tree);
+	for (; next < garbage.size(); ++next)
+	{
+		Node* node = garbage[next];
+		if (node->left)
 		{
-			// Get the address of the node.
-			typename BSTMAP::Node*& newNode = node->FindNode();
-			// Set the child to that address.
-			newNode = child;
-			// Update the parents
-			child->parent = node->parent;
+			garbage.push_back(node->left);
 		}
-		else
+		if (node->right)
 		{
-			// Set pRoot to the child.
-			this->pRoot = child;
+			garbage.push_back(node->right);
 		}
-		// Delete the node.
-		delete node;
-		// Decrement the amount of nodes in the tree.
-		this->size_--;
 	}
+}
 
-	// If the stack is not empty update all the nodes on it.
-	while (this->m_Nodes.empty() == false)
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Runs two tasks, the first on a new thread when parallel is set.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam LEFT       - The first task.
+/// @tparam RIGHT      - The second task.
+/// @param parallel    - Whether to run the tasks at the same time.
+/// @param left        - The first task.
+/// @param right       - The second task.
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+template<typename LEFT, typename RIGHT>
+void CS280::AVLMAP::ForkJoin(bool parallel, LEFT left, RIGHT right)
+{
+	if (parallel)
+	{
+		std::thread helper(left);
+		right();
+		helper.join();
+	}
+	else
 	{
-		// Get the node from the stack.
-		AVLNode* stackNode = this->m_Nodes[0];
-		this->m_Nodes.pop_front();
+		left();
+		right();
+	}
+}
 
-		// Update height and balance
-		stackNode->AVLNodeHeight();
-		stackNode->AVLNodeBalance();
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Union of two AVL trees: splits tree at the root of other and unites the
+///        halves (in parallel for big inputs). A key in both keeps the node of tree.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The first tree, may be null.
+/// @param other       - The second tree, may be null.
+/// @param garbage     - Collects the nodes to destroy (the pool is not thread safe).
+/// @param threads     - Most threads to run at once.
+/// @return The root of the union (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Union(Node* tree, Node* other, std::vector<Node*>& garbage, unsigned threads)
+{
+	if (!tree)
+	{
+		return other;
+	}
+	if (!other)
+	{
+		return tree;
+	}
 
-		typename BSTMAP::Node*& r_node = stackNode->FindNode();
+	bool parallel = threads > 1 && tree->count + other->count >= BSTMAP::ParallelGrain;
+	Node* otherLeft = other->left;
+	Node* otherRight = other->right;
 
-		// Right Right case
-		if (r_node->balance > 1 && r_node->left->balance >= 0)
-		{
-			RotateRight(static_cast<AVLNode*>(r_node));
-		}
-		// Left Left case
-		else if (r_node->balance < -1 && r_node->right->balance <= 0)
-		{
-			RotateLeft(static_cast<AVLNode*>(r_node));
-		}
-		// Right Left case
-		else if (r_node->balance > 1 && r_node->left->balance < 0)
-		{
-			RotateLeft(static_cast<AVLNode*>(r_node->left));
-			RotateRight(static_cast<AVLNode*>(r_node));
-		}
-		// Left Right case
-		else if (r_node->balance < -1 && r_node->right->balance > 0)
-		{
-			RotateRight(static_cast<AVLNode*>(r_node->right));
-			RotateLeft(static_cast<AVLNode*>(r_node));
-		}
+	Node* left;
+	Node* found;
+	Node* right;
+	Split(tree, other->key, left, found, right);
+
+	Node* middle = other;
+	if (found)
+	{
+		garbage.push_back(other);
+		middle = found;
 	}
+
+	std::vector<Node*> leftGarbage;
+	ForkJoin(parallel,
+		[&]() { left = Union(left, otherLeft, leftGarbage, threads / 2); },
+		[&]() { right = Union(right, otherRight, garbage, threads - threads / 2); });
+	garbage.insert(garbage.end(), leftGarbage.begin(), leftGarbage.end());
+
+	return Join(left, middle, right);
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Index Operator Overload
-/// @tparam KEY_TYPE   - The data type of the key
-/// @tparam VALUE_TYPE - The data type of value
-/// @param key 		   - The keey to search the tree for
-/// @return A reference to the value in the node with the matching key (VALUE_TYPE)
+/// @brief Intersection of two AVL trees, the nodes of tree are kept.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The first tree, may be null.
+/// @param other       - The second tree, may be null.
+/// @param garbage     - Collects the nodes to destroy.
+/// @param threads     - Most threads to run at once.
+/// @return The root of the intersection (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-VALUE_TYPE& CS280::AVLMAP::operator[](KEY_TYPE const & key)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Intersection(Node* tree, Node* other, std::vector<Node*>& garbage, unsigned threads)
 {
-	// Make a copy of the size
-	unsigned int sizeCopy = this->size();
+	if (!tree || !other)
+	{
+		Discard(tree, garbage);
+		Discard(other, garbage);
+		return nullptr;
+	}
 
-	// Find the node, insert a new node if the key is not found.
-	VALUE_TYPE& value = InsertNode(this->pRoot, key, this->end())->Value();
+	bool parallel = threads > 1 && tree->count + other->count >= BSTMAP::ParallelGrain;
+	Node* otherLeft = other->left;
+	Node* otherRight = other->right;
 
-	// If a new node was inserted
-	if (sizeCopy == this->size() - 1)
+	Node* left;
+	Node* found;
+	Node* right;
+	Split(tree, other->key, left, found, right);
+	garbage.push_back(other);
+
+	std::vector<Node*> leftGarbage;
+	ForkJoin(parallel,
+		[&]() { left = Intersection(left, otherLeft, leftGarbage, threads / 2); },
+		[&]() { right = Intersection(right, otherRight, garbage, threads - threads / 2); });
+	garbage.insert(garbage.end(), leftGarbage.begin(), leftGarbage.end());
+
+	return found ? Join(left, found, right) : Join2(left, right);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The keys of tree that are not in other.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The first tree, may be null.
+/// @param other       - The keys to remove, may be null.
+/// @param garbage     - Collects the nodes to destroy.
+/// @param threads     - Most threads to run at once.
+/// @return The root of the difference (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Difference(Node* tree, Node* other, std::vector<Node*>& garbage, unsigned threads)
+{
+	if (!tree)
 	{
-		// If the stack is not empty update all the nodes on it.
-		while (this->m_Nodes.empty() == false)
-		{
-			// Get the node from the stack.
-			AVLNode* stackNode = this->m_Nodes[0];
-			this->m_Nodes.pop_front();
-
-			// Update height and balance
-			stackNode->AVLNodeHeight();
-			stackNode->AVLNodeBalance();
-
-			typename BSTMAP::Node*& r_node = stackNode->FindNode();
-
-			// Right Right case
-			if (r_node->balance > 1 && r_node->left->balance >= 0)
-			{
-				RotateRight(static_cast<AVLNode*>(r_node));
-			}
-			// Left Left case
-			else if (r_node->balance < -1 && r_node->right->balance <= 0)
-			{
-				RotateLeft(static_cast<AVLNode*>(r_node));
-			}
-			// Right Left case
-			else if (r_node->balance > 1 && r_node->left->balance < 0)
-			{
-				RotateLeft(static_cast<AVLNode*>(r_node->left));
-				RotateRight(static_cast<AVLNode*>(r_node));
-			}
-			// Left Right case
-			else if (r_node->balance < -1 && r_node->right->balance > 0)
-			{
-				RotateRight(static_cast<AVLNode*>(r_node->right));
-				RotateLeft(static_cast<AVLNode*>(r_node));
-			}
-		}
+		Discard(other, garbage);
+		return nullptr;
+	}
+	if (!other)
+	{
+		return tree;
 	}
 
-	// Empty the stack
-	this->m_Nodes.clear();
-	return value;
+	bool parallel = threads > 1 && tree->count + other->count >= BSTMAP::ParallelGrain;
+	Node* otherLeft = other->left;
+	Node* otherRight = other->right;
+
+	Node* left;
+	Node* found;
+	Node* right;
+	Split(tree, other->key, left, found, right);
+	garbage.push_back(other);
+	if (found)
+	{
+		garbage.push_back(found);
+	}
+
+	std::vector<Node*> leftGarbage;
+	ForkJoin(parallel,
+		[&]() { left = Difference(left, otherLeft, leftGarbage, threads / 2); },
+		[&]() { right = Difference(right, otherRight, garbage, threads - threads / 2); });
+	garbage.insert(garbage.end(), leftGarbage.begin(), leftGarbage.end());
+
+	return Join2(left, right);
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Update the height of a sub-tree
-/// @tparam KEY_TYPE   - The data type of the key
-/// @tparam VALUE_TYPE - the data type of the value
-/// @param tree 	   - the node to start updating from
+/// @brief Takes the tree of another map and keeps its slabs alive, the other map
+///        is left empty.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param other       - The other map.
+/// @return The root of the other map's tree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::AVLMAP::Node* CS280::AVLMAP::Adopt(AVLmap& other)
+{
+	this->nodeAlloc_.share(other.nodeAlloc_);
+	Node* root = other.pRoot;
+	other.pRoot = nullptr;
+	other.ClearTree();
+	return root;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Installs the result of a join based operation and destroys the nodes it dropped.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param root        - The new root, may be null.
+/// @param garbage     - The nodes to destroy.
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::AVLMAP::UpdateTreeHeight(AVLNode* tree)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::AVLMAP::SetRoot(Node* root, std::vector<Node*> const& garbage)
 {
-	while (tree->parent)
+	if (root)
 	{
-		tree = static_cast<AVLNode*>(tree->parent);
-		tree->AVLNodeHeight();
-		tree->AVLNodeBalance();
+		root->parent = nullptr;
 	}
-}
\ No newline at end of file
+	this->pRoot = root;
+	this->size_ = root ? root->count : 0;
+
+	for (Node* node : garbage)
+	{
+		this->DestroyNode(node);
+	}
+}
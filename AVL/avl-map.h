@@ -11,8 +11,9 @@
 
 #include "bst-map.h" // Inheriting from BST
 #include <algorithm> // std::max
+#include <utility>   // std::move
 #include <vector>    // std::vector
-#include <deque>     // std::deque
+#include <thread>    // std::thread
 
 #ifndef AVLMAP_H
 #define AVLMAP_H
@@ -20,33 +21,71 @@
 
 namespace CS280
 {
-    template <typename KEY_TYPE, typename VALUE_TYPE>
-    #define BSTMAP BSTmap<KEY_TYPE, VALUE_TYPE>
-    #define AVLMAP AVLmap<KEY_TYPE, VALUE_TYPE>
-    class AVLmap : public BSTmap <KEY_TYPE, VALUE_TYPE>
+    template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC = BSTNodePool>
+    #define BSTMAP BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>
+    #define AVLMAP AVLmap<KEY_TYPE, VALUE_TYPE, ALLOC>
+    class AVLmap : public BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>
     {
         public:
             AVLmap();
+            template <typename IT>
+            AVLmap(IT first, IT last);
+            AVLmap(const AVLmap& rhs) = default;
+            AVLmap(const AVLmap& rhs, unsigned threads);
+            AVLmap& operator=(const AVLmap& rhs) = default;
+            AVLmap(AVLmap&& rhs) = default;
+            AVLmap& operator=(AVLmap&& rhs) = default;
             VALUE_TYPE& operator[](KEY_TYPE const& key) override;
             ~AVLmap();
 
-            class AVLNode : public BSTMAP::Node
-            {
-                public:
-                AVLNode(KEY_TYPE k, VALUE_TYPE val, AVLNode* p, int h = 0, int b = 0, AVLNode* l = nullptr, AVLNode* r = nullptr);
-                void AVLNodeHeight();
-                void AVLNodeBalance();
-            };
-        
-        private:
-            std::deque <AVLNode*> m_Nodes = {};
+            // Moves the keys not less than key into the returned map, O(log n).
+            AVLmap split(KEY_TYPE const& key);
+            // Appends key and then every key of right, O(log n). Every key here
+            // must be less than key and key less than every key of right.
+            void join(KEY_TYPE const& key, VALUE_TYPE const& value, AVLmap&& right);
+
+            // Set operations that take the nodes of other and leave it empty,
+            // O(m log(n/m + 1)) for sizes m <= n. Subproblems of at least
+            // ParallelGrain keys run on new threads while threads > 1. A key
+            // in both maps keeps the value it has in this map.
+            void set_union(AVLmap&& other, unsigned threads = 1);
+            void set_intersection(AVLmap&& other, unsigned threads = 1);
+            void set_difference(AVLmap&& other, unsigned threads = 1);
+
+            // BSTmap::sanityCheck, and also that the heights and balances are
+            // right and no balance is more than 1 either way, O(n).
+            bool sanityCheck() const;
+
         protected:
-            typename BSTMAP::Node* InsertNode(typename BSTMAP::Node*& insertNode, const KEY_TYPE& key, typename BSTMAP::Node* parent) override;
-            void DeleteNode(typename BSTMAP::Node* node) override;
-            void RotateLeft(AVLNode* node);
-            void RotateRight(AVLNode* node);
-            void UpdateTreeHeight(AVLNode* tree);
-            typename BSTMAP::Node*& FindSuccessor(AVLNode* node);
+            typedef typename BSTMAP::Node Node;
+
+            void DeleteNode(Node* node) override;
+            Node* RotateLeft(Node* node);
+            Node* RotateRight(Node* node);
+            Node* Rebalance(Node* node);
+            void RebalanceUp(Node* node);
+            Node*& LinkTo(Node* node);
+
+            // Join based algorithms on detached subtrees. They only use the
+            // children links, the parent of a returned root is left stale.
+            static int Height(const Node* node);
+            static Node* Link(Node* left, Node* node, Node* right);
+            static Node* RotateSubtreeLeft(Node* node);
+            static Node* RotateSubtreeRight(Node* node);
+            static Node* Join(Node* left, Node* node, Node* right);
+            static Node* JoinRight(Node* left, Node* node, Node* right);
+            static Node* JoinLeft(Node* left, Node* node, Node* right);
+            static Node* Join2(Node* left, Node* right);
+            static Node* SplitLast(Node* tree, Node*& last);
+            static void Split(Node* tree, KEY_TYPE const& key, Node*& left, Node*& found, Node*& right);
+            static void Discard(Node* tree, std::vector<Node*>& garbage);
+            template <typename LEFT, typename RIGHT>
+            static void ForkJoin(bool parallel, LEFT left, RIGHT right);
+            static Node* Union(Node* tree, Node* other, std::vector<Node*>& garbage, unsigned threads);
+            static Node* Intersection(Node* tree, Node* other, std::vector<Node*>& garbage, unsigned threads);
+            static Node* Difference(Node* tree, Node* other, std::vector<Node*>& garbage, unsigned threads);
+            Node* Adopt(AVLmap& other);
+            void SetRoot(Node* root, std::vector<Node*> const& garbage);
     };
 }
 
@@ -10,23 +10,144 @@
 ///---------------------------------------------------------------------------
 #include "bst-map.h"
 
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Move constructor for the node pool, takes the slabs of the other pool.
+/// @tparam NODE - The node type.
+/// @param rhs   - The pool to take the slabs from.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename NODE>
+CS280::BSTNodePool<NODE>::BSTNodePool(BSTNodePool &&rhs)
+	: slabs_(std::move(rhs.slabs_))
+	, free_(rhs.free_)
+	, next_(rhs.next_)
+	, end_(rhs.end_)
+	, slabNodes_(rhs.slabNodes_)
+{
+	rhs.slabs_.clear();
+	rhs.free_ = nullptr;
+	rhs.next_ = rhs.end_ = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Move assignment for the node pool, frees this pool's slabs and takes the other's.
+/// @tparam NODE - The node type.
+/// @param rhs   - The pool to take the slabs from.
+/// @return Reference to this pool (BSTNodePool&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename NODE>
+CS280::BSTNodePool<NODE> &CS280::BSTNodePool<NODE>::operator=(BSTNodePool &&rhs)
+{
+	if (this != &rhs)
+	{
+		release();
+		std::swap(slabs_, rhs.slabs_);
+		std::swap(free_, rhs.free_);
+		std::swap(next_, rhs.next_);
+		std::swap(end_, rhs.end_);
+		std::swap(slabNodes_, rhs.slabNodes_);
+	}
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Storage for one node: from the free list, the current slab, or a new slab.
+/// @tparam NODE - The node type.
+/// @return Uninitialised storage for a NODE (void*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename NODE>
+void *CS280::BSTNodePool<NODE>::allocate()
+{
+	// Reuse a freed node first.
+	if (free_)
+	{
+		void *node = free_;
+		free_ = *static_cast<void **>(node);
+		return node;
+	}
+
+	// Start a new slab when the current one is used up.
+	if (next_ == end_)
+	{
+		static_assert(alignof(NODE) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "slabs come from plain operator new");
+		char *memory = static_cast<char *>(::operator new(slabNodes_ * sizeof(NODE)));
+		slabs_.emplace_back(memory, [](void *slab) { ::operator delete(slab); });
+		next_ = memory;
+		end_ = next_ + slabNodes_ * sizeof(NODE);
+		if (slabNodes_ < MaxSlabNodes)
+		{
+			slabNodes_ *= 2;
+		}
+	}
+
+	void *node = next_;
+	next_ += sizeof(NODE);
+	return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Puts the storage of a destroyed node on the free list.
+/// @tparam NODE - The node type.
+/// @param node  - The node storage.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename NODE>
+void CS280::BSTNodePool<NODE>::deallocate(void *node)
+{
+	static_assert(sizeof(NODE) >= sizeof(void *), "the free list is kept inside the nodes");
+	*static_cast<void **>(node) = free_;
+	free_ = node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Lets go of every slab at once, the slabs no other pool shares are freed.
+/// @tparam NODE - The node type.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename NODE>
+void CS280::BSTNodePool<NODE>::release()
+{
+	slabs_.clear();
+	free_ = nullptr;
+	next_ = end_ = nullptr;
+	slabNodes_ = 32;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Shares the slabs of another pool. Only the pool that made a slab carves
+///        new nodes out of it, so sharing never hands out the same storage twice.
+/// @tparam NODE - The node type.
+/// @param other - The pool whose slabs must outlive its nodes in this pool's map.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename NODE>
+void CS280::BSTNodePool<NODE>::share(const BSTNodePool &other)
+{
+	if (this != &other)
+	{
+		slabs_.insert(slabs_.end(), other.slabs_.begin(), other.slabs_.end());
+
+		// Maps that split and join repeatedly would otherwise pile up copies.
+		auto address = [](const std::shared_ptr<void> &lhs, const std::shared_ptr<void> &rhs) { return lhs.get() < rhs.get(); };
+		auto same = [](const std::shared_ptr<void> &lhs, const std::shared_ptr<void> &rhs) { return lhs.get() == rhs.get(); };
+		std::sort(slabs_.begin(), slabs_.end(), address);
+		slabs_.erase(std::unique(slabs_.begin(), slabs_.end(), same), slabs_.end());
+	}
+}
+
 // static data members
-template< typename KEY_TYPE, typename VALUE_TYPE >
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator        
-		CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::end_it        = CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator(nullptr);
+template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator        
+		CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::end_it        = CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator(nullptr);
 
-template< typename KEY_TYPE, typename VALUE_TYPE >
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const  
-		CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::const_end_it  = CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const(nullptr);
+template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const  
+		CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::const_end_it  = CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const(nullptr);
 
 ////////////////////////////////////////////////////////////
 // typename is used to help compiler to parse
-template< typename KEY_TYPE, typename VALUE_TYPE >
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::begin()
+template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::begin()
 {
 	if (pRoot)
 	{
-		return BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator(pRoot->first());
+		return BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator(pRoot->first());
 	}
 	else
 	{
@@ -40,8 +161,8 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_T
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return Iterator to the last node in the tree (BSTmap_iterator).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_TYPE,  VALUE_TYPE>::end()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::end()
 {
 	return end_it;
 }
@@ -53,8 +174,8 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_T
 /// @param key 				 - The key to search for.
 /// @return An iterator to the node at the key (BSTmap_iterator).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const &key)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::find(KEY_TYPE const &key)
 {
 	Node* temp = pRoot;
 
@@ -74,7 +195,7 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_T
 		// If the key matches return an iterator to the node.
 		else
 		{
-			return BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator(temp);
+			return BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator(temp);
 		}
 	}
 
@@ -88,8 +209,8 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_T
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @param it 				 - Iterator to the node we want to erase.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::erase(BSTmap_iterator it)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::erase(BSTmap_iterator it)
 {
 	// If the iterator is at the end.
 	if (it == end_it)
@@ -106,36 +227,29 @@ void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::erase(BSTmap_iterator it)
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return Const iterator to the first node in the tree (BSTmap_iterator_const).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::begin() const
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::begin() const
 {
 	if (pRoot)
 	{
-		return BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const(pRoot->first());
+		return BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const(pRoot->first());
 	}
 	else
 	{
-		return end_it;
+		return const_end_it;
 	}
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Const Iterator to the last node in the tree.
+/// @brief Const Iterator past the last node in the tree.
 /// @tparam KEY_TYPE   - The data type of the key
 /// @tparam VALUE_TYPE - The data type of the value
-/// @return A const iterator to the last node in the tree (BSTmap_iterator_const).
+/// @return A const iterator past the last node in the tree (BSTmap_iterator_const).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::end() const
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::end() const
 {
-	if (pRoot)
-	{
-		return BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const(pRoot->last());
-	}
-	else
-	{
-		return end_it;
-	}
+	return const_end_it;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
@@ -145,8 +259,8 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap
 /// @param key 				 - The key to search for.
 /// @return A constant iterator to the node at the key (BSTmap_iterator_const).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const &key) const
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::find(KEY_TYPE const &key) const
 {
 	Node* temp = pRoot;
 
@@ -166,12 +280,12 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap
 		// If the key matches return an iterator to the node.
 		else
 		{
-			return BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const(temp);
+			return BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const(temp);
 		}
 	}
 
 	// If the tree is empty return null.
-	return end_it;
+	return const_end_it;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
@@ -186,12 +300,13 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap
 /// @param l   - Pointer to the Node to the left of this one.
 /// @param r 	 - Pointer to the Node to the right of this one.
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::Node(KEY_TYPE k, VALUE_TYPE val, Node * p, int h, int b, Node * l, Node * r)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::Node(KEY_TYPE k, VALUE_TYPE val, Node * p, int h, int b, Node * l, Node * r)
 	: key(k)
 	, value(val)
 	, height(h)
 	, balance(b)
+	, count(1)
 	, parent(p)
 	, left(l)
 	, right(r)
@@ -203,8 +318,8 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::Node(KEY_TYPE k, VALUE_TYPE val, Node
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return The key of the node (KEY_TYPE)
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-KEY_TYPE const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::Key() const { return key; }
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+KEY_TYPE const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::Key() const { return key; }
 
 //-------------------------------------------------------------------------------------------------------------------------
 /// @brief Get the data of the node.
@@ -212,8 +327,8 @@ KEY_TYPE const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::Key() const { return
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return The data in the node (VALUE_TYPE).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-VALUE_TYPE &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::Value() { return value; }
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+VALUE_TYPE &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::Value() { return value; }
 
 //-------------------------------------------------------------------------------------------------------------------------
 /// @brief Get the left-most node.
@@ -221,8 +336,8 @@ VALUE_TYPE &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::Value() { return value; }
 /// @tparam VALUE_TYPE - The data type of the value in the node.
 /// @return Pointer to the left-most node (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::first()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::first()
 {
 	Node* temp = this;
 
@@ -241,8 +356,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALU
 /// @tparam VALUE_TYPE - The data type of the data.
 /// @return The right-most node (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::last()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::last()
 {
 	Node* temp = this; 
 
@@ -261,8 +376,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALU
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return This node's immediate successor (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::increment()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::increment()
 {
 	// Temp node for traversing the search tree.
 	Node* current = nullptr;
@@ -291,8 +406,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALU
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return This node's immediate predecessor (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::decrement()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::decrement()
 {
 	// Temp node for traversing the search tree.
 	Node* current = nullptr;
@@ -321,8 +436,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALU
 /// @tparam VALUE_TYPE - The data type of value.
 /// @param os 		   - Output stream
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::print(std::ostream& os) const{}
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::print(std::ostream& os) const{}
 
 //-------------------------------------------------------------------------------------------------------------------------
 /// @brief Finds a node's parent's left or right.
@@ -330,8 +445,8 @@ void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::print(std::ostream& os) const{}
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return A pointer to the node.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *&CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node::FindNode()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *&CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node::FindNode()
 {
 	// Check if the node has any family.
   	if (this->parent->right == this)
@@ -353,8 +468,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *&CS280::BSTmap<KEY_TYPE, VAL
 /// @param rhs 				 - A reference to another iterator.
 /// @return A reference to BSTmap iterator.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator& CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator=(const CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator& CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator=(const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator &rhs)
 {
 	// Copy the data from the other iterator.
 	p_node = rhs.p_node;
@@ -367,8 +482,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator& CS280::BSTmap<KEY
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return A reference to a BSTmap_iterator.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator& CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator++()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator& CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator++()
 {
   p_node = p_node->increment();
 	return *this;
@@ -381,8 +496,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator& CS280::BSTmap<KEY
 /// @param - Marks this as postfix.
 /// @return A BSTmap_iterator.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator++(int)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator++(int)
 {
 	// Make a copy of the iterator.
 	BSTmap_iterator iter(p_node);
@@ -398,8 +513,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator CS280::BSTmap<KEY_
 /// @tparam VALUE_TYPE - The data type of the key
 /// @return A BSTmap node (Node).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator*()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator*()
 {
   return *p_node;
 }
@@ -410,8 +525,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node &CS280::BSTmap<KEY_TYPE, VALU
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return Pointer to the node the iterator is at (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator->()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator->()
 {
   return p_node;
 }
@@ -423,8 +538,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node *CS280::BSTmap<KEY_TYPE, VALU
 /// @param rhs 				 - The iterator containing the node to check.
 /// @return The result of the comparison (bool).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator!=(const BSTmap_iterator &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator!=(const BSTmap_iterator &rhs)
 {
   return (p_node != rhs.p_node);
 }
@@ -436,8 +551,8 @@ bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator!=(const BSTm
 /// @param rhs 				 - The iterator containing the node to check.
 /// @return The result of the comparison (bool).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator==(const BSTmap_iterator &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator::operator==(const BSTmap_iterator &rhs)
 {
   return (p_node == rhs.p_node);
 }
@@ -448,8 +563,8 @@ bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator::operator==(const BSTm
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @param p 					 - The node the iterator points too.
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::BSTmap_iterator_const(Node * p)
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::BSTmap_iterator_const(Node * p)
 	: p_node(p)
 {}
 
@@ -460,8 +575,8 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::BSTmap_iterator_cons
 /// @param rhs 				 - A reference to another iterator.
 /// @return A reference to BSTmap iterator.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator=(const BSTmap_iterator_const &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator=(const BSTmap_iterator_const &rhs)
 {
   // Copy the data from the other iterator.
 	p_node = rhs.p_node;
@@ -474,8 +589,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const &CS280::BSTm
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return A reference to a BSTmap_iterator.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator++()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator++()
 {
     p_node = p_node->increment();
 	return *this;
@@ -488,8 +603,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const &CS280::BSTm
 /// @param - Marks this as postfix.
 /// @return A BSTmap_iterator.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator++(int)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator++(int)
 {
 	BSTmap_iterator_const copy(p_node);
 	// Increment p_node.
@@ -503,8 +618,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const CS280::BSTma
 /// @tparam VALUE_TYPE - The data type of the key
 /// @return A BSTmap node (Node).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator*()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node const &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator*()
 {
   return *p_node;
 }
@@ -515,8 +630,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node const &CS280::BSTmap<KEY_TYPE
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @return Pointer to the node the iterator is at (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node const *CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator->()
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node const *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator->()
 {
   return p_node;
 }
@@ -528,8 +643,8 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node const *CS280::BSTmap<KEY_TYPE
 /// @param rhs 				 - The iterator containing the node to check.
 /// @return The result of the comparison (bool).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator!=(const BSTmap_iterator_const &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator!=(const BSTmap_iterator_const &rhs)
 {
   return (p_node != rhs.p_node);
 }
@@ -541,8 +656,8 @@ bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator!=(cons
 /// @param rhs 				 - The iterator containing the node to check.
 /// @return The result of the comparison (bool).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator==(const BSTmap_iterator_const &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const::operator==(const BSTmap_iterator_const &rhs)
 {
   return (p_node == rhs.p_node);
 }
@@ -552,8 +667,8 @@ bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap_iterator_const::operator==(cons
 /// @tparam KEY_TYPE 	 - The data type of the key
 /// @tparam VALUE_TYPE - The data type of the value.
 //-------------------------------------------------------------------------------------------------------------------------
-template<typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap(){}
+template<typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap(){}
 
 //-------------------------------------------------------------------------------------------------------------------------
 /// @brief Get the height of a node.
@@ -562,8 +677,8 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap(){}
 /// @param node - The node whose height we want to calculate.
 /// @return The height of the node (int).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-int CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::getdepth(const Node *node) const
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+int CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::getdepth(const Node *node) const
 {
 	int depth = 0;
 	while (node->parent)
@@ -575,50 +690,253 @@ int CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::getdepth(const Node *node) const
   return depth;
 }
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Copies the tree
+/// @brief Makes a node with the map's allocator.
 /// @tparam KEY_TYPE 	 - The data type of the key
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param node 			 - Pointer to the node to copy from.
-/// @param newNode 		 - Pointer to the reference of the node to copy too.
+/// @param key 				 - The key of the node.
+/// @param value 			 - The value of the node.
 /// @param parent 		 - Pointer to the parent node.
+/// @return Pointer to the new node (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::CreateNode(const KEY_TYPE &key, const VALUE_TYPE &value, Node *parent)
+{
+	return new (nodeAlloc_.allocate()) Node(key, value, parent);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Destroys a node and gives its memory back to the allocator.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node 			 - The node to destroy.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::DestroyNode(Node *node)
+{
+	node->~Node();
+	nodeAlloc_.deallocate(node);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Empties the map. When the allocator can release all its nodes at once and
+///        the nodes need no destructor, the tree is not walked at all.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param threads 		 - Number of threads to walk the tree with.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::ClearTree(unsigned threads)
+{
+	// A releasing allocator takes the memory back below, the nodes only need their destructors.
+	bool deallocate = !ALLOC<Node>::releases_all;
+	if (deallocate || !std::is_trivially_destructible<Node>::value)
+	{
+		DeleteTree(pRoot, deallocate, threads);
+	}
+	nodeAlloc_.release();
+	pRoot = nullptr;
+	size_ = 0;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Constructs a copy of a node in the given storage, with the same height,
+///        balance and subtree size and no children.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param source 		 - The node to copy.
+/// @param storage 		 - Storage for the copy.
+/// @param parent 		 - The parent of the copy.
+/// @return The copy (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::CloneNode(const Node *source, void *storage, Node *parent)
+{
+	Node *node = new (storage) Node(source->key, source->value, parent, source->height, source->balance);
+	node->count = source->count;
+	return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copies a tree into this map's allocator. The nodes are copied top down
+///        from a work list, so the depth of the tree does not matter.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param source 		 - The root of the tree to copy, not null.
+/// @param parent 		 - The parent of the copy.
+/// @return The root of the copy (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::CopyTree(const Node *source, Node *parent)
+{
+	Node *root = CloneNode(source, nodeAlloc_.allocate(), parent);
+
+	// Copied nodes whose children are still to copy.
+	std::vector<std::pair<const Node *, Node *>> work(1, std::make_pair(source, root));
+	while (!work.empty())
+	{
+		const Node *from = work.back().first;
+		Node *to = work.back().second;
+		work.pop_back();
+
+		if (from->left)
+		{
+			to->left = CloneNode(from->left, nodeAlloc_.allocate(), to);
+			work.emplace_back(from->left, to->left);
+		}
+		if (from->right)
+		{
+			to->right = CloneNode(from->right, nodeAlloc_.allocate(), to);
+			work.emplace_back(from->right, to->right);
+		}
+	}
+	return root;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copies a tree into storage taken up front, on several threads. The
+///        storage is in preorder: a node's slot, then its left subtree's, then its
+///        right subtree's, so the subtree sizes tell every thread where to write.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param source 		 - The root of the tree to copy, not null.
+/// @param slots 			 - Storage for the copy of every node of source, in preorder.
+/// @param parent 		 - The parent of the copy.
+/// @param threads 		 - Number of threads to copy with.
+/// @return The root of the copy (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::CopyTree(const Node *source, Node *const *slots, Node *parent, unsigned threads)
+{
+	Node *root = CloneNode(source, slots[0], parent);
+
+	if (threads > 1 && source->count >= ParallelGrain)
+	{
+		// The left subtree on a new thread, the right one on this one.
+		Node *const *rightSlots = slots + 1 + (source->left ? source->left->count : 0);
+		std::thread helper([=]() { root->left = source->left ? CopyTree(source->left, slots + 1, root, threads / 2) : nullptr; });
+		root->right = source->right ? CopyTree(source->right, rightSlots, root, threads - threads / 2) : nullptr;
+		helper.join();
+		return root;
+	}
+
+	// Same work list as the sequential copy, each entry also knows its slots.
+	std::vector<std::tuple<const Node *, Node *, Node *const *>> work(1, std::make_tuple(source, root, slots));
+	while (!work.empty())
+	{
+		const Node *from = std::get<0>(work.back());
+		Node *to = std::get<1>(work.back());
+		Node *const *at = std::get<2>(work.back());
+		work.pop_back();
+
+		if (from->left)
+		{
+			to->left = CloneNode(from->left, at[1], to);
+			work.emplace_back(from->left, to->left, at + 1);
+		}
+		if (from->right)
+		{
+			Node *const *rightSlots = at + 1 + (from->left ? from->left->count : 0);
+			to->right = CloneNode(from->right, rightSlots[0], to);
+			work.emplace_back(from->right, to->right, rightSlots);
+		}
+	}
+	return root;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copies another map into this empty one.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs 				 - The map to copy.
+/// @param threads 		 - Number of threads to copy with.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::CopyTree(Node *node, Node *&newNode, Node *parent)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::CopyFrom(const BSTmap &rhs, unsigned threads)
 {
-	// If the node is null, set the other node to null.
-	if (node == nullptr)
+	if (!rhs.pRoot)
 	{
-		newNode = nullptr;
 		return;
 	}
 
-	// Initialise the new node by copying the current node.
-	newNode = new Node(node->Key(), node->Value(), parent);
-	// Recursively copy the other nodes.
-	CopyTree(node->left, newNode->left, parent);
-	CopyTree(node->right, newNode->right, parent);
+	if (threads > 1 && rhs.size_ >= ParallelGrain)
+	{
+		// The allocator is not thread safe: take the storage up front.
+		std::vector<Node *> slots(rhs.size_);
+		for (Node *&slot : slots)
+		{
+			slot = static_cast<Node *>(nodeAlloc_.allocate());
+		}
+		pRoot = CopyTree(rhs.pRoot, slots.data(), nullptr, threads);
+	}
+	else
+	{
+		pRoot = CopyTree(rhs.pRoot, nullptr);
+	}
+	size_ = rhs.size_;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
-/// @brief Deletes the BST
+/// @brief Deletes the BST without recursion: while the root has a left child it is
+///        rotated right, otherwise the root is destroyed and its right child is next.
 /// @tparam KEY_TYPE - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param tree - The BST to delete.
+/// @param tree - The BST to delete, may be null.
+/// @param deallocate - False when only the destructors have to run.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::DeleteTree(Node *tree)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::DeleteTree(Node *tree, bool deallocate)
 {
-	// Prevent double free.
-	if (tree == nullptr)
+	while (tree)
 	{
+		if (tree->left)
+		{
+			Node *left = tree->left;
+			tree->left = left->right;
+			left->right = tree;
+			tree = left;
+		}
+		else
+		{
+			Node *right = tree->right;
+			if (deallocate)
+			{
+				DestroyNode(tree);
+			}
+			else
+			{
+				tree->~Node();
+			}
+			tree = right;
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Deletes the BST on several threads, subtrees below the cutoff are deleted
+///        as above. Deallocating on several threads needs an allocator whose
+///        deallocate is thread safe (BSTNewDelete), a releasing one never deallocates here.
+/// @tparam KEY_TYPE - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree - The BST to delete, may be null.
+/// @param deallocate - False when only the destructors have to run.
+/// @param threads - Number of threads to delete with.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::DeleteTree(Node *tree, bool deallocate, unsigned threads)
+{
+	if (!tree || threads < 2 || tree->count < ParallelGrain)
+	{
+		DeleteTree(tree, deallocate);
 		return;
 	}
 
-	// Delete the left and right subtrees.
-	DeleteTree(tree->left);
-	DeleteTree(tree->right);
-	// Delete the node.
-	delete tree;
+	Node *left = tree->left;
+	std::thread helper([=]() { DeleteTree(left, deallocate, threads / 2); });
+	DeleteTree(tree->right, deallocate, threads - threads / 2);
+	helper.join();
+
+	tree->left = tree->right = nullptr;
+	DeleteTree(tree, deallocate);
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
@@ -627,8 +945,8 @@ void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::DeleteTree(Node *tree)
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @param node - The node to be deleted.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::DeleteNode(Node *node)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::DeleteNode(Node *node)
 {
 	// Base Case: No left or right
 	if (!node->right && !node->left)
@@ -644,7 +962,8 @@ void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::DeleteNode(Node *node)
 		{
 			pRoot = nullptr;
 		}
-		delete node;
+		AdjustCounts(node->parent, -1);
+		DestroyNode(node);
 		size_--;
 	}
 	// Case: left and right
@@ -670,16 +989,17 @@ void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::DeleteNode(Node *node)
 			Node*& newNode = node->FindNode();
 			// Set the child to that address.
 			newNode = child;
-			// Update the parents
-			child->parent = node->parent;
 		}
 		else
 		{
 			// Set pRoot to the child.
 			pRoot = child;
 		}
+		// Update the parents (null when the child becomes the root).
+		child->parent = node->parent;
+		AdjustCounts(node->parent, -1);
 		// Delete the node.
-		delete node;
+		DestroyNode(node);
 		// Decrement the amount of nodes in the tree.
 		size_--;
 	}
@@ -689,36 +1009,41 @@ void CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::DeleteNode(Node *node)
 /// @brief Inserts a node into the tree at a specified key
 /// @tparam KEY_TYPE   - The data type of the key.
 /// @tparam VALUE_TYPE - The data type of the value.
-/// @param insertNode  - The node to be inserted
+/// @param insertNode  - The root of the subtree to insert into.
 /// @param key 				 - The position in the tree to insert at.
-/// @param parent 		 - The parent of the node we are inserting.
+/// @param parent 		 - The parent of insertNode.
+/// @return The node with the key, new or not (Node*).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::InsertNode(Node *&insertNode, const KEY_TYPE &key, Node *parent)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node* CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::InsertNode(Node *&insertNode, const KEY_TYPE &key, Node *parent)
 {
-	// Base case: insertNode is null.
-  	if (insertNode == nullptr)
+	// Walk down to the key, or to the empty link it belongs in.
+	Node** link = &insertNode;
+	while (*link)
 	{
-		insertNode = new Node(key, VALUE_TYPE(), parent);
-		++size_;
-		return insertNode;
+		// Key is smaller than the node's key 
+		if (key < (*link)->Key())
+		{
+			parent = *link;
+			link = &parent->left;
+		}
+		// Key is greater than the node's key
+		else if (key > (*link)->Key())
+		{
+			parent = *link;
+			link = &parent->right;
+		}
+		// If the key is the same.
+		else
+		{
+			return *link;
+		}
 	}
 
-	// Key is smaller than the node's key 
-	if (key < insertNode->Key())
-	{
-		return InsertNode(insertNode->left, key, insertNode);
-	}
-	// Key is greater than the node's key
-	else if (key > insertNode->Key())
-	{
-		return InsertNode(insertNode->right, key, insertNode);
-	}
-	// If the key is the same.
-	else
-	{
-		return insertNode;
-	}
+	*link = CreateNode(key, VALUE_TYPE(), parent);
+	AdjustCounts(parent, 1);
+	++size_;
+	return *link;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
@@ -726,16 +1051,42 @@ typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::Node* CS280::BSTmap<KEY_TYPE, VALU
 /// @tparam KEY_TYPE 	 - The data type of the key
 /// @tparam VALUE_TYPE - The data type of the value.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap(const BSTmap &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap(const BSTmap &rhs)
 	: pRoot(nullptr)
-	, size_(rhs.size_)
+	, size_(0)
+	, nodeAlloc_()
 {
-	// As long as the other tree is not empty
-	if (rhs.pRoot != nullptr)
-	{
-		CopyTree(rhs.pRoot, pRoot, nullptr);
-	}
+	CopyFrom(rhs, 1);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copy Constructor that copies big maps on several threads. Heights and
+///        balances are copied, so the copy of an AVL map needs no rebalancing.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs 				 - The map to copy.
+/// @param threads 		 - Number of threads to copy with.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap(const BSTmap &rhs, unsigned threads)
+	: pRoot(nullptr)
+	, size_(0)
+	, nodeAlloc_()
+{
+	CopyFrom(rhs, threads);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Empties the map, big maps are taken apart on several threads.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param threads 		 - Number of threads to use.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::clear(unsigned threads)
+{
+	ClearTree(threads);
 }
 
 //-------------------------------------------------------------------------------------------------------------------------
@@ -743,8 +1094,8 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap(const BSTmap &rhs)
 /// @tparam KEY_TYPE 	 - The data type of the key
 /// @tparam VALUE_TYPE - The data type of the value.
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE> &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::operator=(const BSTmap<KEY_TYPE, VALUE_TYPE> &rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC> &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::operator=(const BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC> &rhs)
 {
 	// Check for self assingment
   if (this == &rhs)
@@ -752,18 +1103,11 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE> &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::operat
 		return *this;
 	}
 
-	// Delete the current tree.
-	DeleteTree(pRoot);
-
-	// Reinitialise the tree
-	size_ = 0;
-	pRoot = nullptr;
+	// Delete the current tree, this also resets it.
+	ClearTree();
 
 	// Copy the tree.
-	if (rhs.pRoot != nullptr)
-	{
-		CopyTree(rhs.pRoot, pRoot, nullptr);
-	}
+	CopyFrom(rhs, 1);
 
 	return *this;
 }
@@ -774,13 +1118,12 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE> &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::operat
 /// @tparam VALUE_TYPE - The data type of the value.
 /// @param rhs 			   - rvalue reference to another BSTmap
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap(BSTmap &&rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap(BSTmap &&rhs)
+	: pRoot(rhs.pRoot)
+	, size_(rhs.size_)
+	, nodeAlloc_(std::move(rhs.nodeAlloc_)) // the nodes live in rhs's slabs
 {
-	// Take resources from 'rhs' and make them our own 
-	this->size_ = rhs.size_;
-	this->pRoot = rhs.pRoot;
-
 	// Reset 'rhs' to a valid but unspecified state.
 	rhs.size_ = 0;
 	rhs.pRoot = nullptr;
@@ -793,8 +1136,8 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::BSTmap(BSTmap &&rhs)
 /// @param rhs 				 - Rvalue reference to another BSTmap to assign to this one.
 /// @return A reference to the newly assigned BSTmap (BSTmap&).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::operator=(BSTmap<KEY_TYPE, VALUE_TYPE> &&rhs)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::operator=(BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC> &&rhs)
 {
 	// Self assignment check
   if (this == &rhs)
@@ -803,11 +1146,12 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap &CS280::BSTmap<KEY_TYPE, VAL
 	}
 	
 	// Release current resources.
-	DeleteTree(pRoot);
+	ClearTree();
 
 	// Take resources from 'rhs' and make them our own 
 	this->size_ = rhs.size_;
 	this->pRoot = rhs.pRoot;
+	this->nodeAlloc_ = std::move(rhs.nodeAlloc_);
 
 	// Reset 'rhs' to a valid but unspecified state.
 	rhs.size_ = 0;
@@ -821,8 +1165,8 @@ typename CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::BSTmap &CS280::BSTmap<KEY_TYPE, VAL
 /// @tparam KEY_TYPE 	 - The data type of the key
 /// @tparam VALUE_TYPE - The data type of the value
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::~BSTmap() { DeleteTree(pRoot); }
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::~BSTmap() { ClearTree(); }
 
 //-------------------------------------------------------------------------------------------------------------------------
 /// @brief The amount of ndoes in the BSTmap
@@ -830,8 +1174,8 @@ CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::~BSTmap() { DeleteTree(pRoot); }
 /// @tparam VALUE_TYPE - The data type of the value
 /// @return The amount of nodes in BSTmap (unsigned int).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-unsigned int CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::size() { return size_; }
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+unsigned int CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::size() { return size_; }
 
 //-------------------------------------------------------------------------------------------------------------------------
 /// @brief Index Operator Overload
@@ -840,13 +1184,13 @@ unsigned int CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::size() { return size_; }
 /// @param key 				 - The key to find.
 /// @return The value at the key (VALUE_TYPE).
 //-------------------------------------------------------------------------------------------------------------------------
-template <typename KEY_TYPE, typename VALUE_TYPE>
-VALUE_TYPE &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::operator[](KEY_TYPE const &key)
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+VALUE_TYPE &CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::operator[](KEY_TYPE const &key)
 {
 	// Base case: tree is empty.
   if (pRoot == nullptr)
 	{
-		pRoot = new Node(key, VALUE_TYPE(), nullptr);
+		pRoot = CreateNode(key, VALUE_TYPE(), nullptr);
 		++size_;
 		return pRoot->Value();
 	}
@@ -856,13 +1200,607 @@ VALUE_TYPE &CS280::BSTmap<KEY_TYPE, VALUE_TYPE>::operator[](KEY_TYPE const &key)
 	return node->Value();
 }
 
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Range constructor, builds the map from (key, value) pairs.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam IT 				 - Forward iterator to pairs (.first is the key, .second the value).
+/// @param first 			 - Start of the range.
+/// @param last 			 - End of the range.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+template <typename IT>
+CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap(IT first, IT last)
+{
+	typedef typename std::iterator_traits<IT>::value_type Pair;
+	// Strictly increasing keys can be used as they are (a key not above the one
+	// before it counts as out of order).
+	if (std::is_sorted(first, last, [](const Pair &next, const Pair &previous) { return !(previous.first < next.first); }))
+	{
+		assign_sorted(first, last);
+		return;
+	}
+
+	// Sort a copy, equal keys stay in order so the last one can be kept.
+	std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> pairs(first, last);
+	std::stable_sort(pairs.begin(), pairs.end(), [](const std::pair<KEY_TYPE, VALUE_TYPE> &lhs, const std::pair<KEY_TYPE, VALUE_TYPE> &rhs) {
+		return lhs.first < rhs.first;
+	});
+
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < pairs.size(); ++i)
+	{
+		if (kept > 0 && !(pairs[kept - 1].first < pairs[i].first))
+		{
+			pairs[kept - 1] = std::move(pairs[i]);
+		}
+		else if (kept++ != i)
+		{
+			pairs[kept - 1] = std::move(pairs[i]);
+		}
+	}
+	pairs.resize(kept);
+	assign_sorted(pairs.begin(), pairs.end());
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Replaces the contents with sorted (key, value) pairs. The middle pair becomes
+///        the root and each half becomes a subtree, so the tree is perfectly balanced
+///        and every height is known without rotations.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam IT 				 - Forward iterator to pairs with strictly increasing keys.
+/// @param first 			 - Start of the range.
+/// @param last 			 - End of the range.
+/// @param threads 		 - Number of threads to build with (random access ranges only).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+template <typename IT>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::assign_sorted(IT first, IT last, unsigned threads)
+{
+	ClearTree();
+	std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+
+	typedef typename std::iterator_traits<IT>::iterator_category Category;
+	if constexpr (std::is_base_of<std::random_access_iterator_tag, Category>::value)
+	{
+		if (threads > 1 && count >= ParallelGrain)
+		{
+			// The allocator is not thread safe: take the storage for every node up
+			// front, in key order, then let the threads construct and link them.
+			std::vector<Node *> slots(count);
+			for (Node *&slot : slots)
+			{
+				slot = static_cast<Node *>(nodeAlloc_.allocate());
+			}
+			pRoot = BuildSorted(first, slots.data(), 0, count, nullptr, threads);
+			size_ = static_cast<unsigned int>(count);
+			return;
+		}
+	}
+
+	pRoot = BuildSorted(first, count, nullptr);
+	size_ = static_cast<unsigned int>(count);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Builds a balanced subtree from the next count pairs of a sorted range.
+///        Nodes are made in key order, so they also sit in key order in the pool.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param it 				 - Iterator to the next pair, moved past the pairs used.
+/// @param count 			 - Number of pairs in the subtree.
+/// @param parent 		 - The parent of the subtree.
+/// @return The root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+template <typename IT>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BuildSorted(IT &it, std::size_t count, Node *parent)
+{
+	if (count == 0 || !Readable(it))
+	{
+		return nullptr;
+	}
+
+	// The left half comes first in the range, the root needs its key though.
+	std::size_t leftCount = count / 2;
+	Node *left = BuildSorted(it, leftCount, nullptr);
+	if (!Readable(it))
+	{
+		// The input ran out in the left half, the caller throws away what was built.
+		if (left)
+		{
+			left->parent = parent;
+		}
+		return left;
+	}
+	Node *node = CreateNode(it->first, it->second, parent);
+	++it;
+
+	node->left = left;
+	if (left)
+	{
+		left->parent = node;
+	}
+	node->right = BuildSorted(it, count - leftCount - 1, node);
+	UpdateNode(node);
+	return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Builds a balanced subtree of a random access range into storage taken from
+///        the allocator beforehand, splitting the work across threads near the top.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param first 			 - Start of the whole range.
+/// @param slots 			 - Node storage, one per pair.
+/// @param lo 				 - First pair of the subtree.
+/// @param hi 				 - One past the last pair of the subtree.
+/// @param parent 		 - The parent of the subtree.
+/// @param threads 		 - Threads available for this subtree.
+/// @return The root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+template <typename IT>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BuildSorted(IT first, Node *const *slots, std::size_t lo, std::size_t hi, Node *parent, unsigned threads)
+{
+	if (lo == hi)
+	{
+		return nullptr;
+	}
+
+	// Same split as the sequential build.
+	std::size_t mid = lo + (hi - lo) / 2;
+	Node *node = new (slots[mid]) Node(first[mid].first, first[mid].second, parent);
+
+	if (threads > 1 && hi - lo >= ParallelGrain)
+	{
+		// The left half on a new thread, the right half on this one.
+		std::thread helper([=]() { node->left = BuildSorted(first, slots, lo, mid, node, threads / 2); });
+		node->right = BuildSorted(first, slots, mid + 1, hi, node, threads - threads / 2);
+		helper.join();
+	}
+	else
+	{
+		node->left = BuildSorted(first, slots, lo, mid, node, 1);
+		node->right = BuildSorted(first, slots, mid + 1, hi, node, 1);
+	}
+	UpdateNode(node);
+	return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Sets the height, balance and subtree size of a node from its children
+///        (an empty child has height -1).
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node 			 - The node to update.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::UpdateNode(Node *node)
+{
+	int leftHeight = node->left ? node->left->height : -1;
+	int rightHeight = node->right ? node->right->height : -1;
+
+	// The height is whichever is greater.
+	node->height = std::max(leftHeight, rightHeight) + 1;
+	node->balance = leftHeight - rightHeight;
+	node->count = 1 + (node->left ? node->left->count : 0) + (node->right ? node->right->count : 0);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Adds to the subtree size of a node and all the nodes above it.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node 			 - The lowest node to change, may be null.
+/// @param delta 			 - 1 after an insert below node, -1 after an erase.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::AdjustCounts(Node *node, int delta)
+{
+	for (; node; node = node->parent)
+	{
+		node->count += delta;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief All the pairs in the map in key order.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The pairs (std::vector<std::pair<KEY_TYPE, VALUE_TYPE>>).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::to_sorted_vector() const
+{
+	std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> pairs;
+	pairs.reserve(size_);
+
+	// Successor steps cost O(1) amortized over a full traversal.
+	for (Node *node = pRoot ? pRoot->first() : nullptr; node; node = node->increment())
+	{
+		pairs.emplace_back(node->key, node->value);
+	}
+	return pairs;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Read-only copy of the map in a cache friendly layout.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The frozen map (FrozenMap<KEY_TYPE, VALUE_TYPE>).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+CS280::FrozenMap<KEY_TYPE, VALUE_TYPE> CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::freeze() const
+{
+	std::vector<std::pair<KEY_TYPE, VALUE_TYPE>> pairs = to_sorted_vector();
+	return FrozenMap<KEY_TYPE, VALUE_TYPE>(std::make_move_iterator(pairs.begin()), std::make_move_iterator(pairs.end()));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Writes a header and then every pair in key order.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param os 				 - The stream to write to.
+/// @return False if the stream failed (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::serialize(std::ostream &os) const
+{
+	SerialWriter out(os);
+	SerialHeader::For<KEY_TYPE, VALUE_TYPE>(size_).write(out);
+	for (Node *node = pRoot ? pRoot->first() : nullptr; node; node = node->increment())
+	{
+		Serializer<KEY_TYPE>::write(out, node->key);
+		Serializer<VALUE_TYPE>::write(out, node->value);
+	}
+	return out.flush();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Reads a map written by serialize(). The pairs are decoded one at a time
+///        straight into BuildSorted, which wants them in key order, so no pair is
+///        kept beyond the one being linked and no rotations are done.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param is 				 - The stream to read from.
+/// @return False if the data was bad, the map is then empty (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::deserialize(std::istream &is)
+{
+	ClearTree();
+	SerialReader in(is);
+	SerialHeader header;
+	if (!header.read(in) || !header.Matches(SerialHeader::For<KEY_TYPE, VALUE_TYPE>(0)) ||
+	    header.count > std::numeric_limits<unsigned int>::max())
+	{
+		return false;
+	}
+
+	SerialPairs<KEY_TYPE, VALUE_TYPE> pairs(in, header.count);
+	pRoot = BuildSorted(pairs, static_cast<std::size_t>(header.count), nullptr);
+	size_ = static_cast<unsigned int>(header.count);
+	if (!pairs.ok())
+	{
+		ClearTree();
+		return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Finds the first node whose key is not less than a key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return The node, null if every key is less (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::LowerBound(KEY_TYPE const &key) const
+{
+	Node *result = nullptr;
+	Node *node = pRoot;
+	while (node)
+	{
+		// A candidate, a smaller one may be on the left.
+		if (!(node->key < key))
+		{
+			result = node;
+			node = node->left;
+		}
+		else
+		{
+			node = node->right;
+		}
+	}
+	return result;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Finds the first node whose key is greater than a key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return The node, null if no key is greater (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::UpperBound(KEY_TYPE const &key) const
+{
+	Node *result = nullptr;
+	Node *node = pRoot;
+	while (node)
+	{
+		// A candidate, a smaller one may be on the left.
+		if (key < node->key)
+		{
+			result = node;
+			node = node->left;
+		}
+		else
+		{
+			node = node->right;
+		}
+	}
+	return result;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Finds the k-th smallest node by walking down the subtree sizes.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param k 					 - Position in key order, from 0.
+/// @return The node, null if k is not less than the size (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node *CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Select(unsigned k) const
+{
+	Node *node = pRoot;
+	while (node)
+	{
+		unsigned leftCount = node->left ? node->left->count : 0;
+		if (k < leftCount)
+		{
+			node = node->left;
+		}
+		else if (k == leftCount)
+		{
+			return node;
+		}
+		else
+		{
+			// Skip the left subtree and this node.
+			k -= leftCount + 1;
+			node = node->right;
+		}
+	}
+	return nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator to the first key not less than a key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return The iterator, end() if every key is less (BSTmap_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::lower_bound(KEY_TYPE const &key)
+{
+	return BSTmap_iterator(LowerBound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator to the first key greater than a key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return The iterator, end() if no key is greater (BSTmap_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::upper_bound(KEY_TYPE const &key)
+{
+	return BSTmap_iterator(UpperBound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The range of keys equal to a key (empty or one node).
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return lower_bound and upper_bound (std::pair<BSTmap_iterator, BSTmap_iterator>).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+std::pair<typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator, typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator> CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::equal_range(KEY_TYPE const &key)
+{
+	return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Const iterator to the first key not less than a key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return The iterator, end() if every key is less (BSTmap_iterator_const).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::lower_bound(KEY_TYPE const &key) const
+{
+	return BSTmap_iterator_const(LowerBound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Const iterator to the first key greater than a key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return The iterator, end() if no key is greater (BSTmap_iterator_const).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::upper_bound(KEY_TYPE const &key) const
+{
+	return BSTmap_iterator_const(UpperBound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The const range of keys equal to a key (empty or one node).
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to search for.
+/// @return lower_bound and upper_bound (std::pair<BSTmap_iterator_const, BSTmap_iterator_const>).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+std::pair<typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const, typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const> CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::equal_range(KEY_TYPE const &key) const
+{
+	return std::make_pair(lower_bound(key), upper_bound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator to the k-th smallest key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param k 					 - Position in key order, from 0.
+/// @return The iterator, end() if k is not less than the size (BSTmap_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::select(unsigned k)
+{
+	return BSTmap_iterator(Select(k));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Const iterator to the k-th smallest key.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param k 					 - Position in key order, from 0.
+/// @return The iterator, end() if k is not less than the size (BSTmap_iterator_const).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+typename CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::BSTmap_iterator_const CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::select(unsigned k) const
+{
+	return BSTmap_iterator_const(Select(k));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Counts the keys less than a key. Every time the search goes right, the left
+///        subtree and the node are all smaller.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key 				 - The key to rank.
+/// @return The number of smaller keys (unsigned).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+unsigned CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::rank(KEY_TYPE const &key) const
+{
+	unsigned smaller = 0;
+	Node *node = pRoot;
+	while (node)
+	{
+		if (node->key < key)
+		{
+			smaller += 1 + (node->left ? node->left->count : 0);
+			node = node->right;
+		}
+		else
+		{
+			node = node->left;
+		}
+	}
+	return smaller;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Counts the keys in [lo, hi).
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param lo 				 - Smallest key counted.
+/// @param hi 				 - First key not counted.
+/// @return The number of keys in the range (unsigned).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+unsigned CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::count_range(KEY_TYPE const &lo, KEY_TYPE const &hi) const
+{
+	if (!(lo < hi))
+	{
+		return 0;
+	}
+	return rank(hi) - rank(lo);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Checks the keys are in order and the parent links and subtree sizes agree
+///        with the children.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return True if the tree is consistent (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::sanityCheck() const
+{
+	return CheckTree(false);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Walks the tree in order with a stack (the parent links are being checked,
+///        so they are not followed) and checks every node against its children.
+/// @tparam KEY_TYPE 	 - The data type of the key
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param balanced 	 - Also check the heights and balances, and that no balance
+///                      is more than 1 either way.
+/// @return True if the tree is consistent (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC>
+bool CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::CheckTree(bool balanced) const
+{
+	if (pRoot && pRoot->parent)
+	{
+		return false;
+	}
+
+	std::vector<const Node *> stack;
+	const Node *node = pRoot;
+	const Node *previous = nullptr;
+	unsigned visited = 0;
+	while (node || !stack.empty())
+	{
+		for (; node; node = node->left)
+		{
+			stack.push_back(node);
+		}
+		node = stack.back();
+		stack.pop_back();
+
+		if ((previous && !(previous->key < node->key)) || (node->left && node->left->parent != node) ||
+		    (node->right && node->right->parent != node) ||
+		    node->count != 1 + (node->left ? node->left->count : 0) + (node->right ? node->right->count : 0))
+		{
+			return false;
+		}
+		if (balanced)
+		{
+			int leftHeight = node->left ? node->left->height : -1;
+			int rightHeight = node->right ? node->right->height : -1;
+			if (node->height != std::max(leftHeight, rightHeight) + 1 || node->balance != leftHeight - rightHeight ||
+			    node->balance < -1 || node->balance > 1)
+			{
+				return false;
+			}
+		}
+
+		++visited;
+		previous = node;
+		node = node->right;
+	}
+	return visited == size_;
+}
+
 ////////////////////////////////////////////////////////////
 // do not change this code from here to the end of the file
 /* figure out whether node is left or right child or root 
  * used in print_backwards_padded 
  */
-template< typename KEY_TYPE, typename VALUE_TYPE >
-char CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::getedgesymbol(const Node* node) const
+template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+char CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::getedgesymbol(const Node* node) const
 {
 	const Node* parent = node->parent;
 	if ( parent == nullptr) return '-';
@@ -873,17 +1811,17 @@ char CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::getedgesymbol(const Node* node) const
  * iterative function. 
  * Left branch of the tree is at the bottom
  */
-template< typename KEY_TYPE, typename VALUE_TYPE >
-std::ostream& CS280::operator<<(std::ostream& os, BSTmap<KEY_TYPE,VALUE_TYPE> const& map) {
+template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+std::ostream& CS280::operator<<(std::ostream& os, BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC> const& map) {
 	map.print(os);
 	return os;
 }
 
-template< typename KEY_TYPE, typename VALUE_TYPE >
-void CS280::BSTmap<KEY_TYPE,VALUE_TYPE>::print(std::ostream& os, bool print_value ) const {
+template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+void CS280::BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::print(std::ostream& os, bool print_value ) const {
 	if (pRoot) 
 	{
-		BSTmap<KEY_TYPE,VALUE_TYPE>::Node* b = pRoot->last();
+		BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC>::Node* b = pRoot->last();
 		while ( b ) { 
 			int depth = getdepth(b);
 			int i;
@@ -12,13 +12,82 @@
 #define BSTMAP_H
 
 #include <iostream>
+#include <cstddef>     // std::size_t
+#include <type_traits> // std::is_trivially_destructible
+#include <utility>     // std::move, std::pair
+#include <vector>      // std::vector
+#include <iterator>    // std::iterator_traits, std::distance
+#include <algorithm>   // std::is_sorted, std::stable_sort
+#include <thread>      // std::thread
+#include <tuple>       // std::tuple
+#include <memory>      // std::shared_ptr
+#include <limits>      // std::numeric_limits
+#include "frozen-map.h"
+#include "map-serial.h"
 
 namespace CS280 
 {
-	template< typename KEY_TYPE, typename VALUE_TYPE >
+	/// @brief Node allocator that carves nodes out of large slabs, so the nodes
+	///        of a map sit next to each other in memory. Freed nodes go on a
+	///        free list and release() gives back every slab at once. Slabs are
+	///        reference counted so maps that trade nodes (split/join) can share
+	///        them, a slab is freed when the last pool holding it lets go.
+	/// @tparam NODE - the node type.
+	template< typename NODE >
+	class BSTNodePool
+	{
+		public:
+			BSTNodePool() {}
+			// A copy starts without slabs, the nodes belong to the original.
+			BSTNodePool(const BSTNodePool&) {}
+			BSTNodePool& operator=(const BSTNodePool&) { return *this; }
+			BSTNodePool(BSTNodePool&& rhs);
+			BSTNodePool& operator=(BSTNodePool&& rhs);
+			~BSTNodePool() { release(); }
+
+			// Storage for one node, the caller constructs it with placement new.
+			void* allocate();
+			// Puts the storage of a destroyed node on the free list.
+			void deallocate(void* node);
+			// Lets go of every slab, nodes still in them are gone (unless
+			// another pool shares the slab).
+			void release();
+			// Keeps the slabs of other alive as long as this pool, so nodes
+			// allocated by other can move into this pool's map.
+			void share(const BSTNodePool& other);
+
+			// release() frees all the nodes, the map does not have to visit them.
+			static const bool releases_all = true;
+
+		private:
+			// Slabs double in size up to this many nodes.
+			static const std::size_t MaxSlabNodes = 65536;
+
+			std::vector< std::shared_ptr<void> > slabs_ {};
+			void* free_ = nullptr;
+			char* next_ = nullptr;
+			char* end_ = nullptr;
+			std::size_t slabNodes_ = 32;
+	};
+
+	/// @brief Node allocator without pooling, every node goes through new/delete.
+	/// @tparam NODE - the node type.
+	template< typename NODE >
+	struct BSTNewDelete
+	{
+		void* allocate() { return ::operator new(sizeof(NODE)); }
+		void deallocate(void* node) { ::operator delete(node); }
+		void release() {}
+		void share(const BSTNewDelete&) {}
+		static const bool releases_all = false;
+	};
+
+	template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
 	class AVLmap;
 
-    template< typename KEY_TYPE, typename VALUE_TYPE >
+	/// @brief Binary search tree map.
+	/// @tparam ALLOC - the node allocator (BSTNodePool or BSTNewDelete).
+    template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC = BSTNodePool >
     class BSTmap 
 	{
 		public:
@@ -26,7 +95,6 @@ namespace CS280
 			{
 				public:
 					Node( KEY_TYPE k, VALUE_TYPE val, Node* p, int h = 0, int b = 0, Node* l = nullptr, Node* r = nullptr);
-					virtual ~Node() {};
 					Node(const Node&)               = delete;
 					Node* operator=(const Node&)    = delete;
 					
@@ -44,14 +112,15 @@ namespace CS280
           			KEY_TYPE    key;
 					VALUE_TYPE  value;
 					int         height,balance; // optional
+					unsigned    count;          // nodes in this subtree
 					Node        *parent;
 					Node        *left;
 					Node        *right;
 
 					friend class BSTmap;
-					friend class AVLmap <KEY_TYPE, VALUE_TYPE>;
+					friend class AVLmap<KEY_TYPE, VALUE_TYPE, ALLOC>;
 
-					template <typename ANYK_TYPE, typename ANYV_TYPE>
+					template <typename ANYK_TYPE, typename ANYV_TYPE, template <typename> class ANY_ALLOC>
 					friend class AVLmap;
 			};
         private:
@@ -79,6 +148,7 @@ namespace CS280
 					Node* p_node;
 				public:
 					BSTmap_iterator_const(Node* p = nullptr);
+					BSTmap_iterator_const(const BSTmap_iterator_const& rhs) : p_node(rhs.p_node){}
 					BSTmap_iterator_const& operator=(const BSTmap_iterator_const& rhs);
 					BSTmap_iterator_const& operator++();
 					BSTmap_iterator_const operator++(int);
@@ -93,6 +163,8 @@ namespace CS280
       	// BSTmap implementation
 			Node* pRoot = nullptr;
       		unsigned int size_ = 0;
+			// Where the nodes come from.
+			ALLOC<Node> nodeAlloc_ {};
 			// end iterators are same for all BSTmaps, thus static
 			// make BSTmap_iterator a friend
 			// to allow BSTmap_iterator to access end iterators 
@@ -107,7 +179,37 @@ namespace CS280
       		BSTmap& operator=(BSTmap&& rhs);
 			virtual ~BSTmap();
 
+			// Copies big maps (ParallelGrain nodes or more) on several threads.
+			BSTmap(const BSTmap& rhs, unsigned threads);
+
+			// Builds the map from a range of (key, value) pairs. A range sorted by
+			// key without duplicates is built directly, any other range is sorted
+			// first (the last value of a repeated key wins).
+			template< typename IT >
+			BSTmap(IT first, IT last);
+
       		unsigned int size();
+			// Removes every key, big maps are taken apart on several threads.
+			void clear(unsigned threads = 1);
+
+			// Replaces the contents with a range of (key, value) pairs with strictly
+			// increasing keys, building a perfectly balanced tree in O(n). With more
+			// than one thread and a random access range the subtrees are built in parallel.
+			template< typename IT >
+			void assign_sorted(IT first, IT last, unsigned threads = 1);
+			// All (key, value) pairs in key order, O(n).
+			std::vector< std::pair<KEY_TYPE, VALUE_TYPE> > to_sorted_vector() const;
+			// Read-only copy with faster find and lower_bound for maps that are
+			// mostly read, O(n). Later changes to the map are not in the copy.
+			FrozenMap<KEY_TYPE, VALUE_TYPE> freeze() const;
+			// Writes the map in a compact binary form (see map-serial.h), false if
+			// the stream failed. Keys and values that are not trivially copyable
+			// need a CS280::Serializer specialization.
+			bool serialize(std::ostream& os) const;
+			// Replaces the contents with a map written by serialize(), building a
+			// balanced tree in O(n) as the data is read. False (and an empty map)
+			// if the data is cut short, corrupt or of other types.
+			bool deserialize(std::istream& is);
 
 			//value setter and getter
 			virtual VALUE_TYPE& operator[](KEY_TYPE const& key);
@@ -130,11 +232,30 @@ namespace CS280
 			BSTmap_iterator_const begin() const;
 			BSTmap_iterator_const end() const;
 			BSTmap_iterator_const find(KEY_TYPE const& key) const;
+
+			// First key not less than key, first key greater than key, and both.
+			BSTmap_iterator lower_bound(KEY_TYPE const& key);
+			BSTmap_iterator upper_bound(KEY_TYPE const& key);
+			std::pair<BSTmap_iterator, BSTmap_iterator> equal_range(KEY_TYPE const& key);
+			BSTmap_iterator_const lower_bound(KEY_TYPE const& key) const;
+			BSTmap_iterator_const upper_bound(KEY_TYPE const& key) const;
+			std::pair<BSTmap_iterator_const, BSTmap_iterator_const> equal_range(KEY_TYPE const& key) const;
+
+			// Order statistics from the subtree sizes, all O(height).
+			// The k-th smallest key (from 0), end() if k >= size.
+			BSTmap_iterator select(unsigned k);
+			BSTmap_iterator_const select(unsigned k) const;
+			// Number of keys less than key.
+			unsigned rank(KEY_TYPE const& key) const;
+			// Number of keys in [lo, hi).
+			unsigned count_range(KEY_TYPE const& lo, KEY_TYPE const& hi) const;
 			//do not need this one (why)
 			//BSTmap_iterator_const erase(BSTmap_iterator& it) const;
 
 			void print(std::ostream& os, bool print_value = false) const;
-			//bool sanityCheck();
+			// Whether the keys are in order and the parent links and subtree
+			// sizes agree with the children, O(n).
+			bool sanityCheck() const;
 
 			//inner class (BSTmap_iterator) doesn't have any special priveleges
 			//in accessing private data/methods of the outer class (BSTmap)
@@ -147,15 +268,35 @@ namespace CS280
 					char getedgesymbol(const Node* node) const;
 					int getdepth(const Node* node) const;
 
-					void CopyTree(Node* node, Node*& newNode, Node* parent);
-					void DeleteTree(Node* tree);
+					Node* CreateNode(const KEY_TYPE& key, const VALUE_TYPE& value, Node* parent);
+					void DestroyNode(Node* node);
+					Node* CloneNode(const Node* source, void* storage, Node* parent);
+					Node* CopyTree(const Node* source, Node* parent);
+					Node* CopyTree(const Node* source, Node* const* slots, Node* parent, unsigned threads);
+					void CopyFrom(const BSTmap& rhs, unsigned threads);
+					void DeleteTree(Node* tree, bool deallocate);
+					void DeleteTree(Node* tree, bool deallocate, unsigned threads);
+					void ClearTree(unsigned threads = 1);
 					virtual void DeleteNode(Node* node);
 					virtual Node* InsertNode(Node*& insertNode, const KEY_TYPE& key, Node* parent);
+
+					// Smallest range a thread is started for in assign_sorted.
+					static const std::size_t ParallelGrain = 1 << 14;
+					template< typename IT >
+					Node* BuildSorted(IT& it, std::size_t count, Node* parent);
+					template< typename IT >
+					Node* BuildSorted(IT first, Node* const* slots, std::size_t lo, std::size_t hi, Node* parent, unsigned threads);
+					static void UpdateNode(Node* node);
+					static void AdjustCounts(Node* node, int delta);
+					Node* LowerBound(KEY_TYPE const& key) const;
+					Node* UpperBound(KEY_TYPE const& key) const;
+					Node* Select(unsigned k) const;
+					bool CheckTree(bool balanced) const;
 	};
 
 	//notice that it doesn't need to be friend
-    template< typename KEY_TYPE, typename VALUE_TYPE >
-	std::ostream& operator<<(std::ostream& os, BSTmap<KEY_TYPE, VALUE_TYPE> const& map);
+    template< typename KEY_TYPE, typename VALUE_TYPE, template <typename> class ALLOC >
+	std::ostream& operator<<(std::ostream& os, BSTmap<KEY_TYPE, VALUE_TYPE, ALLOC> const& map);
 }
 
 #include "bst-map.cpp"
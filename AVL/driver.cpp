@@ -5,6 +5,7 @@
 
 
 #include "avl-map.h"
+#include "persistent-map.h"
 #include <iostream>
 #include <vector>
 #include <cstdlib> 
@@ -608,11 +609,656 @@ void test17()
     inserts_delete_random( 20000, 100, 20, 200, 0.5, false );
 }
 
+// bulk load and teardown of a big map
+// expected output - time, not used in grading
+#include <chrono>
+template < typename MAP >
+void load_and_teardown( std::vector<int> const& keys, char const* label )
+{
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    MAP * p_map = new MAP;
+    for ( int const & key : keys ) {
+        (*p_map)[ key ] = key;
+    }
+    std::chrono::duration<double> load_seconds = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    delete p_map;
+    std::chrono::duration<double> teardown_seconds = std::chrono::steady_clock::now() - start;
+
+    std::cout << label << " load " << load_seconds.count() << " teardown " << teardown_seconds.count() << std::endl;
+}
+
+void test18()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    std::vector<int> keys( 1000000 );
+    std::iota( keys.begin(), keys.end(), 1 );
+    std::shuffle( keys.begin(), keys.end(), std::mt19937{ 280 } );
+
+    load_and_teardown< CS280::BSTmap<int,int,CS280::BSTNewDelete> >( keys, "BSTmap new/delete" );
+    load_and_teardown< CS280::BSTmap<int,int> >( keys, "BSTmap node pool " );
+    load_and_teardown< CS280::AVLmap<int,int,CS280::BSTNewDelete> >( keys, "AVLmap new/delete" );
+    load_and_teardown< CS280::AVLmap<int,int> >( keys, "AVLmap node pool " );
+}
+
+// inserts and erases of a big map, std::map for reference
+// expected output - time, not used in grading
+#include <map>
+#include <thread>
+#include <sstream>
+template < typename MAP >
+void insert_and_erase( std::vector<int> keys, char const* label )
+{
+    MAP map;
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    for ( int const & key : keys ) {
+        map[ key ] = key;
+    }
+    std::chrono::duration<double> insert_seconds = std::chrono::steady_clock::now() - start;
+
+    std::shuffle( keys.begin(), keys.end(), std::mt19937{ 281 } );
+    start = std::chrono::steady_clock::now();
+    for ( int const & key : keys ) {
+        map.erase( map.find( key ) );
+    }
+    std::chrono::duration<double> erase_seconds = std::chrono::steady_clock::now() - start;
+
+    std::cout << label << " insert " << insert_seconds.count() << " erase " << erase_seconds.count() << std::endl;
+}
+
+void test19()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    std::vector<int> keys( 1000000 );
+    std::iota( keys.begin(), keys.end(), 1 );
+    insert_and_erase< CS280::AVLmap<int,int> >( keys, "AVLmap sorted  " );
+    insert_and_erase< std::map<int,int> >( keys, "std::map sorted" );
+
+    std::shuffle( keys.begin(), keys.end(), std::mt19937{ 280 } );
+    insert_and_erase< CS280::AVLmap<int,int> >( keys, "AVLmap random  " );
+    insert_and_erase< std::map<int,int> >( keys, "std::map random" );
+}
+
+// restoring a map from a sorted dump
+// expected output - time, not used in grading
+void test20()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    std::vector< std::pair<int,int> > dump( 1000000 );
+    for ( int i=0; i<static_cast<int>( dump.size() ); ++i ) {
+        dump[i] = std::make_pair( i, i );
+    }
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    CS280::AVLmap<int,int> inserted;
+    for ( std::pair<int,int> const & p : dump ) {
+        inserted[ p.first ] = p.second;
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "operator[]     " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    CS280::AVLmap<int,int> built( dump.begin(), dump.end() );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "range ctor     " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    built.assign_sorted( dump.begin(), dump.end(), std::thread::hardware_concurrency() );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "assign_sorted  " << seconds.count() << " (" << std::thread::hardware_concurrency() << " threads)" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::vector< std::pair<int,int> > back = built.to_sorted_vector();
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "to_sorted_vector " << seconds.count() << std::endl;
+
+    if ( back != dump ) {
+        std::cout << "round trip mismatch\n";
+    }
+}
+
+bool key_less( std::pair<int,int> const& a, std::pair<int,int> const& b )
+{
+    return a.first < b.first;
+}
+
+// whether a map iterator is at the same pair as an iterator into the sorted pairs
+bool matches( CS280::AVLmap<int,int>& map, CS280::AVLmap<int,int>::iterator it,
+              std::vector< std::pair<int,int> > const& pairs, std::vector< std::pair<int,int> >::const_iterator expected )
+{
+    if ( expected == pairs.end() ) return it == map.end();
+    return it != map.end() && it->Key() == expected->first && it->Value() == expected->second;
+}
+
+// whether a const query found the node the non-const one found
+bool same_node( CS280::AVLmap<int,int>& map, CS280::AVLmap<int,int>::const_iterator found, CS280::AVLmap<int,int>::iterator expected )
+{
+    CS280::AVLmap<int,int> const& constant = map;
+    if ( expected == map.end() ) return found == constant.end();
+    return found != constant.end() && &*found == &*expected;
+}
+
+// order statistics and range counts on a big map
+// expected output - time, not used in grading
+void test21()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    std::vector< std::pair<int,int> > dump( 1000000 );
+    for ( int i=0; i<static_cast<int>( dump.size() ); ++i ) {
+        dump[i] = std::make_pair( 2*i, i );
+    }
+    CS280::AVLmap<int,int> map( dump.begin(), dump.end() );
+    int const num_queries = 1000000;
+    std::mt19937 gen( 280 );
+    std::uniform_int_distribution<int> dis( 0, 2*static_cast<int>( dump.size() ) );
+    std::uniform_int_distribution<unsigned> pick( 0, static_cast<unsigned>( dump.size() ) - 1 );
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    unsigned long long total = 0;
+    for ( int i=0; i<num_queries; ++i ) {
+        int lo = dis( gen );
+        total += map.count_range( lo, lo + 1000 );
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "count_range " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for ( int i=0; i<num_queries; ++i ) {
+        total += map.select( pick( gen ) )->Value();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "select      " << seconds.count() << std::endl;
+
+    // the same windows counted by walking iterators, 1000 queries only
+    start = std::chrono::steady_clock::now();
+    for ( int i=0; i<1000; ++i ) {
+        int lo = dis( gen );
+        for ( CS280::AVLmap<int,int>::iterator it = map.lower_bound( lo ); it != map.end() && it->Key() < lo + 1000; ++it ) {
+            ++total;
+        }
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "iterator walk (1000 queries) " << seconds.count() << std::endl;
+
+    // every query answered as the sorted pairs answer it, hits and misses
+    typedef std::vector< std::pair<int,int> >::const_iterator pair_iterator;
+    CS280::AVLmap<int,int> const& constant = map;
+    unsigned errors = 0;
+    for ( int i=0; i<10000; ++i ) {
+        int key = dis( gen ), hi = key + dis( gen ) % 5000;
+        pair_iterator lower = std::lower_bound( dump.begin(), dump.end(), std::make_pair( key, 0 ), key_less );
+        pair_iterator upper = std::upper_bound( dump.begin(), dump.end(), std::make_pair( key, 0 ), key_less );
+        pair_iterator range_end = std::lower_bound( dump.begin(), dump.end(), std::make_pair( hi, 0 ), key_less );
+        unsigned k = pick( gen );
+
+        if ( !matches( map, map.lower_bound( key ), dump, lower ) || !matches( map, map.upper_bound( key ), dump, upper ) ) ++errors;
+        if ( !same_node( map, constant.lower_bound( key ), map.lower_bound( key ) ) ||
+             !same_node( map, constant.upper_bound( key ), map.upper_bound( key ) ) ) ++errors;
+        std::pair< CS280::AVLmap<int,int>::iterator, CS280::AVLmap<int,int>::iterator > range = map.equal_range( key );
+        if ( !matches( map, range.first, dump, lower ) || !matches( map, range.second, dump, upper ) ) ++errors;
+        if ( map.rank( key ) != static_cast<unsigned>( lower - dump.begin() ) ) ++errors;
+        if ( map.count_range( key, hi ) != static_cast<unsigned>( range_end - lower ) ) ++errors;
+        if ( !matches( map, map.select( k ), dump, dump.begin() + k ) || !same_node( map, constant.select( k ), map.select( k ) ) ) ++errors;
+    }
+    if ( map.select( map.size() ) != map.end() ) ++errors;
+
+    if ( total == 0 || errors != 0 ) {
+        std::cout << "query mismatch\n";
+    }
+}
+
+// one map of every second key, one of every third, from sorted ranges
+void make_halves( CS280::AVLmap<int,int>& evens, CS280::AVLmap<int,int>& thirds, int n )
+{
+    std::vector< std::pair<int,int> > dump( n );
+    for ( int i=0; i<n; ++i ) dump[i] = std::make_pair( 2*i, i );
+    evens.assign_sorted( dump.begin(), dump.end() );
+    for ( int i=0; i<n; ++i ) dump[i] = std::make_pair( 3*i, i );
+    thirds.assign_sorted( dump.begin(), dump.end() );
+}
+
+// the pairs of a map in key order
+std::vector< std::pair<int,int> > contents( CS280::AVLmap<int,int>& map )
+{
+    std::vector< std::pair<int,int> > pairs;
+    pairs.reserve( map.size() );
+    for ( CS280::AVLmap<int,int>::iterator it = map.begin(); it != map.end(); ++it ) {
+        pairs.push_back( std::make_pair( it->Key(), it->Value() ) );
+    }
+    return pairs;
+}
+
+void test22()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    int const n = 1000000;
+    unsigned const threads = std::max( 2u, std::thread::hardware_concurrency() );
+    CS280::AVLmap<int,int> evens, thirds;
+
+    // std::set_* copy the element of the first range for a key in both,
+    // which is the value the map operations keep
+    make_halves( evens, thirds, n );
+    std::vector< std::pair<int,int> > const evens_pairs = contents( evens ), thirds_pairs = contents( thirds );
+    std::vector< std::pair<int,int> > union_pairs, intersection_pairs, difference_pairs;
+    std::set_union( evens_pairs.begin(), evens_pairs.end(), thirds_pairs.begin(), thirds_pairs.end(),
+                    std::back_inserter( union_pairs ), key_less );
+    std::set_intersection( evens_pairs.begin(), evens_pairs.end(), thirds_pairs.begin(), thirds_pairs.end(),
+                           std::back_inserter( intersection_pairs ), key_less );
+    std::set_difference( evens_pairs.begin(), evens_pairs.end(), thirds_pairs.begin(), thirds_pairs.end(),
+                         std::back_inserter( difference_pairs ), key_less );
+
+    make_halves( evens, thirds, n );
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    for ( CS280::AVLmap<int,int>::iterator it = thirds.begin(); it != thirds.end(); ++it ) {
+        evens[ it->Key() ] = it->Value();
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "union by inserts         " << seconds.count() << std::endl;
+    if ( evens.size() != union_pairs.size() ) std::cout << "union by inserts mismatch\n";
+
+    make_halves( evens, thirds, n );
+    start = std::chrono::steady_clock::now();
+    evens.set_union( std::move( thirds ) );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "set_union                " << seconds.count() << std::endl;
+    if ( contents( evens ) != union_pairs || thirds.size() != 0 ) std::cout << "union mismatch\n";
+
+    make_halves( evens, thirds, n );
+    start = std::chrono::steady_clock::now();
+    evens.set_union( std::move( thirds ), threads );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "set_union (threads)      " << seconds.count() << std::endl;
+    if ( contents( evens ) != union_pairs ) std::cout << "union (threads) mismatch\n";
+
+    make_halves( evens, thirds, n );
+    start = std::chrono::steady_clock::now();
+    evens.set_intersection( std::move( thirds ), threads );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "set_intersection         " << seconds.count() << std::endl;
+    if ( contents( evens ) != intersection_pairs ) std::cout << "intersection mismatch\n";
+
+    make_halves( evens, thirds, n );
+    start = std::chrono::steady_clock::now();
+    evens.set_difference( std::move( thirds ), threads );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "set_difference           " << seconds.count() << std::endl;
+    if ( contents( evens ) != difference_pairs ) std::cout << "difference mismatch\n";
+
+    // a small map into a big one costs O(m log(n/m + 1))
+    make_halves( evens, thirds, n );
+    CS280::AVLmap<int,int> few;
+    std::vector< std::pair<int,int> > few_pairs;
+    for ( int i=0; i<1000; ++i ) {
+        few[ 6000*i + 1 ] = i;
+        few_pairs.push_back( std::make_pair( 6000*i + 1, i ) );
+    }
+    std::vector< std::pair<int,int> > merged;
+    std::merge( evens_pairs.begin(), evens_pairs.end(), few_pairs.begin(), few_pairs.end(),
+                std::back_inserter( merged ), key_less );
+    start = std::chrono::steady_clock::now();
+    evens.set_union( std::move( few ) );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "set_union 1000 keys      " << seconds.count() << std::endl;
+    if ( contents( evens ) != merged ) std::cout << "union mismatch\n";
+
+    start = std::chrono::steady_clock::now();
+    CS280::AVLmap<int,int> upper = evens.split( n + 1 );
+    std::chrono::duration<double> split_seconds = std::chrono::steady_clock::now() - start;
+    std::vector< std::pair<int,int> >::iterator cut = std::lower_bound( merged.begin(), merged.end(), std::make_pair( n + 1, 0 ), key_less );
+    if ( contents( evens ) != std::vector< std::pair<int,int> >( merged.begin(), cut ) ||
+         contents( upper ) != std::vector< std::pair<int,int> >( cut, merged.end() ) ) std::cout << "split mismatch\n";
+    start = std::chrono::steady_clock::now();
+    evens.join( n + 1, 0, std::move( upper ) );
+    seconds = split_seconds + ( std::chrono::steady_clock::now() - start );
+    std::cout << "split + join             " << seconds.count() << std::endl;
+    merged.insert( cut, std::make_pair( n + 1, 0 ) );
+    if ( contents( evens ) != merged || upper.size() != 0 ) std::cout << "join mismatch\n";
+}
+
+void test23()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    // 4M keys, far more than fits in L2
+    std::vector< std::pair<int,int> > dump( 4000000 );
+    for ( int i=0; i<static_cast<int>( dump.size() ); ++i ) {
+        dump[i] = std::make_pair( 2*i, i );
+    }
+    CS280::AVLmap<int,int> map( dump.begin(), dump.end() );
+    CS280::FrozenMap<int,int> frozen = map.freeze();
+    std::vector<int> queries( 4000000 );
+    std::mt19937 gen( 280 );
+    std::uniform_int_distribution<int> dis( 0, 2*static_cast<int>( dump.size() ) );
+    for ( int& q : queries ) q = dis( gen );
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    unsigned long long found_map = 0;
+    for ( int q : queries ) {
+        CS280::AVLmap<int,int>::iterator it = map.find( q );
+        if ( it != map.end() ) found_map += it->Value();
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "AVLmap find        " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    unsigned long long found_frozen = 0;
+    for ( int q : queries ) {
+        CS280::FrozenMap<int,int>::const_iterator it = frozen.find( q );
+        if ( it != frozen.end() ) found_frozen += it->Value();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "FrozenMap find     " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    unsigned long long found_bounds = 0;
+    for ( int q : queries ) {
+        CS280::FrozenMap<int,int>::const_iterator it = frozen.lower_bound( q );
+        if ( it != frozen.end() ) found_bounds += it->Key();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "FrozenMap lower_bound " << seconds.count() << std::endl;
+
+    // binary search over the sorted pairs for comparison
+    start = std::chrono::steady_clock::now();
+    unsigned long long found_sorted = 0;
+    for ( int q : queries ) {
+        std::vector< std::pair<int,int> >::iterator it = std::lower_bound( dump.begin(), dump.end(), std::make_pair( q, 0 ) );
+        if ( it != dump.end() && it->first == q ) found_sorted += it->second;
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "std::lower_bound   " << seconds.count() << std::endl;
+
+    // lower_bound of the frozen map and of the tree, hits and misses, as std::lower_bound
+    unsigned errors = 0;
+    for ( int i=0; i<200000; ++i ) {
+        std::vector< std::pair<int,int> >::const_iterator expected = std::lower_bound( dump.begin(), dump.end(), std::make_pair( queries[i], 0 ), key_less );
+        CS280::FrozenMap<int,int>::const_iterator it = frozen.lower_bound( queries[i] );
+        if ( expected == dump.end() ? it != frozen.end() :
+             it == frozen.end() || it->Key() != expected->first || it->Value() != expected->second ) ++errors;
+        if ( !matches( map, map.lower_bound( queries[i] ), dump, expected ) ) ++errors;
+    }
+    if ( frozen.lower_bound( dump.back().first + 1 ) != frozen.end() || map.lower_bound( dump.back().first + 1 ) != map.end() ) ++errors;
+
+    if ( found_map != found_frozen || found_map != found_sorted || found_bounds == 0 || errors != 0 ) {
+        std::cout << "lookup mismatch\n";
+    }
+}
+
+void test24()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    int const num_keys = 1000000;
+    std::vector<int> keys( num_keys );
+    std::iota( keys.begin(), keys.end(), 0 );
+    std::shuffle( keys.begin(), keys.end(), std::mt19937( 280 ) );
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    CS280::AVLmap<int,int> map;
+    for ( int key : keys ) map[key] = key;
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "AVLmap inserts                   " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    CS280::PersistentMap<int,int> persistent;
+    for ( int key : keys ) persistent.insert( key, key );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "PersistentMap inserts            " << seconds.count() << std::endl;
+
+    // a reader's snapshot every 1000 writes, only the latest is kept
+    start = std::chrono::steady_clock::now();
+    CS280::PersistentMap<int,int> versioned, reader;
+    for ( int i=0; i<num_keys; ++i ) {
+        versioned.insert( keys[i], keys[i] );
+        if ( i % 1000 == 0 ) reader = versioned.snapshot();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "PersistentMap inserts, snapshots " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    unsigned long long total = 0;
+    for ( int i=0; i<100; ++i ) {
+        CS280::PersistentMap<int,int> snapshot = persistent.snapshot();
+        total += snapshot.size();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "100 snapshots                    " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for ( int i=0; i<3; ++i ) {
+        CS280::AVLmap<int,int> copy( map );
+        total += copy.size();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "3 AVLmap copies                  " << seconds.count() << std::endl;
+
+    if ( persistent.size() != map.size() || versioned.size() != map.size() || total == 0 ) {
+        std::cout << "size mismatch\n";
+    }
+}
+
+// walks two maps in lockstep, true if every key and value is the same
+template < typename MAP >
+bool same_pairs( MAP& lhs, MAP& rhs )
+{
+    typename MAP::iterator a = lhs.begin(), b = rhs.begin();
+    for ( ; a != lhs.end() && b != rhs.end(); ++a, ++b ) {
+        if ( a->Key() != b->Key() || a->Value() != b->Value() ) return false;
+    }
+    return a == lhs.end() && b == rhs.end() && lhs.size() == rhs.size();
+}
+
+void test25()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    unsigned const threads = std::max( 2u, std::thread::hardware_concurrency() );
+    std::vector< std::pair<int,int> > dump( 2000000 );
+    for ( int i=0; i<static_cast<int>( dump.size() ); ++i ) {
+        dump[i] = std::make_pair( i, i );
+    }
+    CS280::AVLmap<int,int> map( dump.begin(), dump.end() );
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    CS280::AVLmap<int,int> copy( map );
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "copy                 " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    CS280::AVLmap<int,int> parallel_copy( map, threads );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "copy (threads)       " << seconds.count() << std::endl;
+    if ( !same_pairs( map, copy ) || !same_pairs( map, parallel_copy ) ||
+         !copy.sanityCheck() || !parallel_copy.sanityCheck() ) std::cout << "copy mismatch\n";
+
+    // teardown has to visit the nodes when every node is its own allocation
+    CS280::AVLmap<int,int,CS280::BSTNewDelete> heap( dump.begin(), dump.end() );
+    CS280::AVLmap<int,int,CS280::BSTNewDelete> heap_copy( heap, threads );
+    if ( !same_pairs( heap, heap_copy ) || !heap_copy.sanityCheck() ) std::cout << "copy mismatch\n";
+    start = std::chrono::steady_clock::now();
+    heap.clear();
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "new/delete clear     " << seconds.count() << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    heap_copy.clear( threads );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "new/delete clear (threads) " << seconds.count() << std::endl;
+    if ( heap.size() != 0 || heap_copy.size() != 0 ) std::cout << "clear mismatch\n";
+}
+
+void test26()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    std::vector< std::pair<int,int> > dump( 1000000 );
+    for ( int i=0; i<static_cast<int>( dump.size() ); ++i ) {
+        dump[i] = std::make_pair( 3*i, i );
+    }
+    CS280::AVLmap<int,int> map( dump.begin(), dump.end() );
+
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    std::stringstream text;
+    for ( CS280::AVLmap<int,int>::iterator it = map.begin(); it != map.end(); ++it ) {
+        text << it->Key() << " " << it->Value() << "\n";
+    }
+    CS280::AVLmap<int,int> from_text;
+    int key = 0, value = 0;
+    while ( text >> key >> value ) {
+        from_text[key] = value;
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "text save+load       " << seconds.count() << " (" << text.str().size() << " bytes)" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::stringstream binary;
+    map.serialize( binary );
+    CS280::AVLmap<int,int> from_binary;
+    bool ok = from_binary.deserialize( binary );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "serialize+deserialize " << seconds.count() << " (" << binary.str().size() << " bytes)" << std::endl;
+
+    if ( !ok || from_binary.to_sorted_vector() != dump || from_text.to_sorted_vector() != dump ) std::cout << "serialize mismatch\n";
+}
+
+// the pairs of a persistent map in key order
+std::vector< std::pair<int,int> > contents( CS280::PersistentMap<int,int> const& map )
+{
+    std::vector< std::pair<int,int> > pairs;
+    for ( CS280::PersistentMap<int,int>::const_iterator it = map.begin(); it != map.end(); ++it ) {
+        pairs.push_back( std::make_pair( it->Key(), it->Value() ) );
+    }
+    return pairs;
+}
+
+void test27()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    // every version keeps its contents while later versions insert and erase
+    std::mt19937 gen( 280 );
+    std::uniform_int_distribution<int> dis( 0, 299 );
+    CS280::PersistentMap<int,int> map;
+    std::map<int,int> model;
+    for ( int i=0; i<200; ++i ) {
+        map.insert( i, i );
+        model[i] = i;
+    }
+    std::vector< CS280::PersistentMap<int,int> > versions;
+    std::vector< std::vector< std::pair<int,int> > > expected;
+    for ( int round=0; round<500; ++round ) {
+        versions.push_back( map.snapshot() );
+        expected.push_back( std::vector< std::pair<int,int> >( model.begin(), model.end() ) );
+        for ( int i=0; i<10; ++i ) {
+            int key = dis( gen );
+            if ( i % 2 ) {
+                map.insert( key, round );
+                model[key] = round;
+            } else if ( map.erase( key ) != ( model.erase( key ) == 1 ) ) {
+                std::cout << "erase mismatch\n";
+            }
+        }
+    }
+    unsigned kept = 0;
+    for ( unsigned i=0; i<versions.size(); ++i ) {
+        if ( contents( versions[i] ) == expected[i] && versions[i].size() == expected[i].size() ) ++kept;
+    }
+    std::cout << "versions that kept their contents " << kept << " of " << versions.size() << std::endl;
+    std::cout << "latest version matches " << ( contents( map ) == std::vector< std::pair<int,int> >( model.begin(), model.end() ) ) << std::endl;
+
+    // a map and its snapshot written on two threads at once
+    CS280::PersistentMap<int,int> first;
+    for ( int i=0; i<20000; ++i ) first.insert( i, i );
+    CS280::PersistentMap<int,int> second = first.snapshot();
+    std::thread writer( [&first]() {
+        for ( int i=0; i<20000; i+=2 ) first.erase( i );
+        for ( int i=20000; i<21000; ++i ) first.insert( i, -i );
+    } );
+    for ( int i=1; i<20000; i+=2 ) second.erase( i );
+    for ( int i=0; i<20000; i+=4 ) second.insert( i, -i );
+    writer.join();
+    bool odds = first.size() == 11000, evens = second.size() == 10000;
+    for ( CS280::PersistentMap<int,int>::const_iterator it = first.begin(); it != first.end(); ++it ) {
+        odds = odds && ( it->Key() < 20000 ? it->Key() % 2 == 1 && it->Value() == it->Key() : it->Value() == -it->Key() );
+    }
+    for ( CS280::PersistentMap<int,int>::const_iterator it = second.begin(); it != second.end(); ++it ) {
+        evens = evens && it->Key() % 2 == 0 && it->Value() == ( it->Key() % 4 ? it->Key() : -it->Key() );
+    }
+    std::cout << "first writer left odd keys " << odds << std::endl;
+    std::cout << "second writer left even keys " << evens << std::endl;
+}
+
+// a stream buffer that cannot seek, like a pipe
+class OneWayBuffer : public std::streambuf
+{
+    public:
+        explicit OneWayBuffer( std::string const& data ) : data_( data ) {
+            setg( &data_[0], &data_[0], &data_[0] + data_.size() );
+        }
+    private:
+        std::string data_;
+};
+
+void test28()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    CS280::AVLmap<int,std::string> names;
+    for ( int i=0; i<100; ++i ) names[i] = std::string( static_cast<std::size_t>( i % 7 ), static_cast<char>( 'a' + i % 26 ) );
+    std::stringstream saved;
+    names.serialize( saved );
+    std::string const bytes = saved.str();
+
+    CS280::AVLmap<int,std::string> same;
+    std::stringstream in( bytes );
+    std::cout << "same types load " << ( same.deserialize( in ) && same.to_sorted_vector() == names.to_sorted_vector() ) << std::endl;
+    CS280::AVLmap<float,std::string> floats;
+    in.clear();
+    in.str( bytes );
+    std::cout << "float keys load " << floats.deserialize( in ) << ", size " << floats.size() << std::endl;
+    CS280::AVLmap<unsigned,std::string> unsigneds;
+    in.clear();
+    in.str( bytes );
+    std::cout << "unsigned keys load " << unsigneds.deserialize( in ) << ", size " << unsigneds.size() << std::endl;
+
+    // every truncation is rejected and leaves the map empty
+    unsigned rejected = 0;
+    for ( std::size_t length=0; length<bytes.size(); ++length ) {
+        std::stringstream cut( bytes.substr( 0, length ) );
+        if ( !same.deserialize( cut ) && same.size() == 0 && same.begin() == same.end() ) ++rejected;
+    }
+    std::cout << "truncations rejected " << rejected << " of " << bytes.size() << std::endl;
+
+    // pairs out of order, the first two keys swapped
+    CS280::AVLmap<int,int> numbers;
+    for ( int i=0; i<100; ++i ) numbers[i] = -i;
+    std::stringstream plain;
+    numbers.serialize( plain );
+    std::string swapped = plain.str();
+    std::size_t const header = swapped.size() - 100 * 2 * sizeof( int );
+    std::swap_ranges( swapped.begin() + header, swapped.begin() + header + sizeof( int ), swapped.begin() + header + 2 * sizeof( int ) );
+    CS280::AVLmap<int,int> loaded;
+    in.clear();
+    in.str( swapped );
+    std::cout << "out of order loads " << loaded.deserialize( in ) << ", size " << loaded.size() << std::endl;
+
+    // two maps in one stream, the first load gives back what it read ahead
+    std::stringstream both;
+    numbers.serialize( both );
+    names.serialize( both );
+    bool first = loaded.deserialize( both ) && loaded.to_sorted_vector() == numbers.to_sorted_vector();
+    bool second = same.deserialize( both ) && same.to_sorted_vector() == names.to_sorted_vector();
+    std::cout << "two maps in one stream load " << first << " " << second << ", stream fail " << both.fail() << std::endl;
+
+    // a stream that cannot seek keeps the state reading left it in
+    OneWayBuffer pipe( plain.str() );
+    std::istream one_way( &pipe );
+    std::cout << "one way stream loads " << ( loaded.deserialize( one_way ) && loaded.to_sorted_vector() == numbers.to_sorted_vector() )
+              << ", fail " << one_way.fail() << ", eof " << one_way.eof() << std::endl;
+    std::stringstream failed( plain.str() );
+    failed.setstate( std::ios_base::failbit );
+    std::cout << "failed stream loads " << loaded.deserialize( failed ) << ", fail " << failed.fail() << std::endl;
+}
 
 void (*pTests[])(void) = 
 {
     test0,test1,test2,test3,test4,test5,test6,test7,test8,test9,test10,test11,test12,test13,
-    test14,test15,test16,test17
+    test14,test15,test16,test17,test18,test19,test20,test21,test22,test23,test24,test25,test26,test27,test28
 };
 
 int main(int argc, char **argv) 
@@ -0,0 +1,278 @@
+/// --------------------------------------------------------------------------
+/// @file frozen-map.cpp
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+/// @brief Implementation of the read-only Eytzinger layout map
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+
+#include "frozen-map.h"
+#include <iterator> // std::distance
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator constructor
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param map         - The map iterated over.
+/// @param slot        - The slot, 0 for the end.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::FrozenMap_iterator(const FrozenMap *map, std::size_t slot)
+	: map_(map)
+	, slot_(slot)
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Moves to the next key: down the right child and then left, or up past
+///        every slot this one is the right child of.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return Reference to this iterator (FrozenMap_iterator&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator &CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::operator++()
+{
+	std::size_t count = map_->size();
+	if (2 * slot_ + 1 <= count)
+	{
+		slot_ = 2 * slot_ + 1;
+		while (2 * slot_ <= count)
+		{
+			slot_ = 2 * slot_;
+		}
+	}
+	else
+	{
+		while (slot_ & 1)
+		{
+			slot_ >>= 1;
+		}
+		slot_ >>= 1;
+	}
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Post increment
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The iterator before the increment (FrozenMap_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::operator++(int)
+{
+	FrozenMap_iterator copy(*this);
+	++(*this);
+	return copy;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The key at the iterator
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The key (KEY_TYPE const&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+KEY_TYPE const &CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::Key() const
+{
+	return map_->keys_[slot_];
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The value at the iterator
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The value (VALUE_TYPE const&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+VALUE_TYPE const &CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::Value() const
+{
+	return map_->values_[slot_];
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Inequality
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The other iterator.
+/// @return True if the iterators are at different slots (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::operator!=(const FrozenMap_iterator &rhs) const
+{
+	return slot_ != rhs.slot_;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Equality
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The other iterator.
+/// @return True if the iterators are at the same slot (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap_iterator::operator==(const FrozenMap_iterator &rhs) const
+{
+	return slot_ == rhs.slot_;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Empty frozen map
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap()
+	: keys_(1)
+	, values_(1)
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Lays out a sorted range of (key, value) pairs, O(n).
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam IT         - Iterator over std::pair<KEY_TYPE, VALUE_TYPE> (a move iterator moves them).
+/// @param first       - Start of the range.
+/// @param last        - End of the range.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+template <typename IT>
+CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::FrozenMap(IT first, IT last)
+	: keys_(1 + static_cast<std::size_t>(std::distance(first, last)))
+	, values_(keys_.size())
+{
+	Fill(first, 1);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Fills the slots of a subtree in order, so the range is read once from the front.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam IT         - Iterator over the pairs.
+/// @param it          - The next pair, advanced past the subtree.
+/// @param slot        - Root of the subtree.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+template <typename IT>
+void CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::Fill(IT &it, std::size_t slot)
+{
+	if (slot >= keys_.size())
+	{
+		return;
+	}
+	Fill(it, 2 * slot);
+	keys_[slot] = (*it).first;
+	values_[slot] = (*it).second;
+	++it;
+	Fill(it, 2 * slot + 1);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Number of keys
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The number of keys (std::size_t).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::size() const
+{
+	return keys_.size() - 1;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator to the smallest key, the leftmost slot.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The iterator (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::begin() const
+{
+	std::size_t slot = size() ? 1 : 0;
+	while (slot && 2 * slot <= size())
+	{
+		slot = 2 * slot;
+	}
+	return const_iterator(this, slot);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator past the largest key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The iterator (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::end() const
+{
+	return const_iterator(this, 0);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Finds a key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key to find.
+/// @return Iterator to the key, end() if it is not there (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const &key) const
+{
+	std::size_t slot = LowerBound(key);
+	return const_iterator(this, (slot && !(key < keys_[slot])) ? slot : 0);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief First key not less than key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key to search for.
+/// @return Iterator to the first key not less than key, or end() (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::lower_bound(KEY_TYPE const &key) const
+{
+	return const_iterator(this, LowerBound(key));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Slot of the first key not less than key. The descent always runs to the
+///        bottom and picks the child with arithmetic instead of a branch, the
+///        answer is the last slot where the search went left: drop the trailing
+///        right turns (1 bits) and that left turn.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key to search for.
+/// @return The slot, 0 if every key is less than key (std::size_t).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+std::size_t CS280::FrozenMap<KEY_TYPE, VALUE_TYPE>::LowerBound(KEY_TYPE const &key) const
+{
+	const KEY_TYPE *keys = keys_.data();
+	const std::size_t slots = keys_.size();
+
+	std::size_t slot = 1;
+	while (slot < slots)
+	{
+#if defined(__GNUC__)
+		// The 16 slots four levels down are next to each other.
+		std::size_t ahead = slot * PrefetchStride;
+		__builtin_prefetch(keys + (ahead < slots ? ahead : 0));
+#endif
+		slot = 2 * slot + static_cast<std::size_t>(keys[slot] < key);
+	}
+
+#if defined(__GNUC__)
+	slot >>= __builtin_ctzll(~static_cast<unsigned long long>(slot)) + 1;
+#else
+	while (slot & 1)
+	{
+		slot >>= 1;
+	}
+	slot >>= 1;
+#endif
+	return slot;
+}
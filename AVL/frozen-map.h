@@ -0,0 +1,79 @@
+/// --------------------------------------------------------------------------
+/// @file frozen-map.h
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+/// @brief Read-only map in Eytzinger layout, exported by BSTmap::freeze()
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+#ifndef FROZENMAP_H
+#define FROZENMAP_H
+
+#include <cstddef> // std::size_t
+#include <vector>  // std::vector
+
+namespace CS280
+{
+	/// @brief Read-only copy of a map with the keys stored in one array in
+	///        Eytzinger (breadth first) order: the children of slot k are slots
+	///        2k and 2k+1. The top levels of the search share a few cache lines,
+	///        the search does not branch on the comparison and prefetches the
+	///        slots four levels down. Changes to the map it came from are not
+	///        seen, call freeze() again to rebuild it.
+	/// @tparam KEY_TYPE   - The data type of the key (default constructible).
+	/// @tparam VALUE_TYPE - The data type of the value (default constructible).
+	template< typename KEY_TYPE, typename VALUE_TYPE >
+	class FrozenMap
+	{
+		public:
+			/// @brief In order iterator, slot 0 is the end.
+			class FrozenMap_iterator
+			{
+				public:
+					FrozenMap_iterator(const FrozenMap* map = nullptr, std::size_t slot = 0);
+					FrozenMap_iterator& operator++();
+					FrozenMap_iterator operator++(int);
+					KEY_TYPE const& Key() const;
+					VALUE_TYPE const& Value() const;
+					// So it->Key() reads the same as with the map iterators.
+					FrozenMap_iterator const* operator->() const { return this; }
+					bool operator!=(const FrozenMap_iterator& rhs) const;
+					bool operator==(const FrozenMap_iterator& rhs) const;
+
+				private:
+					const FrozenMap* map_;
+					std::size_t slot_;
+			};
+
+			typedef FrozenMap_iterator const_iterator;
+
+			FrozenMap();
+			// From (key, value) pairs with strictly increasing keys.
+			template< typename IT >
+			FrozenMap(IT first, IT last);
+
+			std::size_t size() const;
+			const_iterator begin() const;
+			const_iterator end() const;
+			const_iterator find(KEY_TYPE const& key) const;
+			// First key not less than key.
+			const_iterator lower_bound(KEY_TYPE const& key) const;
+
+		private:
+			// Slots between the slot being compared and the one prefetched (four levels).
+			static const std::size_t PrefetchStride = 16;
+
+			std::size_t LowerBound(KEY_TYPE const& key) const;
+			template< typename IT >
+			void Fill(IT& it, std::size_t slot);
+
+			// Slot 0 is unused so the root is slot 1.
+			std::vector<KEY_TYPE> keys_;
+			std::vector<VALUE_TYPE> values_;
+	};
+}
+
+#include "frozen-map.cpp"
+#endif
@@ -0,0 +1,339 @@
+/// --------------------------------------------------------------------------
+/// @file map-serial.cpp
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+/// @brief Implementation of the binary map format
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+
+#include "map-serial.h"
+#include <cstring> // std::memcpy, std::memcmp
+
+namespace CS280
+{
+	namespace
+	{
+		const char SerialMagic[8] = {'C', 'S', '2', '8', '0', 'M', 'A', 'P'};
+		const std::uint32_t SerialVersion = 2;
+		// Reads back as something else on a machine with the other byte order.
+		const std::uint32_t SerialByteOrder = 0x01020304;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Writer constructor
+/// @param os - The stream to write to.
+//-------------------------------------------------------------------------------------------------------------------------
+inline CS280::SerialWriter::SerialWriter(std::ostream &os)
+	: os_(os)
+	, buffer_()
+{
+	buffer_.reserve(ChunkSize);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Writer destructor, writes out what is left.
+//-------------------------------------------------------------------------------------------------------------------------
+inline CS280::SerialWriter::~SerialWriter()
+{
+	flush();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Adds bytes to the output, a full chunk goes to the stream.
+/// @param bytes - The bytes.
+/// @param count - Number of bytes.
+//-------------------------------------------------------------------------------------------------------------------------
+inline void CS280::SerialWriter::write(const void *bytes, std::size_t count)
+{
+	const char *data = static_cast<const char *>(bytes);
+	if (buffer_.size() + count > ChunkSize)
+	{
+		flush();
+		// Too big to be worth copying.
+		if (count >= ChunkSize)
+		{
+			os_.write(data, static_cast<std::streamsize>(count));
+			return;
+		}
+	}
+	buffer_.insert(buffer_.end(), data, data + count);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Writes out what is buffered.
+/// @return False if the stream failed (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+inline bool CS280::SerialWriter::flush()
+{
+	if (!buffer_.empty())
+	{
+		os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+		buffer_.clear();
+	}
+	return static_cast<bool>(os_);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Reader constructor
+/// @param is - The stream to read from.
+//-------------------------------------------------------------------------------------------------------------------------
+inline CS280::SerialReader::SerialReader(std::istream &is)
+	: is_(is)
+	, buffer_(ChunkSize)
+	, pos_(0)
+	, end_(0)
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Reader destructor, gives the bytes it read ahead back to the stream if it
+///        can seek. Otherwise the stream is left in the state reading left it in.
+//-------------------------------------------------------------------------------------------------------------------------
+inline CS280::SerialReader::~SerialReader()
+{
+	if (pos_ < end_)
+	{
+		// Telling and seeking need the fail bit clear, reading ahead may have set it.
+		std::ios_base::iostate state = is_.rdstate();
+		is_.clear();
+		if (is_.tellg() == std::istream::pos_type(-1) ||
+		    !is_.seekg(-static_cast<std::streamoff>(end_ - pos_), std::ios_base::cur))
+		{
+			is_.clear(state);
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copies the next bytes out, refilling the chunk from the stream as needed.
+/// @param bytes - Where to copy to.
+/// @param count - Number of bytes.
+/// @return False if the stream ends first (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+inline bool CS280::SerialReader::read(void *bytes, std::size_t count)
+{
+	char *data = static_cast<char *>(bytes);
+	while (count)
+	{
+		if (pos_ == end_)
+		{
+			is_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+			pos_ = 0;
+			end_ = static_cast<std::size_t>(is_.gcount());
+			if (end_ == 0)
+			{
+				return false;
+			}
+			// A short chunk is the end of the stream, not a failed read.
+			if (is_.eof() && !is_.bad())
+			{
+				is_.clear(std::ios_base::eofbit);
+			}
+		}
+
+		std::size_t take = std::min(count, end_ - pos_);
+		std::memcpy(data, buffer_.data() + pos_, take);
+		pos_ += take;
+		data += take;
+		count -= take;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Writes a string as its length and its characters.
+/// @param out   - The writer.
+/// @param value - The string.
+//-------------------------------------------------------------------------------------------------------------------------
+inline void CS280::Serializer<std::string>::write(SerialWriter &out, const std::string &value)
+{
+	std::uint64_t length = value.size();
+	out.write(&length, sizeof(length));
+	out.write(value.data(), value.size());
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Reads a string written by write().
+/// @param in    - The reader.
+/// @param value - The string to read into.
+/// @return False if the data ran out (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+inline bool CS280::Serializer<std::string>::read(SerialReader &in, std::string &value)
+{
+	std::uint64_t length = 0;
+	if (!in.read(&length, sizeof(length)))
+	{
+		return false;
+	}
+
+	// Grow as the characters arrive, a corrupt length must not allocate it all up front.
+	value.clear();
+	char chunk[4096];
+	while (length)
+	{
+		std::size_t take = length < sizeof(chunk) ? static_cast<std::size_t>(length) : sizeof(chunk);
+		if (!in.read(chunk, take))
+		{
+			return false;
+		}
+		value.append(chunk, take);
+		length -= take;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The header for a map with the given types and number of pairs.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param count       - Number of pairs.
+/// @return The header (SerialHeader).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::SerialHeader CS280::SerialHeader::For(std::uint64_t count)
+{
+	SerialHeader header;
+	header.keySize = sizeof(KEY_TYPE);
+	header.valueSize = sizeof(VALUE_TYPE);
+	header.keyTag = Serializer<KEY_TYPE>::tag;
+	header.valueTag = Serializer<VALUE_TYPE>::tag;
+	header.count = count;
+	return header;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Whether two headers describe the same key and value types.
+/// @param other - The other header.
+/// @return True if the types match (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+inline bool CS280::SerialHeader::Matches(const SerialHeader &other) const
+{
+	return keySize == other.keySize && valueSize == other.valueSize && keyTag == other.keyTag && valueTag == other.valueTag;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Writes the header.
+/// @param out - The writer.
+//-------------------------------------------------------------------------------------------------------------------------
+inline void CS280::SerialHeader::write(SerialWriter &out) const
+{
+	out.write(SerialMagic, sizeof(SerialMagic));
+	out.write(&SerialVersion, sizeof(SerialVersion));
+	out.write(&SerialByteOrder, sizeof(SerialByteOrder));
+	out.write(&keySize, sizeof(keySize));
+	out.write(&valueSize, sizeof(valueSize));
+	out.write(&keyTag, sizeof(keyTag));
+	out.write(&valueTag, sizeof(valueTag));
+	out.write(&count, sizeof(count));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Reads a header written by write().
+/// @param in - The reader.
+/// @return False if the data ran out or is not a map of this format (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+inline bool CS280::SerialHeader::read(SerialReader &in)
+{
+	char magic[sizeof(SerialMagic)];
+	std::uint32_t version = 0;
+	std::uint32_t byteOrder = 0;
+	if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SerialMagic, sizeof(magic)) != 0)
+	{
+		return false;
+	}
+	if (!in.read(&version, sizeof(version)) || version != SerialVersion)
+	{
+		return false;
+	}
+	if (!in.read(&byteOrder, sizeof(byteOrder)) || byteOrder != SerialByteOrder)
+	{
+		return false;
+	}
+	return in.read(&keySize, sizeof(keySize)) && in.read(&valueSize, sizeof(valueSize)) && in.read(&keyTag, sizeof(keyTag)) &&
+	       in.read(&valueTag, sizeof(valueTag)) && in.read(&count, sizeof(count));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Pair reader constructor, decodes the first pair.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param in          - The reader, just past the header.
+/// @param count       - Number of pairs.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::SerialPairs<KEY_TYPE, VALUE_TYPE>::SerialPairs(SerialReader &in, std::uint64_t count)
+	: in_(in)
+	, remaining_(count)
+	, ok_(true)
+	, current_()
+	, next_()
+{
+	Next(true);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief The current pair
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return Pointer to the pair (const std::pair<KEY_TYPE, VALUE_TYPE>*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+const std::pair<KEY_TYPE, VALUE_TYPE> *CS280::SerialPairs<KEY_TYPE, VALUE_TYPE>::operator->() const
+{
+	return &current_;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Decodes the next pair
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return Reference to this reader (SerialPairs&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::SerialPairs<KEY_TYPE, VALUE_TYPE> &CS280::SerialPairs<KEY_TYPE, VALUE_TYPE>::operator++()
+{
+	Next(false);
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Whether every pair so far was there and in order.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return True if the data is good (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::SerialPairs<KEY_TYPE, VALUE_TYPE>::ok() const
+{
+	return ok_;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Decodes a pair into current_. After a failure the old pair stays, it is not
+///        linked: BuildSorted checks Readable() before using a pair.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param first       - Whether this is the first pair (no order to check).
+/// @return False once the data is bad (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::SerialPairs<KEY_TYPE, VALUE_TYPE>::Next(bool first)
+{
+	if (!ok_ || remaining_ == 0)
+	{
+		return false;
+	}
+	--remaining_;
+
+	if (!Serializer<KEY_TYPE>::read(in_, next_) || !(first || current_.first < next_) ||
+	    !Serializer<VALUE_TYPE>::read(in_, current_.second))
+	{
+		ok_ = false;
+		return false;
+	}
+	std::swap(current_.first, next_);
+	return true;
+}
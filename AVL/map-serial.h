@@ -0,0 +1,160 @@
+/// --------------------------------------------------------------------------
+/// @file map-serial.h
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+/// @brief Binary format used by BSTmap::serialize and BSTmap::deserialize
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+#ifndef MAPSERIAL_H
+#define MAPSERIAL_H
+
+#include <algorithm>   // std::min
+#include <cstddef>     // std::size_t
+#include <cstdint>     // std::uint32_t, std::uint64_t
+#include <iostream>    // std::istream, std::ostream
+#include <string>      // std::string
+#include <type_traits> // std::is_trivially_copyable
+#include <utility>     // std::pair
+#include <vector>      // std::vector
+
+namespace CS280
+{
+	/// @brief Collects output and hands it to the stream in big chunks.
+	class SerialWriter
+	{
+		public:
+			explicit SerialWriter(std::ostream& os);
+			SerialWriter(const SerialWriter&)            = delete;
+			SerialWriter& operator=(const SerialWriter&) = delete;
+			~SerialWriter();
+
+			void write(const void* bytes, std::size_t count);
+			// Writes out what is buffered, false if the stream failed.
+			bool flush();
+
+		private:
+			static const std::size_t ChunkSize = 1 << 16;
+			std::ostream& os_;
+			std::vector<char> buffer_;
+	};
+
+	/// @brief Reads the stream in big chunks and hands out the bytes as asked.
+	///        Bytes read past the end of the data are given back to the stream
+	///        when it can seek, otherwise they are lost and the stream keeps
+	///        its state.
+	class SerialReader
+	{
+		public:
+			explicit SerialReader(std::istream& is);
+			SerialReader(const SerialReader&)            = delete;
+			SerialReader& operator=(const SerialReader&) = delete;
+			~SerialReader();
+
+			// False if the stream ends first.
+			bool read(void* bytes, std::size_t count);
+
+		private:
+			static const std::size_t ChunkSize = 1 << 16;
+			std::istream& is_;
+			std::vector<char> buffer_;
+			std::size_t pos_;
+			std::size_t end_;
+	};
+
+	/// @brief What kind of type a key or value is. The header records it, so a
+	///        map only loads into a map whose types are read the same way.
+	///        Specializations of Serializer for other types use SerialUser and up.
+	enum SerialTag : std::uint32_t
+	{
+		SerialBytes = 1, // trivially copyable, not a number
+		SerialUnsigned,
+		SerialSigned,
+		SerialFloat,
+		SerialString,
+		SerialUser = 0x100
+	};
+
+	/// @brief How a key or value type is written. Trivially copyable types are
+	///        copied as bytes, other types need a specialization with the same
+	///        two functions and a tag.
+	/// @tparam T - The key or value type.
+	template< typename T >
+	struct Serializer
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "specialize CS280::Serializer for this type");
+		static constexpr std::uint32_t tag = std::is_floating_point<T>::value ? SerialFloat
+		                                     : !std::is_integral<T>::value    ? SerialBytes
+		                                     : std::is_signed<T>::value       ? SerialSigned
+		                                                                      : SerialUnsigned;
+		static void write(SerialWriter& out, const T& value) { out.write(&value, sizeof(T)); }
+		static bool read(SerialReader& in, T& value) { return in.read(&value, sizeof(T)); }
+	};
+
+	/// @brief Strings are written as their length and then their characters.
+	template<>
+	struct Serializer<std::string>
+	{
+		static constexpr std::uint32_t tag = SerialString;
+		static void write(SerialWriter& out, const std::string& value);
+		static bool read(SerialReader& in, std::string& value);
+	};
+
+	/// @brief What comes before the pairs: a magic word, the format version, a
+	///        byte order mark, the key and value sizes and tags, and the number
+	///        of pairs.
+	struct SerialHeader
+	{
+		std::uint32_t keySize = 0;
+		std::uint32_t valueSize = 0;
+		std::uint32_t keyTag = 0;
+		std::uint32_t valueTag = 0;
+		std::uint64_t count = 0;
+
+		template< typename KEY_TYPE, typename VALUE_TYPE >
+		static SerialHeader For(std::uint64_t count);
+		// Same types as other (the counts may differ).
+		bool Matches(const SerialHeader& other) const;
+		void write(SerialWriter& out) const;
+		// False if the magic word, version or byte order is wrong.
+		bool read(SerialReader& in);
+	};
+
+	/// @brief Input iterator over the pairs of a serialized map, for
+	///        BSTmap::BuildSorted. Decodes one pair per increment and checks the
+	///        keys keep increasing.
+	/// @tparam KEY_TYPE   - The data type of the key.
+	/// @tparam VALUE_TYPE - The data type of the value.
+	template< typename KEY_TYPE, typename VALUE_TYPE >
+	class SerialPairs
+	{
+		public:
+			SerialPairs(SerialReader& in, std::uint64_t count);
+			const std::pair<KEY_TYPE, VALUE_TYPE>* operator->() const;
+			SerialPairs& operator++();
+			// False if the data ran out or was out of order.
+			bool ok() const;
+
+		private:
+			bool Next(bool first);
+
+			SerialReader& in_;
+			std::uint64_t remaining_;
+			bool ok_;
+			std::pair<KEY_TYPE, VALUE_TYPE> current_;
+			KEY_TYPE next_;
+	};
+
+	/// @brief Whether more pairs can be read from an input. BuildSorted stops
+	///        when this goes false, so a corrupt count in a header cannot make
+	///        it build nodes for pairs that are not there.
+	template< typename IT >
+	bool Readable(const IT&) { return true; }
+	template< typename KEY_TYPE, typename VALUE_TYPE >
+	bool Readable(const SerialPairs<KEY_TYPE, VALUE_TYPE>& pairs) { return pairs.ok(); }
+}
+
+#include "map-serial.cpp"
+#endif
@@ -0,0 +1,693 @@
+/// --------------------------------------------------------------------------
+/// @file persistent-map.cpp
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+/// @brief Implementation of the persistent AVL map
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+
+#include "persistent-map.h"
+#include <algorithm> // std::max
+#include <iterator>  // std::distance
+#include <utility>   // std::swap
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Node constructor, the node starts with one reference.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param k           - The key.
+/// @param val         - The value.
+/// @param l           - The left child (the caller hands over a reference).
+/// @param r           - The right child (the caller hands over a reference).
+/// @param h           - The height.
+/// @param c           - The number of nodes in the subtree.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node::Node(KEY_TYPE const &k, VALUE_TYPE const &val, Node *l, Node *r, int h, unsigned c)
+	: key(k)
+	, value(val)
+	, left(l)
+	, right(r)
+	, height(h)
+	, count(c)
+	, refs(1)
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Key getter
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The key (KEY_TYPE const&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+KEY_TYPE const &CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node::Key() const
+{
+	return key;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Value getter
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The value (VALUE_TYPE const&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+VALUE_TYPE const &CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node::Value() const
+{
+	return value;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief End iterator
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::PersistentMap_iterator()
+	: stack_()
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Pushes a node and its chain of left children, the smallest ends on top.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node, may be null.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::PushLeft(const Node *node)
+{
+	for (; node; node = node->left)
+	{
+		stack_.push_back(node);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Moves to the next key.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return Reference to this iterator (PersistentMap_iterator&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator &CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::operator++()
+{
+	const Node *node = stack_.back();
+	stack_.pop_back();
+	PushLeft(node->right);
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Post increment
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The iterator before the increment (PersistentMap_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::operator++(int)
+{
+	PersistentMap_iterator copy(*this);
+	++(*this);
+	return copy;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Dereference
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The node (Node const&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node const &CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::operator*() const
+{
+	return *stack_.back();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Member access
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The node (Node const*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node const *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::operator->() const
+{
+	return stack_.back();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Inequality
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The other iterator.
+/// @return True if the iterators are at different nodes (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::operator!=(const PersistentMap_iterator &rhs) const
+{
+	return !(*this == rhs);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Equality, the end iterator has an empty stack.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The other iterator.
+/// @return True if the iterators are at the same node (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap_iterator::operator==(const PersistentMap_iterator &rhs) const
+{
+	if (stack_.empty() || rhs.stack_.empty())
+	{
+		return stack_.empty() && rhs.stack_.empty();
+	}
+	return stack_.back() == rhs.stack_.back();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Empty map
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap()
+{}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Builds a balanced tree from a sorted range of (key, value) pairs.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam IT         - Iterator over std::pair<KEY_TYPE, VALUE_TYPE>.
+/// @param first       - Start of the range.
+/// @param last        - End of the range.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+template <typename IT>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap(IT first, IT last)
+{
+	pRoot = BuildSorted(first, static_cast<std::size_t>(std::distance(first, last)));
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copy constructor, shares every node, O(1).
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The map to copy.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap(const PersistentMap &rhs)
+	: pRoot(rhs.pRoot)
+{
+	Retain(pRoot);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Copy assignment, shares every node, O(1) plus freeing the old version.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The map to copy.
+/// @return Reference to this map (PersistentMap&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE> &CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::operator=(const PersistentMap &rhs)
+{
+	// Retain first, rhs may be this map.
+	Retain(rhs.pRoot);
+	Release(pRoot);
+	pRoot = rhs.pRoot;
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Move constructor
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The map to move from, left empty.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::PersistentMap(PersistentMap &&rhs)
+	: pRoot(rhs.pRoot)
+{
+	rhs.pRoot = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Move assignment
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param rhs         - The map to move from.
+/// @return Reference to this map (PersistentMap&).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE> &CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::operator=(PersistentMap &&rhs)
+{
+	std::swap(pRoot, rhs.pRoot);
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Destructor, frees the nodes no other version uses.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::~PersistentMap()
+{
+	Release(pRoot);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief This version of the map
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return A map sharing every node with this one (PersistentMap).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+CS280::PersistentMap<KEY_TYPE, VALUE_TYPE> CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::snapshot() const
+{
+	return *this;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Number of keys
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The number of keys (unsigned).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+unsigned CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::size() const
+{
+	return pRoot ? pRoot->count : 0;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Adds a key or replaces its value
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key.
+/// @param value       - The value.
+/// @return True if the key was not in the map (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::insert(KEY_TYPE const &key, VALUE_TYPE const &value)
+{
+	bool added = false;
+	pRoot = Insert(pRoot, key, value, added);
+	return added;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes a key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key.
+/// @return True if the key was in the map (bool).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+bool CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::erase(KEY_TYPE const &key)
+{
+	// Look first so a missing key copies nothing.
+	const Node *node = pRoot;
+	while (node && (key < node->key || node->key < key))
+	{
+		node = (key < node->key) ? node->left : node->right;
+	}
+	if (!node)
+	{
+		return false;
+	}
+
+	pRoot = Erase(pRoot, key);
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator to the smallest key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The iterator (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::begin() const
+{
+	const_iterator it;
+	it.PushLeft(pRoot);
+	return it;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Iterator past the largest key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @return The iterator (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::end() const
+{
+	return const_iterator();
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Finds a key
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key to find.
+/// @return Iterator to the key, end() if it is not there (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::find(KEY_TYPE const &key) const
+{
+	const_iterator it = lower_bound(key);
+	if (it != end() && key < it->key)
+	{
+		return end();
+	}
+	return it;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief First key not less than key. The stack keeps every node the search went
+///        left at, those are the keys still to come.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param key         - The key to search for.
+/// @return Iterator to the first key not less than key, or end() (const_iterator).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::const_iterator CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::lower_bound(KEY_TYPE const &key) const
+{
+	const_iterator it;
+	for (const Node *node = pRoot; node;)
+	{
+		if (node->key < key)
+		{
+			node = node->right;
+		}
+		else
+		{
+			it.stack_.push_back(node);
+			node = node->left;
+		}
+	}
+	return it;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Adds a reference to a node
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node, may be null.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Retain(Node *node)
+{
+	if (node)
+	{
+		node->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Drops a reference to a node. A node that loses its last reference is
+///        freed and drops its children's, with a work list instead of recursion.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node, may be null.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Release(Node *node)
+{
+	if (!node || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	std::vector<Node *> dead(1, node);
+	while (!dead.empty())
+	{
+		Node *next = dead.back();
+		dead.pop_back();
+		for (Node *child : {next->left, next->right})
+		{
+			if (child && child->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				dead.push_back(child);
+			}
+		}
+		delete next;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Takes over the caller's reference to a node and returns a node only the
+///        caller uses. A node with one reference reached from a node only the
+///        caller uses is already private: it is returned as is. Otherwise it is
+///        copied (sharing its children).
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The node, not null.
+/// @return A node with the same contents that can be changed (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Unshare(Node *tree)
+{
+	if (tree->refs.load(std::memory_order_acquire) == 1)
+	{
+		return tree;
+	}
+
+	Node *copy = new Node(tree->key, tree->value, tree->left, tree->right, tree->height, tree->count);
+	Retain(copy->left);
+	Retain(copy->right);
+	Release(tree);
+	return copy;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Height of a subtree, -1 when it is empty.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The subtree, may be null.
+/// @return The height (int).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+int CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Height(const Node *node)
+{
+	return node ? node->height : -1;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Sets the height and subtree size of a node from its children.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node.
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+void CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::UpdateNode(Node *node)
+{
+	node->height = std::max(Height(node->left), Height(node->right)) + 1;
+	node->count = 1 + (node->left ? node->left->count : 0) + (node->right ? node->right->count : 0);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Left rotation of a private node, its right child is made private first.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node to rotate.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::RotateLeft(Node *node)
+{
+	Node *pivot = Unshare(node->right);
+	node->right = pivot->left;
+	UpdateNode(node);
+	pivot->left = node;
+	UpdateNode(pivot);
+	return pivot;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Right rotation of a private node, its left child is made private first.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node to rotate.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::RotateRight(Node *node)
+{
+	Node *pivot = Unshare(node->left);
+	node->left = pivot->right;
+	UpdateNode(node);
+	pivot->right = node;
+	UpdateNode(pivot);
+	return pivot;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Updates a private node and rotates it back into balance if it needs to.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param node        - The node.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Rebalance(Node *node)
+{
+	UpdateNode(node);
+	int balance = Height(node->left) - Height(node->right);
+
+	if (balance > 1)
+	{
+		if (Height(node->left->left) < Height(node->left->right))
+		{
+			node->left = RotateLeft(Unshare(node->left));
+		}
+		return RotateRight(node);
+	}
+	if (balance < -1)
+	{
+		if (Height(node->right->right) < Height(node->right->left))
+		{
+			node->right = RotateRight(Unshare(node->right));
+		}
+		return RotateLeft(node);
+	}
+	return node;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Inserts into a subtree, making the nodes on the path private.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The subtree (the caller's reference is taken over), may be null.
+/// @param key         - The key.
+/// @param value       - The value.
+/// @param added       - Set to true if the key is new.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Insert(Node *tree, KEY_TYPE const &key, VALUE_TYPE const &value, bool &added)
+{
+	if (!tree)
+	{
+		added = true;
+		return new Node(key, value);
+	}
+
+	Node *node = Unshare(tree);
+	if (key < node->key)
+	{
+		node->left = Insert(node->left, key, value, added);
+	}
+	else if (node->key < key)
+	{
+		node->right = Insert(node->right, key, value, added);
+	}
+	else
+	{
+		node->value = value;
+		return node;
+	}
+	return Rebalance(node);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Removes a key that is in the subtree, making the nodes on the path private.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The subtree (the caller's reference is taken over).
+/// @param key         - The key.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Erase(Node *tree, KEY_TYPE const &key)
+{
+	Node *node = Unshare(tree);
+	if (key < node->key)
+	{
+		node->left = Erase(node->left, key);
+		return Rebalance(node);
+	}
+	if (node->key < key)
+	{
+		node->right = Erase(node->right, key);
+		return Rebalance(node);
+	}
+
+	// The successor takes the node's place, or the only child does. The only
+	// child is a balanced subtree other versions may share, it is returned
+	// untouched. The successor is private and is rebalanced.
+	Node *replacement = nullptr;
+	bool successor = node->left && node->right;
+	if (successor)
+	{
+		Node *right = RemoveFirst(node->right, replacement);
+		replacement->left = node->left;
+		replacement->right = right;
+	}
+	else
+	{
+		replacement = node->left ? node->left : node->right;
+	}
+
+	// The children's references moved to the replacement.
+	node->left = node->right = nullptr;
+	Release(node);
+	return successor ? Rebalance(replacement) : replacement;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Takes the node with the smallest key out of a subtree.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @param tree        - The subtree (the caller's reference is taken over), not null.
+/// @param first       - Set to the removed node, private and without children.
+/// @return The new root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::RemoveFirst(Node *tree, Node *&first)
+{
+	Node *node = Unshare(tree);
+	if (!node->left)
+	{
+		Node *right = node->right;
+		node->right = nullptr;
+		first = node;
+		return right;
+	}
+	node->left = RemoveFirst(node->left, first);
+	return Rebalance(node);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------
+/// @brief Builds a perfectly balanced subtree from the next count pairs of a sorted range.
+/// @tparam KEY_TYPE   - The data type of the key.
+/// @tparam VALUE_TYPE - The data type of the value.
+/// @tparam IT         - Iterator over std::pair<KEY_TYPE, VALUE_TYPE>.
+/// @param it          - The next pair, advanced past the subtree.
+/// @param count       - Number of pairs in the subtree.
+/// @return The root of the subtree (Node*).
+//-------------------------------------------------------------------------------------------------------------------------
+template <typename KEY_TYPE, typename VALUE_TYPE>
+template <typename IT>
+typename CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::Node *CS280::PersistentMap<KEY_TYPE, VALUE_TYPE>::BuildSorted(IT &it, std::size_t count)
+{
+	if (count == 0)
+	{
+		return nullptr;
+	}
+
+	std::size_t leftCount = count / 2;
+	Node *left = BuildSorted(it, leftCount);
+	Node *node = new Node((*it).first, (*it).second, left);
+	++it;
+	node->right = BuildSorted(it, count - leftCount - 1);
+	UpdateNode(node);
+	return node;
+}
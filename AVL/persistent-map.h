@@ -0,0 +1,119 @@
+/// --------------------------------------------------------------------------
+/// @file persistent-map.h
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+/// @brief Persistent AVL map with O(1) snapshots
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+#ifndef PERSISTENTMAP_H
+#define PERSISTENTMAP_H
+
+#include <atomic>  // std::atomic
+#include <cstddef> // std::size_t
+#include <vector>  // std::vector
+
+namespace CS280
+{
+	/// @brief AVL map whose nodes are shared between versions. Copying the map
+	///        (snapshot()) is O(1), a write copies only the nodes on its path
+	///        that another version still uses and changes the rest in place.
+	///        Nodes are reference counted and freed with the last version that
+	///        uses them. The nodes have no parent pointers, a node can have many
+	///        parents. A snapshot can be read on any thread while the map it was
+	///        taken from keeps changing, but each map object itself is only used
+	///        by one thread at a time.
+	/// @tparam KEY_TYPE   - The data type of the key.
+	/// @tparam VALUE_TYPE - The data type of the value.
+	template< typename KEY_TYPE, typename VALUE_TYPE >
+	class PersistentMap
+	{
+		public:
+			class Node
+			{
+				public:
+					Node(KEY_TYPE const& k, VALUE_TYPE const& val, Node* l = nullptr, Node* r = nullptr, int h = 0, unsigned c = 1);
+					Node(const Node&)            = delete;
+					Node& operator=(const Node&) = delete;
+					KEY_TYPE const& Key() const;
+					VALUE_TYPE const& Value() const;
+
+				private:
+					KEY_TYPE key;
+					VALUE_TYPE value;
+					Node* left;
+					Node* right;
+					int height;
+					unsigned count;                  // nodes in this subtree
+					mutable std::atomic<unsigned> refs; // parents and maps pointing here
+					friend class PersistentMap;
+			};
+
+			/// @brief In order iterator, keeps the nodes still to visit on a stack.
+			class PersistentMap_iterator
+			{
+				public:
+					PersistentMap_iterator();
+					PersistentMap_iterator& operator++();
+					PersistentMap_iterator operator++(int);
+					Node const& operator*() const;
+					Node const* operator->() const;
+					bool operator!=(const PersistentMap_iterator& rhs) const;
+					bool operator==(const PersistentMap_iterator& rhs) const;
+
+				private:
+					void PushLeft(const Node* node);
+					std::vector<const Node*> stack_;
+					friend class PersistentMap;
+			};
+
+			typedef PersistentMap_iterator const_iterator;
+
+			PersistentMap();
+			// From (key, value) pairs with strictly increasing keys, O(n).
+			template< typename IT >
+			PersistentMap(IT first, IT last);
+			PersistentMap(const PersistentMap& rhs);
+			PersistentMap& operator=(const PersistentMap& rhs);
+			PersistentMap(PersistentMap&& rhs);
+			PersistentMap& operator=(PersistentMap&& rhs);
+			~PersistentMap();
+
+			// This version of the map, O(1). Later writes to either map are not
+			// seen by the other.
+			PersistentMap snapshot() const;
+
+			unsigned size() const;
+			// Adds key or replaces its value, true if the key is new. O(log n).
+			bool insert(KEY_TYPE const& key, VALUE_TYPE const& value);
+			// Removes key, true if it was there. O(log n).
+			bool erase(KEY_TYPE const& key);
+
+			const_iterator begin() const;
+			const_iterator end() const;
+			const_iterator find(KEY_TYPE const& key) const;
+			const_iterator lower_bound(KEY_TYPE const& key) const;
+
+		private:
+			Node* pRoot = nullptr;
+
+			static void Retain(Node* node);
+			static void Release(Node* node);
+			static Node* Unshare(Node* tree);
+			static int Height(const Node* node);
+			static void UpdateNode(Node* node);
+			static Node* RotateLeft(Node* node);
+			static Node* RotateRight(Node* node);
+			static Node* Rebalance(Node* node);
+			static Node* Insert(Node* tree, KEY_TYPE const& key, VALUE_TYPE const& value, bool& added);
+			static Node* Erase(Node* tree, KEY_TYPE const& key);
+			static Node* RemoveFirst(Node* tree, Node*& first);
+			template< typename IT >
+			static Node* BuildSorted(IT& it, std::size_t count);
+	};
+}
+
+#include "persistent-map.cpp"
+#endif
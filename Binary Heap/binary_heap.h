@@ -6,6 +6,7 @@
 #include <iostream> // debugging only
 #include <algorithm>
 #include <utility>
+#include <iterator>
 
 // key   - binary heap
 // value - actual data 
@@ -25,6 +26,8 @@ class BinaryHeap
         // indexing starts at 0 - i.e. minimum element is at index 0
         // modify left/right/parent implementations to support that
         std::vector< std::tuple<T_key,T_value> > data = {};
+        // 0 - unbounded, otherwise only the bound largest keys are kept
+        size_t bound = 0;
     public:
         BinaryHeap() = default;
         BinaryHeap( std::vector< std::tuple<T_key,T_value> > && data2 ) : data( std::move( data2 ) ) 
@@ -48,8 +51,14 @@ class BinaryHeap
 
         /// @brief Add a new key/value pair to the heap
         /// @param t - The key/value pair to add
-        void push(std::tuple<T_key,T_value> t)
+        void push(std::tuple<T_key,T_value> const& t)
         {
+            if (bound && data.size() >= bound)
+            {
+                replace_top(std::tuple<T_key,T_value>(t));
+                return;
+            }
+
            // Insert key at the end
             data.push_back(t);
             int index = data.size() - 1;
@@ -62,14 +71,107 @@ class BinaryHeap
         /// @param t - The key/value pair to add
         void push(std::tuple<T_key,T_value> && t)
         {
+            if (bound && data.size() >= bound)
+            {
+                replace_top(std::move(t));
+                return;
+            }
+
             // Insert key at the end
-            data.push_back(t);
+            data.push_back(std::move(t));
             int index = data.size() - 1;
 
             // Fix violated heap
             heapifyUp(index);
         }
 
+        /// @brief Add a range of key/value pairs. A few are sifted up one by one,
+        ///        for more only the nodes above the new ones are rebuilt bottom up
+        ///        (O(m + log^2 n) for m new elements instead of O(m log n))
+        /// @param first - Start of the range
+        /// @param last  - End of the range
+        template < typename IT >
+        void push_range(IT first, IT last)
+        {
+            if (bound)
+            {
+                for (; first != last; ++first)
+                {
+                    push(*first);
+                }
+                return;
+            }
+
+            size_t old_size = data.size();
+            data.insert(data.end(), first, last);
+            size_t added = data.size() - old_size;
+            if (added == 0 || data.size() == 1)
+            {
+                return;
+            }
+
+            // Depth of the tree
+            size_t depth = 0;
+            for (size_t n = data.size(); n > 1; n /= 2)
+            {
+                ++depth;
+            }
+
+            if (added <= depth)
+            {
+                for (size_t i = old_size; i < data.size(); ++i)
+                {
+                    heapifyUp(i);
+                }
+                return;
+            }
+
+            // Level by level, every node with a new element below it. Subtrees
+            // of old elements only are still heaps, so this is init_heap
+            // restricted to those nodes.
+            size_t lo = parent(old_size > 0 ? old_size : 1);
+            size_t hi = parent(data.size() - 1);
+            for (;;)
+            {
+                for (size_t i = hi + 1; i-- > lo; )
+                {
+                    heapifydown(i);
+                }
+                if (lo == 0)
+                {
+                    break;
+                }
+                lo = parent(lo);
+                hi = parent(hi);
+            }
+        }
+
+        /// @brief Move every element of another heap into this one, the other
+        ///        heap is left empty. The smaller heap is added to the larger.
+        /// @param other - The heap to take the elements of
+        void merge(BinaryHeap && other)
+        {
+            if (!bound && other.data.size() > data.size())
+            {
+                std::swap(data, other.data);
+            }
+            push_range(std::make_move_iterator(other.data.begin()), std::make_move_iterator(other.data.end()));
+            other.data.clear();
+        }
+
+        /// @brief Keep only the k largest keys from now on: once k elements are
+        ///        in, a push replaces the top (the smallest of them) if its key is
+        ///        larger and is dropped otherwise. top() is then the k-th largest key.
+        /// @param k - The number of elements to keep, 0 for no limit
+        void keep_top_k(size_t k)
+        {
+            bound = k;
+            while (bound && data.size() > bound)
+            {
+                pop();
+            }
+        }
+
         /// @brief Remove the first element in the list
         void pop() 
         {
@@ -105,6 +207,18 @@ class BinaryHeap
 
     private:
 
+        /// @brief In bounded mode put a new element in place of the top if its key
+        ///        is larger, keeping the number of elements at the bound
+        /// @param t - The key/value pair to add
+        void replace_top(std::tuple<T_key,T_value> && t)
+        {
+            if (std::get<0>(data[0]) < std::get<0>(t))
+            {
+                data[0] = std::move(t);
+                heapifydown(0);
+            }
+        }
+
         /// @brief Get the index of the left child of the specified node
         /// @param i - the index of the node
         /// @return The index of the left child
@@ -0,0 +1,132 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <vector>
+#include <tuple>
+#include <iostream> // debugging only
+#include <utility>
+#include <cstddef>
+
+// key   - bucket queue (Dial's algorithm)
+// value - actual data
+// A priority queue for non-negative integer keys that never go below the last
+// key popped and never run more than span past it, e.g. event ticks with a
+// bounded delay or Dijkstra with small integer edge weights. There is one
+// bucket per key in a window of span+1 keys that slides forward as keys are
+// popped: push is O(1) and pop is O(1) plus the empty buckets skipped.
+
+// forward declaration for 1-1 operator<<
+template < typename T_key, typename T_value >
+class BucketQueue;
+
+template < typename T_key, typename T_value >
+std::ostream& operator<< (std::ostream& os, BucketQueue<T_key, T_value> const & bh);
+
+
+template < typename T_key, typename T_value >
+class BucketQueue
+{
+    private:
+        // buckets[key % buckets.size()] holds the elements with that key.
+        // Only pop() moves current, a key pushed after a top() may still be
+        // below the key top() returned.
+        std::vector< std::vector< std::tuple<T_key,T_value> > > buckets;
+        T_key current = T_key(); // the last key popped, no key in the queue is smaller
+        mutable T_key ahead = T_key(); // how far top() looked, no key in the queue is smaller
+        int count = 0;
+
+    public:
+        /// @brief Make a queue for keys at most span past the last key popped
+        /// @param span - The largest difference between a key pushed and the last key popped
+        explicit BucketQueue( T_key span = 1024 ) : buckets( static_cast<size_t>( span ) + 1 ) {}
+        BucketQueue( BucketQueue const& ) = default; // vector copy is OK
+        BucketQueue( BucketQueue && ) = default; // vector move is OK
+        BucketQueue& operator=( BucketQueue const& ) = default; // vector assignment is OK
+        BucketQueue& operator=( BucketQueue && ) = default; // vector move assignment is OK
+
+        friend
+        std::ostream& operator<< (std::ostream& os, BucketQueue<T_key, T_value> const & bh)
+        {
+            for ( auto const& bucket : bh.buckets )
+            {
+                for ( std::tuple< T_key,T_value> const& el : bucket )
+                {
+                    os << std::get<0>( el ) << " "; // does not print values
+                }
+            }
+            return os;
+        }
+
+        /// @brief Add a new key/value pair to the queue. The key must be in
+        ///        [last key popped, last key popped + span].
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> const& t)
+        {
+            std::tuple<T_key,T_value> copy(t);
+            push(std::move(copy));
+        }
+
+        /// @brief Move a new key/value pair to the queue. The key must be in
+        ///        [last key popped, last key popped + span].
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> && t)
+        {
+            T_key key = std::get<0>(t);
+            if (key < ahead)
+            {
+                ahead = key;
+            }
+            slot(key).push_back(std::move(t));
+            ++count;
+        }
+
+        /// @brief Remove the first element in the list
+        void pop()
+        {
+            advance();
+            current = ahead;
+            slot(current).pop_back();
+            --count;
+        }
+
+        /// @brief  The amount of elements in the queue
+        /// @return The amount of elements in the queue
+        int size() const { return count; }
+
+        /// @brief Get the key/value pair at the top of the queue
+        /// @return The key/value pair with the smallest key
+        std::tuple<T_key,T_value> const& top() const
+        {
+            advance();
+            return slot(ahead).back();
+        }
+
+    private:
+
+        /// @brief The bucket of a key
+        /// @param key - The key
+        /// @return The bucket
+        std::vector< std::tuple<T_key,T_value> > & slot(T_key key)
+        {
+            return buckets[static_cast<size_t>(key) % buckets.size()];
+        }
+
+        /// @brief The bucket of a key
+        /// @param key - The key
+        /// @return The bucket
+        std::vector< std::tuple<T_key,T_value> > const& slot(T_key key) const
+        {
+            return buckets[static_cast<size_t>(key) % buckets.size()];
+        }
+
+        /// @brief Move ahead forward to the smallest key in the queue
+        void advance() const
+        {
+            while (slot(ahead).empty())
+            {
+                ++ahead;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,288 @@
+#ifndef COLLISION_SIMULATION_H
+#define COLLISION_SIMULATION_H
+
+#include <vector>
+#include <tuple>
+#include <algorithm>   // sort
+#include <numeric>     // iota
+#include <functional>  // std::function
+#include <limits>
+#include <cstddef>
+#include "binary_heap.h"
+
+// Event driven simulation of particles on a line. Only neighbours can
+// collide, so each collision only needs the events of the two pairs next to
+// it. Per event:
+//  - positions are lazy: each particle keeps the time its position was last
+//    written, and only the two particles that collide are brought up to date
+//  - every particle has a version that goes up when its speed changes, and
+//    an event remembers the versions it was computed with, so an event made
+//    stale by an earlier collision is recognised and dropped in O(1) when it
+//    reaches the top of the queue
+// so an event costs O(log n) for the queue instead of O(n) for moving every
+// particle. Particle data is kept as separate arrays (structure of arrays).
+
+// a possible collision of particles i and i+1
+struct CollisionEvent
+{
+    size_t i;
+    unsigned version_i;
+    unsigned version_j;
+};
+
+template < typename FLOAT = double, typename QUEUE = BinaryHeap< FLOAT, CollisionEvent > >
+class CollisionSimulation
+{
+    public:
+        // called for every collision with the time and the two particles
+        typedef std::function< void( FLOAT, size_t, size_t ) > Listener;
+
+        /// @brief Make an empty simulation
+        /// @param elastic_collisions - true: collisions conserve momentum and energy
+        ///                             (masses matter), false: both particles just turn around
+        explicit CollisionSimulation( bool elastic_collisions = false )
+            : elastic( elastic_collisions ), pos(), last_update(), speed(), mass(), version(), events(),
+              clock( 0 ), listener(), processed( 0 ), discarded( 0 )
+        {}
+
+        /// @brief Make room for a number of particles
+        /// @param n - The number of particles
+        void reserve( size_t n )
+        {
+            pos.reserve( n ); last_update.reserve( n ); speed.reserve( n ); mass.reserve( n ); version.reserve( n );
+        }
+
+        /// @brief Add a particle, before start()
+        /// @param position - The position at time 0
+        /// @param m        - The mass
+        /// @param v        - The speed (signed, negative means left)
+        void add_particle( FLOAT position, FLOAT m, FLOAT v )
+        {
+            pos.push_back( position );
+            last_update.push_back( 0 );
+            speed.push_back( v );
+            mass.push_back( m );
+            version.push_back( 0 );
+        }
+
+        /// @brief Set the function called for every collision
+        /// @param l - The listener, an empty function for none
+        void set_listener( Listener l ) { listener = std::move( l ); }
+
+        /// @brief Order the particles by position (particle i is then the i-th
+        ///        from the left) and schedule the first collisions
+        void start()
+        {
+            std::vector< size_t > order( pos.size() );
+            std::iota( order.begin(), order.end(), size_t( 0 ) );
+            std::vector< FLOAT > const& p = pos;
+            std::sort( order.begin(), order.end(), [&p]( size_t a, size_t b ) { return p[a] < p[b]; } );
+            permute( pos, order );
+            permute( speed, order );
+            permute( mass, order );
+
+            for ( size_t i = 0; i + 1 < pos.size(); ++i )
+            {
+                schedule( i );
+            }
+        }
+
+        /// @brief Process the next collision, dropping stale events on the way
+        /// @return False if no collision is left
+        bool step()
+        {
+            return next_collision( std::numeric_limits<FLOAT>::max() );
+        }
+
+        /// @brief Process every collision up to a time and move the clock there
+        /// @param time - The time to stop at
+        /// @return The number of collisions processed
+        size_t run_until( FLOAT time )
+        {
+            size_t count = 0;
+            while ( next_collision( time ) )
+            {
+                ++count;
+            }
+            if ( clock < time )
+            {
+                clock = time;
+            }
+            return count;
+        }
+
+        /// @brief Process up to a number of collisions
+        /// @param max_events - The largest number of collisions to process
+        /// @return The number of collisions processed
+        size_t run( size_t max_events )
+        {
+            size_t count = 0;
+            while ( count < max_events && step() )
+            {
+                ++count;
+            }
+            return count;
+        }
+
+        /// @brief The time of the last collision (or run_until)
+        /// @return The current time
+        FLOAT now() const { return clock; }
+
+        /// @brief The number of particles
+        /// @return The number of particles
+        size_t size() const { return pos.size(); }
+
+        /// @brief Position of a particle now
+        /// @param i - The particle
+        /// @return The position
+        FLOAT position( size_t i ) const { return position_at( i, clock ); }
+
+        /// @brief Speed of a particle
+        /// @param i - The particle
+        /// @return The speed
+        FLOAT velocity( size_t i ) const { return speed[i]; }
+
+        /// @brief Mass of a particle
+        /// @param i - The particle
+        /// @return The mass
+        FLOAT weight( size_t i ) const { return mass[i]; }
+
+        /// @brief The number of collisions processed so far
+        /// @return The number of collisions
+        size_t collisions() const { return processed; }
+
+        /// @brief The number of stale events dropped so far
+        /// @return The number of stale events
+        size_t stale_events() const { return discarded; }
+
+        /// @brief The number of events waiting, stale ones included
+        /// @return The number of events
+        size_t pending_events() const { return events.size(); }
+
+    private:
+        bool elastic;
+
+        // structure of arrays, index = order by position
+        std::vector< FLOAT > pos;         // position at last_update
+        std::vector< FLOAT > last_update; // time pos was written
+        std::vector< FLOAT > speed;
+        std::vector< FLOAT > mass;
+        std::vector< unsigned > version;  // goes up with every change of speed
+
+        QUEUE events;
+        FLOAT clock;
+        Listener listener;
+        size_t processed;
+        size_t discarded;
+
+        /// @brief Reorder an array
+        /// @param a     - The array
+        /// @param order - order[k] is the index of the element that goes to k
+        static void permute( std::vector< FLOAT > & a, std::vector< size_t > const& order )
+        {
+            std::vector< FLOAT > b( a.size() );
+            for ( size_t k = 0; k < order.size(); ++k )
+            {
+                b[k] = a[ order[k] ];
+            }
+            a.swap( b );
+        }
+
+        /// @brief Position of a particle at a time, from its last written position
+        /// @param i - The particle
+        /// @param t - The time
+        /// @return The position
+        FLOAT position_at( size_t i, FLOAT t ) const
+        {
+            return pos[i] + ( t - last_update[i] ) * speed[i];
+        }
+
+        /// @brief Write the position of a particle at the current time
+        /// @param i - The particle
+        void sync( size_t i )
+        {
+            pos[i] = position_at( i, clock );
+            last_update[i] = clock;
+        }
+
+        /// @brief Add the collision of i and i+1 if they are getting closer
+        /// @param i - The left particle of the pair
+        void schedule( size_t i )
+        {
+            size_t j = i + 1;
+            FLOAT closing = speed[i] - speed[j];
+            if ( closing > 0 )
+            {
+                FLOAT gap = position_at( j, clock ) - position_at( i, clock );
+                FLOAT time = clock + std::max( gap, FLOAT( 0 ) ) / closing;
+                CollisionEvent e = { i, version[i], version[j] };
+                events.push( std::make_tuple( time, e ) );
+            }
+        }
+
+        /// @brief Process the next valid event at or before a time
+        /// @param limit - The latest time to process
+        /// @return False if there is none
+        bool next_collision( FLOAT limit )
+        {
+            while ( events.size() > 0 )
+            {
+                FLOAT time = std::get<0>( events.top() );
+                if ( limit < time )
+                {
+                    return false;
+                }
+                CollisionEvent e = std::get<1>( events.top() );
+                events.pop();
+
+                size_t i = e.i;
+                size_t j = i + 1;
+                if ( e.version_i != version[i] || e.version_j != version[j] )
+                {
+                    ++discarded; // one of them has turned since
+                    continue;
+                }
+
+                clock = time;
+                sync( i );
+                sync( j );
+                collide( i, j );
+                ++version[i];
+                ++version[j];
+                ++processed;
+
+                if ( i > 0 )
+                {
+                    schedule( i - 1 );
+                }
+                if ( j + 1 < pos.size() )
+                {
+                    schedule( j );
+                }
+                if ( listener )
+                {
+                    listener( time, i, j );
+                }
+                return true;
+            }
+            return false;
+        }
+
+        /// @brief New speeds of two particles that touch
+        /// @param i - The left particle
+        /// @param j - The right particle
+        void collide( size_t i, size_t j )
+        {
+            if ( !elastic )
+            {
+                speed[i] = -speed[i];
+                speed[j] = -speed[j];
+                return;
+            }
+            FLOAT m1 = mass[i], m2 = mass[j], v1 = speed[i], v2 = speed[j];
+            speed[i] = ( ( m1 - m2 ) * v1 + 2 * m2 * v2 ) / ( m1 + m2 );
+            speed[j] = ( ( m2 - m1 ) * v2 + 2 * m1 * v1 ) / ( m1 + m2 );
+        }
+};
+
+#endif
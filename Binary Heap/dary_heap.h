@@ -0,0 +1,275 @@
+#ifndef DARY_HEAP_H
+#define DARY_HEAP_H
+
+#include <vector>
+#include <tuple>
+#include <iostream> // debugging only
+#include <utility>
+#include <cstddef>
+
+// key   - d-ary heap
+// value - actual data
+// Same idea as BinaryHeap with D children per node: the tree is log_D(n) deep,
+// so a pop touches fewer levels, and the D children of a node sit next to
+// each other in memory. Elements are moved, never copied or swapped: a sift
+// holds the moving element aside and shifts every element on its path once.
+// With SPLIT keys and values live in separate arrays, so choosing the
+// smallest child reads keys only and large values are moved once per level
+// instead of being dragged through the cache with every comparison.
+
+// the two layouts, both give key(i) and move the element at one index to another
+template < typename T_key, typename T_value, bool SPLIT >
+class DaryHeapStorage;
+
+// keys and values in separate arrays
+template < typename T_key, typename T_value >
+class DaryHeapStorage< T_key, T_value, true >
+{
+    public:
+        size_t size() const { return keys.size(); }
+        void reserve(size_t n) { keys.reserve(n); values.reserve(n); }
+        T_key const& key(size_t i) const { return keys[i]; }
+        T_value const& value(size_t i) const { return values[i]; }
+        T_key& key(size_t i) { return keys[i]; }
+        T_value& value(size_t i) { return values[i]; }
+        void move(size_t from, size_t to)
+        {
+            keys[to] = std::move(keys[from]);
+            values[to] = std::move(values[from]);
+        }
+        void push_back(T_key&& k, T_value&& v)
+        {
+            keys.push_back(std::move(k));
+            values.push_back(std::move(v));
+        }
+        void pop_back() { keys.pop_back(); values.pop_back(); }
+
+    private:
+        std::vector< T_key > keys = {};
+        std::vector< T_value > values = {};
+};
+
+// key/value pairs in one array
+template < typename T_key, typename T_value >
+class DaryHeapStorage< T_key, T_value, false >
+{
+    public:
+        size_t size() const { return data.size(); }
+        void reserve(size_t n) { data.reserve(n); }
+        T_key const& key(size_t i) const { return data[i].first; }
+        T_value const& value(size_t i) const { return data[i].second; }
+        T_key& key(size_t i) { return data[i].first; }
+        T_value& value(size_t i) { return data[i].second; }
+        void move(size_t from, size_t to) { data[to] = std::move(data[from]); }
+        void push_back(T_key&& k, T_value&& v) { data.push_back(std::make_pair(std::move(k), std::move(v))); }
+        void pop_back() { data.pop_back(); }
+
+    private:
+        std::vector< std::pair<T_key,T_value> > data = {};
+};
+
+// forward declaration for 1-1 operator<<
+template < typename T_key, typename T_value, unsigned D, bool SPLIT >
+class DaryHeap;
+
+template < typename T_key, typename T_value, unsigned D, bool SPLIT >
+std::ostream& operator<< (std::ostream& os, DaryHeap<T_key, T_value, D, SPLIT> const & bh);
+
+
+template < typename T_key, typename T_value, unsigned D = 4, bool SPLIT = true >
+class DaryHeap
+{
+    static_assert(D >= 2, "a heap node needs at least 2 children");
+
+    private:
+        // indexing starts at 0 - i.e. minimum element is at index 0
+        DaryHeapStorage< T_key, T_value, SPLIT > data = {};
+    public:
+        DaryHeap() = default;
+        DaryHeap( std::vector< std::tuple<T_key,T_value> > && data2 )
+        {
+            data.reserve(data2.size());
+            for ( std::tuple<T_key,T_value> & t : data2 )
+            {
+                data.push_back(std::move(std::get<0>(t)), std::move(std::get<1>(t)));
+            }
+            data2.clear();
+            init_heap();
+        }
+        DaryHeap( DaryHeap const& ) = default; // vector copy is OK
+        DaryHeap( DaryHeap && ) = default; // vector move is OK
+        DaryHeap& operator=( DaryHeap const& ) = default; // vector assignment is OK
+        DaryHeap& operator=( DaryHeap && ) = default; // vector move assignment is OK
+
+        friend
+        std::ostream& operator<< (std::ostream& os, DaryHeap<T_key, T_value, D, SPLIT> const & bh)
+        {
+            for ( size_t i = 0; i < bh.data.size(); ++i )
+            {
+                os << bh.data.key(i) << " "; // does not print values
+            }
+            return os;
+        }
+
+        /// @brief Add a new key/value pair to the heap
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> const& t)
+        {
+            push(std::get<0>(t), std::get<1>(t));
+        }
+
+        /// @brief Move a new key/value pair to the heap
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> && t)
+        {
+            push(std::move(std::get<0>(t)), std::move(std::get<1>(t)));
+        }
+
+        /// @brief Add a new key and value to the heap
+        /// @param key   - The key
+        /// @param value - The value
+        void push(T_key key, T_value value)
+        {
+            // Insert at the end
+            size_t index = data.size();
+            data.push_back(std::move(key), std::move(value));
+
+            // Fix violated heap: the element is taken out and the hole climbs to where it goes
+            if (index != 0 && data.key(index) < data.key(parent(index)))
+            {
+                T_key k = std::move(data.key(index));
+                T_value v = std::move(data.value(index));
+                place(siftUp(index, k), std::move(k), std::move(v));
+            }
+        }
+
+        /// @brief Remove the first element in the list
+        void pop()
+        {
+            size_t last = data.size() - 1;
+            if (last != 0)
+            {
+                fill_hole(last);
+            }
+            data.pop_back();
+        }
+
+        /// @brief Remove the first element and move it out
+        /// @return The key/value pair that was at the top
+        std::tuple<T_key,T_value> take()
+        {
+            std::tuple<T_key,T_value> t(std::move(data.key(0)), std::move(data.value(0)));
+            pop();
+            return t;
+        }
+
+        /// @brief  The amount of elements in the heap
+        /// @return The amount of elements in the heap
+        int size() const { return data.size(); }
+
+        /// @brief Get the key/value pair at the top of the heap
+        /// @return References to the key and value at the top of the tree
+        std::tuple<T_key const&,T_value const&> top() const
+        {
+            return std::tuple<T_key const&,T_value const&>(data.key(0), data.value(0));
+        }
+
+    private:
+
+        /// @brief Get the index of the first child of the specified node
+        /// @param i - the index of the node
+        /// @return The index of the first child
+        size_t child (size_t i) const { return D * i + 1;   }
+
+        /// @brief Get the index of the parent of the specified node
+        /// @param i - The index of the specified node
+        /// @return The index of the parent
+        size_t parent(size_t i) const { return (i - 1) / D; }
+
+        /// @brief Ensures that a newly created heap maintains the heap property
+        void init_heap()
+        {
+            if (data.size() < 2)
+            {
+                return;
+            }
+            // Every node with a child, bottom up
+            for (size_t i = parent(data.size() - 1) + 1; i-- > 0; )
+            {
+                T_key key = std::move(data.key(i));
+                T_value value = std::move(data.value(i));
+                place(siftDown(i, key, data.size()), std::move(key), std::move(value));
+            }
+        }
+
+        /// @brief Replace the top with the element at index last, which is then left
+        ///        moved-from at the end
+        /// @param last - The index of the last element
+        void fill_hole(size_t last)
+        {
+            T_key key = std::move(data.key(last));
+            T_value value = std::move(data.value(last));
+            place(siftDown(0, key, last), std::move(key), std::move(value));
+        }
+
+        /// @brief Move an element into the hole at index
+        /// @param index - The hole
+        /// @param key   - The key
+        /// @param value - The value
+        void place(size_t index, T_key&& key, T_value&& value)
+        {
+            data.key(index) = std::move(key);
+            data.value(index) = std::move(value);
+        }
+
+        /// @brief Move the hole at index down past every child smaller than key
+        /// @param index - The hole
+        /// @param key   - The key of the element that will fill the hole
+        /// @param count - Number of elements taking part
+        /// @return Where the element goes
+        size_t siftDown(size_t index, T_key const& key, size_t count)
+        {
+            for (;;)
+            {
+                size_t first = child(index);
+                if (first >= count)
+                {
+                    return index;
+                }
+
+                // The smallest of up to D children, which sit next to each other
+                size_t end = first + D < count ? first + D : count;
+                size_t smallest = first;
+                for (size_t c = first + 1; c < end; ++c)
+                {
+                    if (data.key(c) < data.key(smallest))
+                    {
+                        smallest = c;
+                    }
+                }
+
+                if (!(data.key(smallest) < key))
+                {
+                    return index;
+                }
+                data.move(smallest, index);
+                index = smallest;
+            }
+        }
+
+        /// @brief Move the hole at index up past every parent greater than key
+        /// @param index - The hole
+        /// @param key   - The key of the element that will fill the hole
+        /// @return Where the element goes
+        size_t siftUp(size_t index, T_key const& key)
+        {
+            while (index != 0 && key < data.key(parent(index)))
+            {
+                data.move(parent(index), index);
+                index = parent(index);
+            }
+            return index;
+        }
+};
+
+#endif
@@ -1,4 +1,12 @@
 #include "binary_heap.h"
+#include "indexed_binary_heap.h"
+#include "dary_heap.h"
+#include "radix_heap.h"
+#include "bucket_queue.h"
+#include "multi_queue.h"
+#include "collision_simulation.h"
+#include <thread>
+#include <mutex>
 #include <iostream>
 #include <limits>
 #include <vector>
@@ -529,8 +537,775 @@ void test11()
 }
 
 
+// indexed heap: handles survive any amount of reordering
+void test12()
+{
+    IndexedBinaryHeap< int, int > bh;
+    std::vector< IndexedBinaryHeap< int, int >::handle > h;
+    int keys[] = { 9, 5, 3, 7, 4, 2, 8 };
+    for ( int k : keys ) {
+        h.push_back( bh.push( std::make_tuple( k, k ) ) );
+    }
+    std::cout << bh << std::endl;
+    bh.decrease_key( h[0], 1 ); // 9 -> 1, becomes the top
+    std::cout << bh << std::endl;
+    bh.increase_key( h[5], 6 ); // 2 -> 6
+    std::cout << bh << std::endl;
+    bh.erase( h[3] );           // 7 leaves from the middle
+    std::cout << bh << std::endl;
+    std::cout << "top value " << std::get<1>( bh.top() ) << " contains 7: " << bh.contains( h[3] ) << std::endl;
+    while ( bh.size() > 0 ) {
+        std::cout << "top=" << std::get<0>( bh.top() ) << " value " << std::get<1>( bh.top() ) << std::endl;
+        bh.pop();
+    }
+
+    // random operations checked against a plain array of live elements
+    std::mt19937 g( 12 );
+    std::vector< std::tuple< IndexedBinaryHeap< int, int >::handle, int > > live;
+    int errors = 0;
+    for ( int i=0; i<20000; ++i ) {
+        unsigned op = g() % 6;
+        if ( live.empty() || op < 2 ) {
+            int key = static_cast<int>( g() % 100000 );
+            live.push_back( std::make_tuple( bh.push( std::make_tuple( key, i ) ), i ) );
+        } else {
+            size_t pick = g() % live.size();
+            IndexedBinaryHeap< int, int >::handle hp = std::get<0>( live[pick] );
+            if ( std::get<1>( bh.get( hp ) ) != std::get<1>( live[pick] ) ) ++errors;
+            int key = std::get<0>( bh.get( hp ) );
+            if ( op == 2 ) {
+                bh.decrease_key( hp, key - static_cast<int>( g() % 1000 ) );
+            } else if ( op == 3 ) {
+                bh.increase_key( hp, key + static_cast<int>( g() % 1000 ) );
+            } else if ( op == 4 ) {
+                bh.erase( hp );
+                live[pick] = live.back();
+                live.pop_back();
+            } else {
+                int min = std::get<0>( bh.top() );
+                for ( auto const& l : live ) {
+                    if ( std::get<0>( bh.get( std::get<0>( l ) ) ) < min ) ++errors;
+                }
+            }
+        }
+    }
+    int prev = std::numeric_limits<int>::min();
+    while ( bh.size() > 0 ) {
+        if ( std::get<0>( bh.top() ) < prev ) ++errors;
+        prev = std::get<0>( bh.top() );
+        bh.pop();
+    }
+    std::cout << "random operations, errors: " << errors << std::endl;
+}
+
+// test11 with an indexed heap: each pair of neighbours has at most one pending
+// event, and a collision cancels the events of the pairs whose speed it changed
+// instead of leaving them to be popped and discarded
+void test13()
+{
+    std::vector< std::tuple< FLOAT, FLOAT, FLOAT > > particles;
+    particles.push_back( std::make_tuple( -3, 1.0,  1.0 ) );
+    particles.push_back( std::make_tuple(  0, 2.0,  0.5  ) );
+    particles.push_back( std::make_tuple(  2, 3.0, -2.0  ) ); // will get to 1 before 0-1 collision
+
+    typedef IndexedBinaryHeap< FLOAT, std::tuple<size_t,size_t> > EventHeap;
+    EventHeap bh; // time and pair of indices of colliding particles
+    std::vector< EventHeap::handle > pending( particles.size(), 0 ); // event of pair (i,i+1)
+    std::vector< bool > has_pending( particles.size(), false );
+
+    // schedules the collision of i and i+1, replacing any older one
+    auto schedule = [&]( FLOAT curr_time, size_t i ) {
+        if ( has_pending[i] ) {
+            std::cout << "\tcancel event at " << std::get<0>( bh.get( pending[i] ) ) << " collision " << i << " and " << i+1 << std::endl;
+            bh.erase( pending[i] );
+            has_pending[i] = false;
+        }
+        FLOAT speed_towards_each_other = std::get<2>( particles[i] ) - std::get<2>( particles[i+1] );
+        if ( speed_towards_each_other > 0 ) {
+            FLOAT time_collision = ( std::get<0>( particles[i+1] ) - std::get<0>( particles[i] ) ) / speed_towards_each_other;
+            pending[i] = bh.push( std::make_tuple( curr_time + time_collision, std::make_tuple( i, i+1 ) ) );
+            has_pending[i] = true;
+            std::cout << "\tnew event at " << curr_time + time_collision << " collision " << i << " and " << i+1 << std::endl;
+        }
+    };
+
+    std::sort( std::begin(particles), std::end(particles),
+                []( std::tuple< FLOAT, FLOAT, FLOAT > const &t1, std::tuple< FLOAT, FLOAT, FLOAT > const &t2) {
+                return std::get<0>(t1) < std::get<0>(t2);
+            } );
+    print_particles( particles );
+    for ( size_t i=0; i<particles.size()-1; ++i ) {
+        schedule( 0.0, i );
+    }
+
+    FLOAT time_last_update = 0.0;
+    while ( bh.size() > 0 )
+    {
+        std::tuple< FLOAT, std::tuple<size_t,size_t> > event = bh.top();
+        bh.pop();
+        FLOAT  time   = std::get<0>( event );
+        size_t index1 = std::get<0>( std::get<1>( event ) );
+        size_t index2 = std::get<1>( std::get<1>( event ) );
+        has_pending[index1] = false;
+
+        // every event left in the heap is still valid
+        FLOAT time_delta = time-time_last_update;
+        for ( std::tuple< FLOAT, FLOAT, FLOAT > & p : particles ) {
+            std::get<0>( p ) += time_delta*std::get<2>( p );
+        }
+        time_last_update = time;
+        std::cout << "At time " << time << " collision " << index1 << " and " << index2 << " is processed: "
+                  << std::get<0>( particles[index1] ) << " " << std::get<0>( particles[index2] ) << std::endl;
+
+        std::get<2>( particles[index1] ) = -std::get<2>( particles[index1] ); // <<------- simple collision
+        std::get<2>( particles[index2] ) = -std::get<2>( particles[index2] );
+
+        if ( index1 >0 ) {
+            schedule( time, index1-1 );
+        }
+        if ( index2 < particles.size()-1 ) {
+            schedule( time, index2 );
+        }
+        print_particles( particles );
+    }
+}
+
+
+// d-ary heaps of every shape pop the same keys in the same order as sorting
+template < typename HEAP >
+void check_dary( char const* name, int size )
+{
+    std::mt19937 g( 45 );
+    std::vector< std::tuple<int,std::string> > data;
+    std::vector< int > keys;
+    for ( int i=0; i<size; ++i ) {
+        int key = static_cast<int>( g() % 1000 );
+        data.push_back( std::make_tuple( key, std::to_string( key ) ) );
+        keys.push_back( key );
+    }
+    HEAP bh( std::move( std::vector< std::tuple<int,std::string> >( data.begin(), data.begin() + size/2 ) ) );
+    for ( int i=size/2; i<size; ++i ) {
+        if ( i % 2 ) bh.push( data[i] );
+        else         bh.push( std::move( data[i] ) );
+    }
+    std::sort( keys.begin(), keys.end() );
+
+    int errors = 0;
+    for ( int i=0; i<size; ++i ) {
+        if ( std::get<0>( bh.top() ) != keys[i] || std::get<1>( bh.top() ) != std::to_string( keys[i] ) ) ++errors;
+        if ( i % 3 ) {
+            bh.pop();
+        } else {
+            std::tuple<int,std::string> t = bh.take();
+            if ( std::get<0>( t ) != keys[i] ) ++errors;
+        }
+    }
+    std::cout << name << " size " << bh.size() << " errors " << errors << std::endl;
+}
+
+void test14()
+{
+    DaryHeap< int, int > bh;
+    for ( int k : { 9, 5, 3, 7, 4, 2, 8, 6, 1 } ) {
+        bh.push( k, k );
+    }
+    std::cout << bh << std::endl;
+    while ( bh.size() > 0 ) {
+        std::cout << "top=" << std::get<0>( bh.top() ) << " heap: " << bh << std::endl;
+        bh.pop();
+    }
+
+    check_dary< DaryHeap< int, std::string, 2 > >(        "2-ary split  ", 20000 );
+    check_dary< DaryHeap< int, std::string, 4 > >(        "4-ary split  ", 20000 );
+    check_dary< DaryHeap< int, std::string, 8 > >(        "8-ary split  ", 20000 );
+    check_dary< DaryHeap< int, std::string, 4, false > >( "4-ary pairs  ", 20000 );
+    check_dary< DaryHeap< int, std::string, 8, false > >( "8-ary pairs  ", 1 );
+}
+
+// push everything, then pop everything
+template < typename HEAP, typename T_value >
+double time_push_pop( std::vector< std::tuple<int,T_value> > const& data )
+{
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    HEAP bh;
+    for ( auto const& el : data ) {
+        std::tuple<int,T_value> t = el;
+        bh.push( std::move( t ) );
+    }
+    long long sum = 0;
+    while ( bh.size() > 0 ) {
+        sum += std::get<0>( bh.top() );
+        bh.pop();
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    if ( sum == 42 ) std::cout << "";
+    return seconds.count();
+}
+
+// timing only, no output file
+void test15()
+{
+    std::mt19937 g( 15 );
+    std::vector< std::tuple<int,int> > ints( 4000000 );
+    for ( auto & el : ints ) {
+        el = std::make_tuple( static_cast<int>( g() ), 0 );
+    }
+    std::cout << "4M int/int push+pop" << std::endl;
+    std::cout << "binary heap          " << time_push_pop< BinaryHeap< int, int > >( ints ) << std::endl;
+    std::cout << "4-ary split          " << time_push_pop< DaryHeap< int, int, 4 > >( ints ) << std::endl;
+    std::cout << "8-ary split          " << time_push_pop< DaryHeap< int, int, 8 > >( ints ) << std::endl;
+    std::cout << "4-ary pairs          " << time_push_pop< DaryHeap< int, int, 4, false > >( ints ) << std::endl;
+
+    std::vector< std::tuple<int,std::string> > strings( 500000 );
+    for ( auto & el : strings ) {
+        int key = static_cast<int>( g() );
+        std::ostringstream oss;
+        oss << "Action to perform at time " << key;
+        el = std::make_tuple( key, oss.str() );
+    }
+    std::cout << "500K int/string push+pop" << std::endl;
+    std::cout << "binary heap          " << time_push_pop< BinaryHeap< int, std::string > >( strings ) << std::endl;
+    std::cout << "4-ary split          " << time_push_pop< DaryHeap< int, std::string, 4 > >( strings ) << std::endl;
+    std::cout << "8-ary split          " << time_push_pop< DaryHeap< int, std::string, 8 > >( strings ) << std::endl;
+    std::cout << "4-ary pairs          " << time_push_pop< DaryHeap< int, std::string, 4, false > >( strings ) << std::endl;
+}
+
+// push(5), pop(), push(10), top(), push(7): 7 is not below the last pop
+template < typename HEAP >
+void peek_then_push( char const* name, HEAP bh )
+{
+    bh.push( std::make_tuple( 5, 0 ) );
+    bh.pop();
+    bh.push( std::make_tuple( 10, 1 ) );
+    std::cout << name << " top=" << std::get<0>( bh.top() );
+    bh.push( std::make_tuple( 7, 2 ) );
+    std::cout << " after push(7) top=" << std::get<0>( bh.top() ) << std::endl;
+}
+
+// monotone queues: pops interleaved with pushes of keys not below the last pop
+template < typename HEAP, typename T_key >
+void check_monotone( char const* name, HEAP bh, std::vector< T_key > const& steps )
+{
+    std::mt19937 g( 46 );
+    std::vector< T_key > pushed;
+    T_key last = steps[0]; // the first step is where the keys start
+    int errors = 0;
+    size_t next = 0;
+    for ( int round=0; round<20000; ++round ) {
+        // a few pushes at or after the last key popped
+        int pushes = static_cast<int>( g() % 3 );
+        for ( int i=0; i<pushes; ++i ) {
+            T_key key = last + steps[1 + next++ % ( steps.size() - 1 )];
+            bh.push( std::make_tuple( key, round ) );
+            pushed.push_back( key );
+        }
+        // a push after a peek, of a key between the last pop and the key peeked
+        if ( bh.size() > 0 && g() % 4 == 0 ) {
+            T_key peeked = std::get<0>( bh.top() );
+            if ( last < peeked ) {
+                T_key key = last + ( peeked - last ) / 2;
+                bh.push( std::make_tuple( key, round ) );
+                pushed.push_back( key );
+                if ( std::get<0>( bh.top() ) != *std::min_element( pushed.begin(), pushed.end() ) ) ++errors;
+            }
+        }
+        if ( bh.size() > 0 && g() % 2 ) {
+            T_key key = std::get<0>( bh.top() );
+            // the smallest key pushed and not yet popped
+            typename std::vector< T_key >::iterator min = std::min_element( pushed.begin(), pushed.end() );
+            if ( key != *min || key < last ) ++errors;
+            *min = pushed.back();
+            pushed.pop_back();
+            last = key;
+            bh.pop();
+        }
+    }
+    while ( bh.size() > 0 ) {
+        if ( std::get<0>( bh.top() ) < last ) ++errors;
+        last = std::get<0>( bh.top() );
+        bh.pop();
+    }
+    std::cout << name << " errors " << errors << std::endl;
+}
+
+void test16()
+{
+    RadixHeap< int, int > bh;
+    for ( int k : { 9, 5, 3, 7, 4, 2, 8, 6, 1, 3 } ) {
+        bh.push( std::make_tuple( k, k ) );
+    }
+    while ( bh.size() > 0 ) {
+        std::cout << "top=" << std::get<0>( bh.top() ) << " ";
+        bh.pop();
+    }
+    std::cout << std::endl;
+
+    // keys below zero, keys that cross zero, and repeated keys
+    check_monotone( "int      ", RadixHeap< int, int >(),                std::vector< int >{ -1000000, 0, 3, 1, 0, 70000, 12 } );
+    check_monotone( "unsigned ", RadixHeap< unsigned long long, int >(), std::vector< unsigned long long >{ 0, 5, 1ull << 40, 0, 9 } );
+    check_monotone( "double   ", RadixHeap< double, int >(),             std::vector< double >{ -1e9, 0.0, 0.25, 1e-12, 3.5, 0.0, 1e6 } );
+    check_monotone( "float    ", RadixHeap< float, int >(),              std::vector< float >{ -5.0f, 0.5f, 0.0f, 0.125f, 2.0f } );
+    check_monotone( "buckets  ", BucketQueue< int, int >( 100 ),         std::vector< int >{ 0, 3, 0, 100, 17, 1 } );
+    peek_then_push( "radix    ", RadixHeap< int, int >() );
+    peek_then_push( "buckets  ", BucketQueue< int, int >( 100 ) );
+}
+
+// the hold model of an event simulation: n pending events, each event
+// processed schedules one more a random delay later
+template < typename HEAP, typename T_key >
+double time_hold( HEAP bh, int pending, int events, std::vector< T_key > const& delays )
+{
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    size_t d = 0;
+    for ( int i=0; i<pending; ++i ) {
+        bh.push( std::make_tuple( delays[d++ % delays.size()], i ) );
+    }
+    T_key now = T_key();
+    for ( int i=0; i<events; ++i ) {
+        now = std::get<0>( bh.top() );
+        int id = std::get<1>( bh.top() );
+        bh.pop();
+        bh.push( std::make_tuple( now + delays[d++ % delays.size()], id ) );
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    if ( now < T_key() ) std::cout << "time went backwards\n";
+    return seconds.count();
+}
+
+// timing only, no output file
+void test17()
+{
+    int const pending = 1000000;
+    int const events  = 4000000;
+    std::mt19937 g( 17 );
+    std::exponential_distribution<> dis( 1.0 );
+    std::vector< double > delays( 1 << 20 );
+    std::vector< int > ticks( delays.size() );
+    for ( size_t i=0; i<delays.size(); ++i ) {
+        delays[i] = dis( g );
+        ticks[i] = 1 + static_cast<int>( g() % 1000 );
+    }
+
+    std::cout << "1M pending, 4M events, double times" << std::endl;
+    std::cout << "binary heap          " << time_hold( BinaryHeap< double, int >(),   pending, events, delays ) << std::endl;
+    std::cout << "4-ary heap           " << time_hold( DaryHeap< double, int >(),     pending, events, delays ) << std::endl;
+    std::cout << "radix heap           " << time_hold( RadixHeap< double, int >(),    pending, events, delays ) << std::endl;
+    std::cout << "1M pending, 4M events, integer ticks 1..1000" << std::endl;
+    std::cout << "binary heap          " << time_hold( BinaryHeap< int, int >(),      pending, events, ticks ) << std::endl;
+    std::cout << "radix heap           " << time_hold( RadixHeap< int, int >(),       pending, events, ticks ) << std::endl;
+    std::cout << "bucket queue         " << time_hold( BucketQueue< int, int >( 1000 ), pending, events, ticks ) << std::endl;
+}
+
+// a copy to build a heap from, the heap takes the vector by rvalue reference
+std::vector< std::tuple<int,int> > copy_of( std::vector< std::tuple<int,int> > const& data )
+{
+    return data;
+}
+
+// pops everything, counting keys out of order and comparing with the expected keys
+int drain_errors( BinaryHeap< int, int > & bh, std::vector< int > expected )
+{
+    std::sort( expected.begin(), expected.end() );
+    int errors = bh.size() == static_cast<int>( expected.size() ) ? 0 : 1;
+    for ( size_t i=0; bh.size() > 0; ++i ) {
+        if ( i >= expected.size() || std::get<0>( bh.top() ) != expected[i] ) ++errors;
+        bh.pop();
+    }
+    return errors;
+}
+
+void test18()
+{
+    BinaryHeap< int, int > bh;
+    std::vector< std::tuple<int,int> > batch;
+    for ( int k : { 9, 5, 3, 7, 4, 2, 8, 6, 1 } ) {
+        batch.push_back( std::make_tuple( k, k ) );
+    }
+    bh.push_range( batch.begin(), batch.end() );
+    std::cout << bh << std::endl;
+
+    // small and large batches into heaps of every size, then merges
+    std::mt19937 g( 47 );
+    int errors = 0;
+    for ( int n : { 0, 1, 2, 7, 100, 5000 } ) {
+        for ( int m : { 0, 1, 3, 20, 600, 9000 } ) {
+            std::vector< std::tuple<int,int> > a, b;
+            std::vector< int > keys;
+            for ( int i=0; i<n; ++i ) { int k = static_cast<int>( g() % 10000 ); a.push_back( std::make_tuple( k, i ) ); keys.push_back( k ); }
+            for ( int i=0; i<m; ++i ) { int k = static_cast<int>( g() % 10000 ); b.push_back( std::make_tuple( k, i ) ); keys.push_back( k ); }
+
+            BinaryHeap< int, int > h1( copy_of( a ) );
+            h1.push_range( b.begin(), b.end() );
+            errors += drain_errors( h1, keys );
+
+            BinaryHeap< int, int > h2( copy_of( a ) );
+            BinaryHeap< int, int > h3( copy_of( b ) );
+            h2.merge( std::move( h3 ) );
+            if ( h3.size() != 0 ) ++errors;
+            errors += drain_errors( h2, keys );
+        }
+    }
+    std::cout << "push_range and merge, errors: " << errors << std::endl;
+
+    // leaderboard: the 5 best of a stream of scores, in increasing order
+    BinaryHeap< int, std::string > best;
+    best.keep_top_k( 5 );
+    for ( int score : { 40, 95, 12, 77, 95, 60, 88, 3, 100, 51, 90 } ) {
+        best.push( std::make_tuple( score, "player" + std::to_string( score ) ) );
+    }
+    std::vector< std::tuple<int,std::string> > more = { std::make_tuple( 99, std::string( "late" ) ), std::make_tuple( 1, std::string( "slow" ) ) };
+    best.push_range( more.begin(), more.end() );
+    while ( best.size() > 0 ) {
+        std::cout << std::get<1>( best.top() ) << " " << std::get<0>( best.top() ) << std::endl;
+        best.pop();
+    }
+}
+
+// timing only, no output file
+void test19()
+{
+    std::mt19937 g( 19 );
+    std::vector< std::tuple<int,int> > base( 4000000 );
+    for ( auto & el : base ) {
+        el = std::make_tuple( static_cast<int>( g() ), 0 );
+    }
+
+    for ( size_t m : { 1000, 100000, 4000000 } ) {
+        // each key smaller than all before it, the worst case for sifting up
+        std::vector< std::tuple<int,int> > batch( m );
+        for ( size_t i=0; i<m; ++i ) {
+            batch[i] = std::make_tuple( std::numeric_limits<int>::min() + static_cast<int>( m - i ), 0 );
+        }
+
+        // a push and a pop first, so the vector growing is not timed
+        BinaryHeap< int, int > one_by_one( copy_of( base ) );
+        one_by_one.push( base[0] );
+        one_by_one.pop();
+        std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+        for ( auto const& el : batch ) {
+            one_by_one.push( el );
+        }
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        std::cout << "4M heap + " << m << " push one by one " << seconds.count() << std::endl;
+
+        BinaryHeap< int, int > ranged( copy_of( base ) );
+        ranged.push( base[0] );
+        ranged.pop();
+        start = std::chrono::steady_clock::now();
+        ranged.push_range( batch.begin(), batch.end() );
+        seconds = std::chrono::steady_clock::now() - start;
+        std::cout << "4M heap + " << m << " push_range       " << seconds.count() << std::endl;
+    }
+
+    // merging two heaps: popping one into the other against merge
+    BinaryHeap< int, int > a( copy_of( base ) ), b( copy_of( base ) );
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    while ( b.size() > 0 ) {
+        a.push( b.top() );
+        b.pop();
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "4M + 4M pop into     " << seconds.count() << std::endl;
+    BinaryHeap< int, int > c( copy_of( base ) ), d( copy_of( base ) );
+    start = std::chrono::steady_clock::now();
+    c.merge( std::move( d ) );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "4M + 4M merge        " << seconds.count() << std::endl;
+
+    // the 100 largest of 4M keys: everything in a heap against a bounded heap
+    start = std::chrono::steady_clock::now();
+    BinaryHeap< int, int > all( copy_of( base ) );
+    while ( all.size() > 100 ) {
+        all.pop();
+    }
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "top 100 full heap    " << seconds.count() << std::endl;
+    start = std::chrono::steady_clock::now();
+    BinaryHeap< int, int > top;
+    top.keep_top_k( 100 );
+    top.push_range( base.begin(), base.end() );
+    seconds = std::chrono::steady_clock::now() - start;
+    std::cout << "top 100 keep_top_k   " << seconds.count() << std::endl;
+    if ( std::get<0>( top.top() ) != std::get<0>( all.top() ) ) std::cout << "top k mismatch\n";
+}
+
+// threads push and pop at once, every key has to come out exactly once
+void test20()
+{
+    unsigned const threads = 4;
+    int const per_thread = 50000;
+    MultiQueue< int, int > mq( threads );
+    std::vector< std::vector< int > > popped( threads );
+
+    std::vector< std::thread > workers;
+    for ( unsigned t=0; t<threads; ++t ) {
+        workers.push_back( std::thread( [&mq, &popped, t]() {
+            std::tuple<int,int> out;
+            for ( int i=0; i<per_thread; ++i ) {
+                int key = i * static_cast<int>( threads ) + static_cast<int>( t );
+                mq.push( std::make_tuple( key, key ) );
+                if ( i % 2 && mq.try_pop( out ) ) {
+                    popped[t].push_back( std::get<0>( out ) );
+                }
+            }
+        } ) );
+    }
+    for ( std::thread & w : workers ) {
+        w.join();
+    }
+
+    std::tuple<int,int> out;
+    std::vector< int > count( threads * per_thread, 0 );
+    int errors = 0;
+    while ( mq.try_pop( out ) ) {
+        if ( std::get<0>( out ) != std::get<1>( out ) ) ++errors;
+        ++count[ std::get<0>( out ) ];
+    }
+    for ( std::vector< int > const& p : popped ) {
+        for ( int key : p ) {
+            ++count[key];
+        }
+    }
+    for ( int c : count ) {
+        if ( c != 1 ) ++errors;
+    }
+    std::cout << "heaps " << mq.heaps() << " keys " << count.size() << " size after " << mq.size() << " errors " << errors << std::endl;
+}
+
+// a heap behind one lock, what MultiQueue replaces
+struct LockedHeap
+{
+    std::mutex lock;
+    BinaryHeap< int, int > heap;
+    LockedHeap() : lock(), heap() {}
+    void push( std::tuple<int,int> t ) { std::lock_guard< std::mutex > guard( lock ); heap.push( std::move( t ) ); }
+    bool try_pop( std::tuple<int,int> & t ) {
+        std::lock_guard< std::mutex > guard( lock );
+        if ( heap.size() == 0 ) return false;
+        t = heap.top();
+        heap.pop();
+        return true;
+    }
+};
+
+// hold model on several threads: pop an event, push one a little later
+template < typename QUEUE >
+double time_concurrent_hold( QUEUE & q, unsigned threads, int ops )
+{
+    for ( int i=0; i<1000000; ++i ) {
+        q.push( std::make_tuple( i * 4, i ) );
+    }
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    std::vector< std::thread > workers;
+    for ( unsigned t=0; t<threads; ++t ) {
+        workers.push_back( std::thread( [&q, threads, ops, t]() {
+            std::mt19937 g( t );
+            std::tuple<int,int> event;
+            for ( int i=0; i<ops / static_cast<int>( threads ); ++i ) {
+                if ( q.try_pop( event ) ) {
+                    std::get<0>( event ) += static_cast<int>( g() % 1000 );
+                    q.push( event );
+                }
+            }
+        } ) );
+    }
+    for ( std::thread & w : workers ) {
+        w.join();
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    return seconds.count();
+}
+
+// timing and rank error only, no output file
+void test21()
+{
+    int const ops = 2000000;
+    std::cout << "hold model, 1M events, " << ops << " pop+push, Mops/s (hardware threads: " << std::thread::hardware_concurrency() << ")" << std::endl;
+    for ( unsigned threads : { 1, 2, 4, 8 } ) {
+        LockedHeap locked;
+        double t1 = time_concurrent_hold( locked, threads, ops );
+        MultiQueue< int, int > mq( threads );
+        double t2 = time_concurrent_hold( mq, threads, ops );
+        std::cout << threads << " threads: locked heap " << ops / t1 / 1e6 << "  multiqueue " << ops / t2 / 1e6 << std::endl;
+    }
+
+    // rank error: how many smaller keys were in the queue when a key was
+    // popped, counted with a Fenwick tree over the keys (one thread, so every
+    // pop sees the whole queue; the error comes from the heaps chosen)
+    int const universe = 1 << 22;
+    std::cout << "rank error, 1M keys, 1M pop+push" << std::endl;
+    for ( unsigned threads : { 1, 2, 4, 8, 16 } ) {
+        MultiQueue< int, int > mq( threads );
+        std::vector< int > tree( universe + 1, 0 );
+        auto add = [&tree, universe]( int key, int delta ) { for ( int i=key+1; i<=universe; i += i & -i ) tree[i] += delta; };
+        auto less = [&tree]( int key ) { int n = 0; for ( int i=key; i>0; i -= i & -i ) n += tree[i]; return n; };
+
+        std::mt19937 g( 21 );
+        for ( int i=0; i<1000000; ++i ) {
+            int key = static_cast<int>( g() % ( universe / 2 ) );
+            mq.push( std::make_tuple( key, i ) );
+            add( key, 1 );
+        }
+        double total = 0;
+        int worst = 0;
+        std::tuple<int,int> event;
+        for ( int i=0; i<1000000; ++i ) {
+            mq.try_pop( event );
+            int key = std::get<0>( event );
+            int rank = less( key );
+            total += rank;
+            worst = std::max( worst, rank );
+            add( key, -1 );
+            key = std::min( universe - 1, key + static_cast<int>( g() % 1000 ) );
+            mq.push( std::make_tuple( key, i ) );
+            add( key, 1 );
+        }
+        std::cout << mq.heaps() << " heaps: mean " << total / 1000000 << " max " << worst << std::endl;
+    }
+}
+
+// test11 and a few more on the simulation engine
+void test22()
+{
+    // test11: the stale 0-1 event is dropped without touching the particles
+    CollisionSimulation< FLOAT > sim;
+    sim.add_particle( -3, 1.0,  1.0 );
+    sim.add_particle(  0, 2.0,  0.5 );
+    sim.add_particle(  2, 3.0, -2.0 );
+    sim.set_listener( [&sim]( FLOAT time, size_t i, size_t j ) {
+        std::cout << "At time " << time << " collision " << i << " and " << j << " is processed: " << sim.position( i ) << " " << sim.position( j ) << std::endl;
+    } );
+    sim.start();
+    while ( sim.step() ) {
+    }
+    std::cout << "collisions " << sim.collisions() << " stale events " << sim.stale_events() << std::endl;
+
+    // Newton's cradle: the speed of the first ball ends up in the last
+    CollisionSimulation< FLOAT > cradle( true );
+    for ( int i=0; i<5; ++i ) {
+        cradle.add_particle( i, 1.0, i == 0 ? 1.0 : 0.0 );
+    }
+    cradle.start();
+    cradle.run_until( 10 );
+    for ( size_t i=0; i<cradle.size(); ++i ) {
+        std::cout << "ball " << i << " position " << cradle.position( i ) << " speed " << cradle.velocity( i ) << std::endl;
+    }
+
+    // elastic, equal masses: particles swap speeds, which is the same as
+    // passing through each other, so at any time the positions are the
+    // sorted straight line positions
+    std::mt19937 g( 49 );
+    std::uniform_real_distribution<> dis( -1.0, 1.0 );
+    CollisionSimulation< FLOAT > gas( true );
+    std::vector< FLOAT > ghosts;
+    for ( int i=0; i<2000; ++i ) {
+        FLOAT x = i * 0.01 + dis( g ) * 0.004, v = dis( g );
+        gas.add_particle( x, 1.0, v );
+        ghosts.push_back( x + 3.0 * v );
+    }
+    gas.start();
+    gas.run_until( 3.0 );
+    std::sort( ghosts.begin(), ghosts.end() );
+    FLOAT error = 0;
+    for ( size_t i=0; i<gas.size(); ++i ) {
+        error = std::max( error, std::abs( gas.position( i ) - ghosts[i] ) );
+    }
+    std::cout << "gas: collisions " << ( gas.collisions() > 100000 ? "> 100000" : "too few" ) << ", largest position error " << ( error < 1e-9 ? "< 1e-9" : "too large" ) << std::endl;
+}
+
+// the test11 loop: every event moves every particle
+size_t reference_simulation( std::vector< std::tuple< FLOAT, FLOAT, FLOAT > > particles, size_t max_events )
+{
+    BinaryHeap< FLOAT, std::tuple<size_t,size_t> > bh;
+    for ( size_t i=0; i+1<particles.size(); ++i ) {
+        FLOAT closing = std::get<2>( particles[i] ) - std::get<2>( particles[i+1] );
+        if ( closing > 0 ) bh.push( std::make_tuple( ( std::get<0>( particles[i+1] ) - std::get<0>( particles[i] ) ) / closing, std::make_tuple( i, i+1 ) ) );
+    }
+    FLOAT time_last_update = 0;
+    size_t processed = 0;
+    while ( bh.size() > 0 && processed < max_events ) {
+        FLOAT time = std::get<0>( bh.top() );
+        size_t i = std::get<0>( std::get<1>( bh.top() ) ), j = i + 1;
+        bh.pop();
+        FLOAT dt = time - time_last_update;
+        FLOAT distance = ( std::get<0>( particles[j] ) + dt * std::get<2>( particles[j] ) ) - ( std::get<0>( particles[i] ) + dt * std::get<2>( particles[i] ) );
+        if ( distance > 1e-9 || distance < -1e-9 ) continue; // cancelled
+        for ( auto & p : particles ) {
+            std::get<0>( p ) += dt * std::get<2>( p );
+        }
+        time_last_update = time;
+        std::swap( std::get<2>( particles[i] ), std::get<2>( particles[j] ) ); // equal masses
+        ++processed;
+        for ( size_t k : { i, j } ) {
+            if ( k > 0 && k == i ) {
+                FLOAT closing = std::get<2>( particles[k-1] ) - std::get<2>( particles[k] );
+                if ( closing > 0 ) bh.push( std::make_tuple( time + ( std::get<0>( particles[k] ) - std::get<0>( particles[k-1] ) ) / closing, std::make_tuple( k-1, k ) ) );
+            }
+            if ( k + 1 < particles.size() && k == j ) {
+                FLOAT closing = std::get<2>( particles[k] ) - std::get<2>( particles[k+1] );
+                if ( closing > 0 ) bh.push( std::make_tuple( time + ( std::get<0>( particles[k+1] ) - std::get<0>( particles[k] ) ) / closing, std::make_tuple( k, k+1 ) ) );
+            }
+        }
+    }
+    return processed;
+}
+
+// elastic gas of n equal particles, run for a number of collisions
+template < typename SIM >
+double time_simulation( SIM & sim, int n, size_t max_events )
+{
+    std::mt19937 g( 23 );
+    std::uniform_real_distribution<> dis( -1.0, 1.0 );
+    sim.reserve( n );
+    for ( int i=0; i<n; ++i ) {
+        sim.add_particle( i + 0.4 * dis( g ), 1.0, dis( g ) );
+    }
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    sim.start();
+    sim.run( max_events );
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    return seconds.count();
+}
+
+// timing only, no output file
+void test23()
+{
+    {
+        int const n = 20000;
+        size_t const events = 20000;
+        std::mt19937 g( 23 );
+        std::uniform_real_distribution<> dis( -1.0, 1.0 );
+        std::vector< std::tuple< FLOAT, FLOAT, FLOAT > > particles;
+        for ( int i=0; i<n; ++i ) {
+            particles.push_back( std::make_tuple( i + 0.4 * dis( g ), 1.0, dis( g ) ) );
+        }
+        std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+        size_t done = reference_simulation( particles, events );
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        std::cout << n << " particles, " << done << " collisions, every particle moved per event " << seconds.count() << std::endl;
+        CollisionSimulation< FLOAT > sim( true );
+        std::cout << n << " particles, " << events << " collisions, engine " << time_simulation( sim, n, events ) << std::endl;
+    }
+
+    int const n = 1000000;
+    size_t const events = 5000000;
+    std::cout << n << " particles, " << events << " collisions" << std::endl;
+    CollisionSimulation< FLOAT > binary( true );
+    double t = time_simulation( binary, n, events );
+    std::cout << "binary heap   " << t << " (" << events / t / 1e6 << " M events/s, " << binary.stale_events() << " stale)" << std::endl;
+    CollisionSimulation< FLOAT, DaryHeap< FLOAT, CollisionEvent > > dary( true );
+    t = time_simulation( dary, n, events );
+    std::cout << "4-ary heap    " << t << " (" << events / t / 1e6 << " M events/s)" << std::endl;
+    CollisionSimulation< FLOAT, RadixHeap< FLOAT, CollisionEvent > > radix( true );
+    t = time_simulation( radix, n, events );
+    std::cout << "radix heap    " << t << " (" << events / t / 1e6 << " M events/s)" << std::endl;
+}
+
 void (*pTests[])(void) = { 
     test0, test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, 
+    test12, test13, test14, test15, test16, test17, 
+    test18, test19, test20, test21, 
+    test22, test23, 
 };
 
 void test_all() {
@@ -0,0 +1,269 @@
+#ifndef INDEXED_BINARY_HEAP_H
+#define INDEXED_BINARY_HEAP_H
+
+#include <vector>
+#include <tuple>
+#include <iostream> // debugging only
+#include <utility>
+#include <cstddef>
+
+// key   - binary heap
+// value - actual data
+// push returns a handle that names the element for as long as it is in the
+// heap, no matter how it moves around. A position map (handle -> index) is
+// kept up to date on every move, so an element can be found in O(1) and
+// re-keyed or removed in O(log n).
+// Handles of popped or erased elements are reused by later pushes.
+
+// forward declaration for 1-1 operator<<
+template < typename T_key, typename T_value >
+class IndexedBinaryHeap;
+
+template < typename T_key, typename T_value >
+std::ostream& operator<< (std::ostream& os, IndexedBinaryHeap<T_key, T_value> const & bh);
+
+
+template < typename T_key, typename T_value >
+class IndexedBinaryHeap
+{
+    public:
+        typedef size_t handle;
+
+    private:
+        // indexing starts at 0 - i.e. minimum element is at index 0
+        std::vector< std::tuple<T_key,T_value> > data = {};
+        std::vector< handle > handles   = {}; // handles[i]   - handle of data[i]
+        std::vector< size_t > positions = {}; // positions[h] - index of handle h in data, npos if unused
+        std::vector< handle > free_handles = {};
+
+        static const size_t npos = static_cast<size_t>(-1);
+
+    public:
+        IndexedBinaryHeap() = default;
+        IndexedBinaryHeap( IndexedBinaryHeap const& ) = default; // vector copy is OK
+        IndexedBinaryHeap( IndexedBinaryHeap && ) = default; // vector move is OK
+        IndexedBinaryHeap& operator=( IndexedBinaryHeap const& ) = default; // vector assignment is OK
+        IndexedBinaryHeap& operator=( IndexedBinaryHeap && ) = default; // vector move assignment is OK
+
+        friend
+        std::ostream& operator<< (std::ostream& os, IndexedBinaryHeap<T_key, T_value> const & bh)
+        {
+            for ( std::tuple< T_key,T_value> const& el : bh.data )
+            {
+                os << std::get<0>( el ) << " "; // does not print values
+            }
+            return os;
+        }
+
+        /// @brief Add a new key/value pair to the heap
+        /// @param t - The key/value pair to add
+        /// @return The handle of the new element
+        handle push(std::tuple<T_key,T_value> t)
+        {
+            handle h = new_handle();
+
+            // Insert key at the end
+            data.push_back(std::move(t));
+            handles.push_back(h);
+            positions[h] = data.size() - 1;
+
+            // Fix violated heap
+            heapifyUp(data.size() - 1);
+            return h;
+        }
+
+        /// @brief Remove the first element in the list
+        void pop()
+        {
+            erase(handles[0]);
+        }
+
+        /// @brief  The amount of elements in the heap
+        /// @return The amount of elements in the heap
+        int size() const { return data.size(); }
+
+        /// @brief Get the key/value pair at the top of the heap
+        /// @return The key/value pair at the top of the tree
+        std::tuple<T_key,T_value> const& top() const
+        {
+            return data[0];
+        }
+
+        /// @brief Get the handle of the element at the top of the heap
+        /// @return The handle of the minimum element
+        handle top_handle() const { return handles[0]; }
+
+        /// @brief Whether a handle names an element currently in the heap
+        /// @param h - The handle
+        /// @return True if the element has not been popped or erased
+        bool contains(handle h) const { return h < positions.size() && positions[h] != npos; }
+
+        /// @brief Get the key/value pair named by a handle
+        /// @param h - The handle of an element in the heap
+        /// @return The key/value pair
+        std::tuple<T_key,T_value> const& get(handle h) const { return data[positions[h]]; }
+
+        /// @brief Decrease the key of an element
+        /// @param h       - The handle of the element
+        /// @param new_key - The new key value, not greater than the old one
+        void decrease_key(handle h, T_key new_key) // bubble up
+        {
+            size_t index = positions[h];
+            std::get<0>(data[index]) = new_key;
+            heapifyUp(index);
+        }
+
+        /// @brief Increase the key of an element
+        /// @param h       - The handle of the element
+        /// @param new_key - The new key value, not less than the old one
+        void increase_key(handle h, T_key new_key) // bubble down
+        {
+            size_t index = positions[h];
+            std::get<0>(data[index]) = new_key;
+            heapifydown(index);
+        }
+
+        /// @brief Change the key of an element in either direction
+        /// @param h       - The handle of the element
+        /// @param new_key - The new key value
+        void update_key(handle h, T_key new_key)
+        {
+            if (new_key < std::get<0>(data[positions[h]]))
+            {
+                decrease_key(h, new_key);
+            }
+            else
+            {
+                increase_key(h, new_key);
+            }
+        }
+
+        /// @brief Remove an element, the handle may be reused afterwards
+        /// @param h - The handle of the element
+        void erase(handle h)
+        {
+            size_t index = positions[h];
+            size_t last = data.size() - 1;
+
+            // Fill the hole with the last element
+            if (index != last)
+            {
+                move_to(last, index);
+            }
+            data.pop_back();
+            handles.pop_back();
+            positions[h] = npos;
+            free_handles.push_back(h);
+
+            // The moved element may belong higher or lower
+            if (index < data.size())
+            {
+                if (index != 0 && std::get<0>(data[index]) < std::get<0>(data[parent(index)]))
+                {
+                    heapifyUp(index);
+                }
+                else
+                {
+                    heapifydown(index);
+                }
+            }
+        }
+
+    private:
+
+        /// @brief Get the index of the left child of the specified node
+        /// @param i - the index of the node
+        /// @return The index of the left child
+        size_t left  (size_t i) const { return 2 * i + 1;   }
+
+        /// @brief Get the index of the right child of the specified node
+        /// @param i - The index of the specified node
+        /// @return The index of the left child
+        size_t right (size_t i) const { return 2 * i + 2;   }
+
+        /// @brief Get the index of the parent of the specified node
+        /// @param i - The index of the specified node
+        /// @return The index of the parent
+        size_t parent(size_t i) const { return (i - 1) / 2; }
+
+        /// @brief A handle for a new element, reusing a released one if possible
+        /// @return The handle
+        handle new_handle()
+        {
+            if (!free_handles.empty())
+            {
+                handle h = free_handles.back();
+                free_handles.pop_back();
+                return h;
+            }
+            positions.push_back(npos);
+            return positions.size() - 1;
+        }
+
+        /// @brief Move the element at one index to another, recording its new position
+        /// @param from - The index of the element
+        /// @param to   - The index it moves to
+        void move_to(size_t from, size_t to)
+        {
+            data[to] = std::move(data[from]);
+            handles[to] = handles[from];
+            positions[handles[to]] = to;
+        }
+
+        /// @brief Sort an element downwards. The element is held aside and each
+        ///        smaller child moves up into the hole once.
+        /// @param index - The index to enforce from
+        void heapifydown(size_t index)
+        {
+            std::tuple<T_key,T_value> moving = std::move(data[index]);
+            handle h = handles[index];
+
+            for (;;)
+            {
+                size_t smallest = left(index);
+                if (smallest >= data.size())
+                {
+                    break;
+                }
+                // Pick the smaller of the two children
+                size_t rightChild = right(index);
+                if (rightChild < data.size() && std::get<0>(data[rightChild]) < std::get<0>(data[smallest]))
+                {
+                    smallest = rightChild;
+                }
+                if (!(std::get<0>(data[smallest]) < std::get<0>(moving)))
+                {
+                    break;
+                }
+                move_to(smallest, index);
+                index = smallest;
+            }
+
+            data[index] = std::move(moving);
+            handles[index] = h;
+            positions[h] = index;
+        }
+
+        /// @brief Sort an element upwards, moving each larger parent down once
+        /// @param index - The position in the heap we are heapifying
+        void heapifyUp(size_t index)
+        {
+            std::tuple<T_key,T_value> moving = std::move(data[index]);
+            handle h = handles[index];
+
+            while (index != 0 && std::get<0>(moving) < std::get<0>(data[parent(index)]))
+            {
+                move_to(parent(index), index);
+                index = parent(index);
+            }
+
+            data[index] = std::move(moving);
+            handles[index] = h;
+            positions[h] = index;
+        }
+};
+
+template < typename T_key, typename T_value >
+const size_t IndexedBinaryHeap<T_key, T_value>::npos;
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+
+#include <vector>
+#include <tuple>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <limits>
+#include <functional>  // std::hash
+#include <type_traits>
+#include "binary_heap.h"
+
+// key   - relaxed concurrent priority queue (MultiQueue)
+// value - actual data
+// Several threads push and pop at once. Instead of one heap behind one lock
+// (which all threads wait on) there are c heaps per thread, each with its own
+// lock. A push goes to a random heap, a pop looks at the tops of two random
+// heaps and takes the smaller. A pop is not always the global minimum, but
+// the number of smaller keys it skips (the rank error) stays small on
+// average, O(number of heaps), while threads rarely meet on the same lock.
+// The top key of each heap is also kept in an atomic, so choosing between
+// two heaps takes no lock; keys must be trivially copyable for that, and the
+// largest key value marks an empty heap.
+
+template < typename T_key, typename T_value >
+class MultiQueue
+{
+    static_assert(std::is_trivially_copyable<T_key>::value, "keys are kept in atomics");
+
+    private:
+        // one heap with its lock, padded so two lanes never share a cache line
+        struct Lane
+        {
+            std::mutex lock;
+            BinaryHeap< T_key, T_value > heap;
+            std::atomic< T_key > top_key;
+            char pad[64];
+
+            Lane() : lock(), heap(), top_key(std::numeric_limits<T_key>::max()), pad() {}
+        };
+
+        std::vector< Lane > lanes;
+        std::atomic< int > count;
+
+    public:
+        /// @brief Make a queue for a number of threads
+        /// @param threads - The number of threads that will use the queue
+        /// @param c       - Heaps per thread (at least 2 heaps in total)
+        explicit MultiQueue( unsigned threads, unsigned c = 2 )
+            : lanes( threads * c < 2 ? 2 : threads * c ), count( 0 )
+        {}
+        MultiQueue( MultiQueue const& ) = delete;
+        MultiQueue& operator=( MultiQueue const& ) = delete;
+
+        /// @brief Add a new key/value pair to a random heap
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> t)
+        {
+            for (unsigned misses = 0; ; )
+            {
+                Lane & lane = lanes[random_lane()];
+                if (!lane.lock.try_lock())
+                {
+                    missed(misses); // another thread has it, pick again
+                    continue;
+                }
+                lane.heap.push(std::move(t));
+                lane.top_key.store(std::get<0>(lane.heap.top()), std::memory_order_relaxed);
+                lane.lock.unlock();
+                count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        /// @brief Remove the smaller top of two random heaps
+        /// @param t - Where to move the key/value pair
+        /// @return False if the queue was empty
+        bool try_pop(std::tuple<T_key,T_value> & t)
+        {
+            T_key const empty = std::numeric_limits<T_key>::max();
+            for (unsigned misses = 0; ; )
+            {
+                size_t i = random_lane();
+                size_t j = random_lane();
+                T_key ki = lanes[i].top_key.load(std::memory_order_relaxed);
+                T_key kj = lanes[j].top_key.load(std::memory_order_relaxed);
+                if (kj < ki)
+                {
+                    i = j;
+                    ki = kj;
+                }
+
+                if (ki == empty)
+                {
+                    // Both looked empty, the whole queue may be
+                    if (count.load(std::memory_order_relaxed) == 0)
+                    {
+                        return false;
+                    }
+                    i = nonempty_lane();
+                    if (i == lanes.size())
+                    {
+                        return false;
+                    }
+                }
+
+                Lane & lane = lanes[i];
+                if (!lane.lock.try_lock())
+                {
+                    missed(misses);
+                    continue;
+                }
+                if (lane.heap.size() == 0)
+                {
+                    // Emptied since the top key was read
+                    lane.lock.unlock();
+                    missed(misses);
+                    continue;
+                }
+                t = lane.heap.top();
+                lane.heap.pop();
+                lane.top_key.store(lane.heap.size() ? std::get<0>(lane.heap.top()) : empty, std::memory_order_relaxed);
+                lane.lock.unlock();
+                count.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        /// @brief  The amount of elements in the queue (a snapshot while other threads work)
+        /// @return The amount of elements in the queue
+        int size() const { return count.load(std::memory_order_relaxed); }
+
+        /// @brief The number of heaps
+        /// @return The number of heaps
+        size_t heaps() const { return lanes.size(); }
+
+    private:
+
+        /// @brief A random heap, from a generator owned by the calling thread
+        /// @return The index of the heap
+        size_t random_lane() const
+        {
+            static thread_local std::minstd_rand gen(static_cast<std::minstd_rand::result_type>(
+                std::hash<std::thread::id>()(std::this_thread::get_id()) | 1));
+            return gen() % lanes.size();
+        }
+
+        /// @brief Count a heap that could not be used. With more threads than
+        ///        cores a thread can be switched out while it holds a lock, and
+        ///        the others would keep hitting it for the rest of their time
+        ///        slice, so after a run of misses the thread gives up its slice.
+        /// @param misses - The misses of the current operation so far
+        void missed(unsigned & misses) const
+        {
+            if (++misses % 4 == 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        /// @brief The first heap that has an element, looking at every heap
+        /// @return The index of the heap, or the number of heaps if all are empty
+        size_t nonempty_lane() const
+        {
+            for (size_t i = 0; i < lanes.size(); ++i)
+            {
+                if (!(lanes[i].top_key.load(std::memory_order_relaxed) == std::numeric_limits<T_key>::max()))
+                {
+                    return i;
+                }
+            }
+            return lanes.size();
+        }
+};
+
+#endif
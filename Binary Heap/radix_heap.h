@@ -0,0 +1,243 @@
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <vector>
+#include <tuple>
+#include <iostream> // debugging only
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>     // memcpy
+#include <limits>
+#include <type_traits>
+
+// key   - monotone radix heap
+// value - actual data
+// A priority queue for keys that never go below the last key popped, e.g.
+// event times or Dijkstra distances. Keys are turned into unsigned integers
+// that sort the same way, and an element sits in bucket b when its key first
+// differs from the last popped key in bit b-1 (bucket 0: equal to it). Only
+// the lowest non-empty bucket is ever scanned and each element moves to a
+// lower bucket at most once per bit, so push is O(1) and pop is amortized
+// O(number of key bits) with no comparisons between elements.
+
+// order preserving map from a key type to an unsigned integer of the same size
+template < typename T_key, typename Enable = void >
+struct RadixKey;
+
+// integers: flip the sign bit of signed types so negative keys come first
+template < typename T_key >
+struct RadixKey< T_key, typename std::enable_if< std::is_integral<T_key>::value >::type >
+{
+    typedef typename std::make_unsigned<T_key>::type type;
+    static type encode(T_key key)
+    {
+        type bits = static_cast<type>(key);
+        if (std::is_signed<T_key>::value)
+        {
+            bits ^= static_cast<type>(type(1) << (std::numeric_limits<type>::digits - 1));
+        }
+        return bits;
+    }
+};
+
+// IEEE floats: set the sign bit of positive keys, invert every bit of negative
+// keys. -0 is taken as +0 and NaN is not supported.
+template < typename T_key >
+struct RadixKey< T_key, typename std::enable_if< std::is_floating_point<T_key>::value >::type >
+{
+    typedef typename std::conditional< sizeof(T_key) == 4, std::uint32_t, std::uint64_t >::type type;
+    static_assert(sizeof(T_key) == sizeof(type), "float and double keys only");
+    static type encode(T_key key)
+    {
+        if (key == 0)
+        {
+            key = 0;
+        }
+        type bits;
+        std::memcpy(&bits, &key, sizeof(bits));
+        type sign = static_cast<type>(type(1) << (std::numeric_limits<type>::digits - 1));
+        return (bits & sign) ? static_cast<type>(~bits) : static_cast<type>(bits | sign);
+    }
+};
+
+// forward declaration for 1-1 operator<<
+template < typename T_key, typename T_value >
+class RadixHeap;
+
+template < typename T_key, typename T_value >
+std::ostream& operator<< (std::ostream& os, RadixHeap<T_key, T_value> const & bh);
+
+
+template < typename T_key, typename T_value >
+class RadixHeap
+{
+    private:
+        typedef typename RadixKey<T_key>::type bits_type;
+        static const int Bits = std::numeric_limits<bits_type>::digits;
+
+        // an element and its encoded key
+        struct Entry
+        {
+            bits_type bits;
+            std::tuple<T_key,T_value> element;
+        };
+
+        // buckets[0] holds the keys equal to last, top() is its last element.
+        // Only pop() moves last, a key pushed after a top() may still be below
+        // the key top() returned. Without keys equal to last, top() finds the
+        // smallest key of the lowest bucket and remembers where it is.
+        std::vector< Entry > buckets[Bits + 1];
+        bits_type last = 0; // the last key popped
+        mutable int minBucket = -1; // where the smallest key outside bucket 0 is, -1: not known
+        mutable size_t minIndex = 0;
+        int count = 0;
+
+    public:
+        RadixHeap() = default;
+        RadixHeap( RadixHeap const& ) = default; // vector copy is OK
+        RadixHeap( RadixHeap && ) = default; // vector move is OK
+        RadixHeap& operator=( RadixHeap const& ) = default; // vector assignment is OK
+        RadixHeap& operator=( RadixHeap && ) = default; // vector move assignment is OK
+
+        friend
+        std::ostream& operator<< (std::ostream& os, RadixHeap<T_key, T_value> const & bh)
+        {
+            for ( std::vector< Entry > const& bucket : bh.buckets )
+            {
+                for ( Entry const& e : bucket )
+                {
+                    os << std::get<0>( e.element ) << " "; // does not print values
+                }
+            }
+            return os;
+        }
+
+        /// @brief Add a new key/value pair to the heap. The key must not be less
+        ///        than the key of the last element popped.
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> const& t)
+        {
+            std::tuple<T_key,T_value> copy(t);
+            push(std::move(copy));
+        }
+
+        /// @brief Move a new key/value pair to the heap. The key must not be less
+        ///        than the key of the last element popped.
+        /// @param t - The key/value pair to add
+        void push(std::tuple<T_key,T_value> && t)
+        {
+            bits_type bits = RadixKey<T_key>::encode(std::get<0>(t));
+            Entry e = { bits, std::move(t) };
+            int b = bucket(bits);
+            buckets[b].push_back(std::move(e));
+            if (b > 0 && minBucket >= 0 && bits < buckets[minBucket][minIndex].bits)
+            {
+                minBucket = b;
+                minIndex = buckets[b].size() - 1;
+            }
+            ++count;
+        }
+
+        /// @brief Remove the first element in the list
+        void pop()
+        {
+            refill();
+            buckets[0].pop_back();
+            --count;
+        }
+
+        /// @brief  The amount of elements in the heap
+        /// @return The amount of elements in the heap
+        int size() const { return count; }
+
+        /// @brief Get the key/value pair at the top of the heap
+        /// @return The key/value pair with the smallest key
+        std::tuple<T_key,T_value> const& top() const
+        {
+            if (!buckets[0].empty())
+            {
+                return buckets[0].back().element;
+            }
+            findMin();
+            return buckets[minBucket][minIndex].element;
+        }
+
+    private:
+
+        /// @brief The bucket of an encoded key: 0 if it equals last, otherwise one
+        ///        more than the highest bit where the two differ
+        /// @param bits - The encoded key
+        /// @return The bucket index
+        int bucket(bits_type bits) const
+        {
+            bits_type diff = bits ^ last;
+            if (diff == 0)
+            {
+                return 0;
+            }
+#if defined(__GNUC__)
+            return std::numeric_limits<unsigned long long>::digits - __builtin_clzll(static_cast<unsigned long long>(diff));
+#else
+            int b = 0;
+            while (diff)
+            {
+                diff >>= 1;
+                ++b;
+            }
+            return b;
+#endif
+        }
+
+        /// @brief Find the smallest key outside bucket 0, it is in the lowest
+        ///        non-empty bucket. Kept until refill() empties that bucket.
+        void findMin() const
+        {
+            if (minBucket >= 0)
+            {
+                return;
+            }
+
+            int b = 1;
+            while (buckets[b].empty())
+            {
+                ++b;
+            }
+
+            std::vector< Entry > const& from = buckets[b];
+            size_t smallest = 0;
+            for ( size_t i = 1; i < from.size(); ++i )
+            {
+                if (from[i].bits < from[smallest].bits)
+                {
+                    smallest = i;
+                }
+            }
+            minBucket = b;
+            minIndex = smallest;
+        }
+
+        /// @brief Make bucket 0 non-empty: move last up to the smallest key of the
+        ///        lowest non-empty bucket and spread that bucket over the lower ones
+        void refill()
+        {
+            if (!buckets[0].empty())
+            {
+                return;
+            }
+
+            findMin();
+            std::vector< Entry > & from = buckets[minBucket];
+            last = from[minIndex].bits;
+            minBucket = -1;
+
+            // Every key here now differs from last below the bit of this bucket
+            for ( Entry & e : from )
+            {
+                buckets[bucket(e.bits)].push_back(std::move(e));
+            }
+            from.clear();
+        }
+};
+
+#endif
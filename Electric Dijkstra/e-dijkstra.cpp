@@ -16,11 +16,13 @@
 #include <fstream> // std::ifstream
 #include <sstream>
 #include <limits> // std::numeric_limits
+#include <algorithm> // std::push_heap, std::pop_heap, std::fill
+#include <atomic>    // std::atomic
+#include <thread>    // std::thread
+#include <functional> // std::ref, std::cref
 
 // The longest possible distance
 const int INFINITE_DISTANCE = std::numeric_limits<int>::max();
-// The maximum range of the car, this will be set by the dijkstra call
-int MAX_RANGE = 0;
 
 struct Edge
 {
@@ -33,19 +35,45 @@ struct State
     int node;        // Current node
     int r_recharges; // Number of recharges left
     int r_range;     // Remaining battery range
+};
 
-    /// @brief Comparator for the priority queue
-    /// @param other - The other state to compare
-    /// @return If the current state is less than the other
-    bool operator<(const State& other) const
+// Orders states for the priority queue. The range of the car is carried here
+// instead of in a global, so several searches can run at once.
+struct StateCompare
+{
+    int max_range; // The range of the car on a full charge
+
+    /// @brief How far a state could still get, a full charge per recharge left
+    /// @param state - The state
+    /// @return The total range left
+    long long viability(const State& state) const
     {
-        int current_state_viability = r_recharges * MAX_RANGE + r_range;
-        int other_state_viability = other.r_recharges * MAX_RANGE + other.r_range;
+        return static_cast<long long>(state.r_recharges) * max_range + state.r_range;
+    }
 
-        return current_state_viability < other_state_viability;
+    /// @brief Comparator for the priority queue
+    /// @param lhs - The first state
+    /// @param rhs - The second state
+    /// @return If the first state is less viable than the second
+    bool operator()(const State& lhs, const State& rhs) const
+    {
+        return viability(lhs) < viability(rhs);
     }
 };
 
+// Memory one worker reuses for every start node it searches from, so a search
+// allocates nothing once the buffers have grown to size
+struct Scratch
+{
+    // Minimum remaining range to reach each node with given recharges left,
+    // entry node * (max_recharges + 1) + recharges
+    std::vector<int> min_distance;
+    // The open list, a heap kept with std::push_heap / std::pop_heap
+    std::vector<State> open_list;
+
+    Scratch() : min_distance(), open_list() {}
+};
+
 /// @brief Parse the graph data from the file and create an adjacency list
 /// @param filename      - The name of the file storing the info
 /// @param max_recharges - The number of recharges the car is allowed
@@ -92,32 +120,46 @@ std::vector<std::vector<Edge>> graph_data(const char* filename, int& max_recharg
 
 
 /// @brief A helper function for starting at a given node
-/// @param graph - The graph of nodes we could traverse
-/// @param start - The node to start from
+/// @param graph         - The graph of nodes we could traverse
+/// @param start         - The node to start from
 /// @param max_recharges - The maximum amount of recharges that can be made
 /// @param vehicle_range - The range of the vehicle
-/// @return Can all nodes be reached from this position
-bool sub_dijkstra(const std::vector<std::vector<Edge>>& graph, int start, int max_recharges, int vehicle_range)
+/// @param scratch       - The buffers of the calling worker
+/// @param cancelled     - Set when another start node has already failed
+/// @return Can all nodes be reached from this position (false if cancelled)
+bool sub_dijkstra(const std::vector<std::vector<Edge>>& graph, int start, int max_recharges, int vehicle_range,
+                  Scratch& scratch, const std::atomic<bool>& cancelled)
 {
     // Size of the graph
     int n = graph.size();
+    // Entries per node in the min_distance table
+    int stride = max_recharges + 1;
 
-    // Minimum remaining range to reach each node with given recharges left
-    std::vector<std::vector<int>> min_distance(n, std::vector<int>(max_recharges + 1, -1));
+    std::vector<int>& min_distance = scratch.min_distance;
+    min_distance.assign(static_cast<size_t>(n) * stride, -1);
 
-    min_distance[start][max_recharges] = vehicle_range;
+    min_distance[start * stride + max_recharges] = vehicle_range;
 
     // The open list
-    std::priority_queue<State> open_list;
+    std::vector<State>& open_list = scratch.open_list;
+    open_list.clear();
+    const StateCompare compare = {vehicle_range};
 
     // Start with no range left
-    open_list.push({start, max_recharges, 0});
+    open_list.push_back({start, max_recharges, 0});
 
     while (!open_list.empty())
     {
+        // Another start node failed, the answer is known
+        if (cancelled.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
         // Get the first node in the list
-        State currrent = open_list.top();
-        open_list.pop();
+        std::pop_heap(open_list.begin(), open_list.end(), compare);
+        State currrent = open_list.back();
+        open_list.pop_back();
 
         for (const Edge& edge : graph[currrent.node])
         {
@@ -129,21 +171,25 @@ bool sub_dijkstra(const std::vector<std::vector<Edge>>& graph, int start, int ma
             if (remaining_range >= 0)
             {
                 // Check if we can travel to the next node without a recharge
-                if (remaining_range > min_distance[next_node][currrent.r_recharges])
+                int& best = min_distance[next_node * stride + currrent.r_recharges];
+                if (remaining_range > best)
                 {
-                    min_distance[next_node][currrent.r_recharges] = remaining_range;
+                    best = remaining_range;
                     // Add that node to the open list
-                    open_list.push({next_node, currrent.r_recharges, remaining_range});
+                    open_list.push_back({next_node, currrent.r_recharges, remaining_range});
+                    std::push_heap(open_list.begin(), open_list.end(), compare);
                 }
             }
 
             if (currrent.r_recharges > 0 && vehicle_range - distance_to_next_node >= 0)
             {
-                if (vehicle_range - distance_to_next_node > min_distance[next_node][currrent.r_recharges - 1])
+                int& best = min_distance[next_node * stride + currrent.r_recharges - 1];
+                if (vehicle_range - distance_to_next_node > best)
                 {
-                    min_distance[next_node][currrent.r_recharges - 1] = vehicle_range - distance_to_next_node;
+                    best = vehicle_range - distance_to_next_node;
                     // Add the node to the open list
-                    open_list.push({next_node, currrent.r_recharges - 1, vehicle_range - distance_to_next_node});
+                    open_list.push_back({next_node, currrent.r_recharges - 1, vehicle_range - distance_to_next_node});
+                    std::push_heap(open_list.begin(), open_list.end(), compare);
                 }
             }
         }
@@ -155,7 +201,7 @@ bool sub_dijkstra(const std::vector<std::vector<Edge>>& graph, int start, int ma
 
         for (int k = 0; k <= max_recharges; k++)
         {
-            if (min_distance[i][k] >= 0)
+            if (min_distance[i * stride + k] >= 0)
             {
                 is_reachable = true;
                 break;
@@ -171,28 +217,66 @@ bool sub_dijkstra(const std::vector<std::vector<Edge>>& graph, int start, int ma
     return true;
 }
 
-/// @brief Checks if a vehicle is capable of reaching every node
+/// @brief Take start nodes one at a time until none are left or one fails
+/// @param graph         - The graph of nodes we could traverse
+/// @param max_recharges - The maximum amount of recharges that can be made
+/// @param vehicle_range - The range of the vehicle
+/// @param next_start    - The next start node nobody has taken yet
+/// @param failed        - Set by the first worker that finds a start node that fails
+void worker(const std::vector<std::vector<Edge>>& graph, int max_recharges, int vehicle_range,
+            std::atomic<int>& next_start, std::atomic<bool>& failed)
+{
+    Scratch scratch;
+    int n = graph.size();
+
+    while (!failed.load(std::memory_order_relaxed))
+    {
+        int start = next_start.fetch_add(1, std::memory_order_relaxed);
+        if (start >= n)
+        {
+            return;
+        }
+        if (!sub_dijkstra(graph, start, max_recharges, vehicle_range, scratch, failed))
+        {
+            failed.store(true, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+/// @brief Checks if a vehicle is capable of reaching every node. The start
+///        nodes are shared out between one worker per core.
 /// @param filename      - The file to create the grid from
 /// @param vehicle_range - The range of the vehicle we are testing
 /// @return CAn this vehicle reach all nodes
 bool e_dijkstra(char const *filename, int vehicle_range)
 {
-    // Set the range of the vehicle
-    MAX_RANGE = vehicle_range;
     int max_recharges; 
 
     auto graph = graph_data(filename, max_recharges);
 
-    for (unsigned long start = 0; start < graph.size(); start++)
+    std::atomic<int> next_start(0);
+    std::atomic<bool> failed(false);
+
+    // No more workers than cores or start nodes, the caller is one of them
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    if (workers > graph.size())
     {
-        if (!sub_dijkstra(graph, start, max_recharges, vehicle_range))
-        {
-            MAX_RANGE = 0;
-            return false;
-        }
-        
+        workers = std::max<size_t>(1, graph.size());
     }
-    
-    MAX_RANGE = 0;
-    return true;
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workers; i++)
+    {
+        pool.emplace_back(worker, std::cref(graph), max_recharges, vehicle_range,
+                          std::ref(next_start), std::ref(failed));
+    }
+    worker(graph, max_recharges, vehicle_range, next_start, failed);
+
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+
+    return !failed.load();
 }
@@ -1093,12 +1093,472 @@ void test26()
             ); 
 }
 
+// random index insert/erase on a large list
+void test27()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    // mostly for your own speed testing
+    // expected output - time, not used in grading
+    const int num_elements   = 10000000;
+    const int num_operations = 200000;
+
+    Lariat<int, 512> lar;
+    for ( int i=0; i<num_elements; ++i ) {
+        lar.push_back( i );
+    }
+
+    std::mt19937 gen( 280 );
+    std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+    for ( int i=0; i<num_operations; ++i ) {
+        lar.insert( static_cast<int>( gen() % ( lar.size()+1 ) ), i );
+        lar.erase( static_cast<int>( gen() % lar.size() ) );
+    }
+    std::chrono::time_point<std::chrono::system_clock> end = std::chrono::system_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end-start;
+    std::cout << "Lariat: " << num_operations << " random inserts and erases on "
+              << num_elements << " elements, time elapsed " << elapsed_seconds.count() << std::endl;
+}
+// full scans: index, iterator, find/count
+void test28()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    // mostly for your own speed testing
+    // expected output - time, not used in grading
+    const int num_elements = 10000000;
+
+    Lariat<int, 512> lar;
+    for ( int i=0; i<num_elements; ++i ) {
+        lar.push_back( i % 1000 );
+    }
+
+    long long sum = 0;
+    std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+    for ( int i=0; i<num_elements; ++i ) {
+        sum += lar[i];
+    }
+    std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now()-start;
+    std::cout << "operator[] scan " << elapsed_seconds.count() << std::endl;
+
+    start = std::chrono::system_clock::now();
+    for ( int value : lar ) {
+        sum -= value;
+    }
+    elapsed_seconds = std::chrono::system_clock::now()-start;
+    std::cout << "iterator scan   " << elapsed_seconds.count() << std::endl;
+
+    start = std::chrono::system_clock::now();
+    unsigned found = lar.find( -1 ) + lar.count( 999 );
+    elapsed_seconds = std::chrono::system_clock::now()-start;
+    std::cout << "find + count    " << elapsed_seconds.count() << std::endl;
+
+    if ( sum != 0 || found != num_elements + num_elements/1000 ) {
+        std::cout << "scan mismatch\n";
+    }
+}
+template < typename L >
+void erase_and_traverse( L & lar, char const* label )
+{
+    const int num_elements = 1000000;
+    for ( int i=0; i<num_elements; ++i ) {
+        lar.push_back( i );
+    }
+    // erase 3/4 of the elements at random positions
+    std::mt19937 gen( 280 );
+    for ( int i=0; i<num_elements/4*3; ++i ) {
+        lar.erase( static_cast<int>( gen() % lar.size() ) );
+    }
+
+    long long sum = 0;
+    std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+    for ( int pass=0; pass<20; ++pass ) {
+        for ( int value : lar ) {
+            sum += value;
+        }
+    }
+    std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now()-start;
+    std::cout << std::left << std::setw( 28 ) << label
+              << " nodes " << std::setw( 8 ) << lar.node_count()
+              << " KB " << std::setw( 8 ) << lar.node_count() * L::node_bytes() / 1024
+              << " traversal " << elapsed_seconds.count() << std::endl;
+    if ( sum == 0 ) {
+        std::cout << "traversal mismatch\n";
+    }
+}
+
+// middle erasures with and without merging of underfull nodes
+void test29()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    // mostly for your own speed testing
+    // expected output - time, not used in grading
+    Lariat<int, 1024> fixed;
+    erase_and_traverse( fixed, "Size 1024" );
+
+    Lariat<int, 1024> merged;
+    merged.auto_merge( true );
+    erase_and_traverse( merged, "Size 1024, auto merge" );
+
+    LariatBytes<int, 256> small;
+    small.auto_merge( true );
+    erase_and_traverse( small, "256 B nodes, auto merge" );
+}
+
+// sorted mode against std::multiset
+#include <set>
+template < typename C, typename Insert, typename Contains >
+void sorted_inserts_and_lookups( C & c, Insert insert, Contains contains, char const* label )
+{
+    const int num_elements = 1000000;
+    std::mt19937 gen( 280 );
+    std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
+    for ( int i=0; i<num_elements; ++i ) {
+        insert( c, static_cast<int>( gen() % 10000000 ) );
+    }
+    std::chrono::duration<double> insert_seconds = std::chrono::system_clock::now()-start;
+
+    int found = 0;
+    start = std::chrono::system_clock::now();
+    for ( int i=0; i<num_elements; ++i ) {
+        found += contains( c, static_cast<int>( gen() % 10000000 ) ) ? 1 : 0;
+    }
+    std::chrono::duration<double> lookup_seconds = std::chrono::system_clock::now()-start;
+    std::cout << std::left << std::setw( 16 ) << label
+              << " insert " << std::setw( 12 ) << insert_seconds.count()
+              << " lookup " << std::setw( 12 ) << lookup_seconds.count()
+              << " found " << found << std::endl;
+}
+
+void test30()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    // mostly for your own speed testing
+    // expected output - time, not used in grading
+    Lariat<int, 512> lar;
+    sorted_inserts_and_lookups( lar,
+        []( Lariat<int, 512> & l, int v ) { l.insert_sorted( v ); },
+        []( Lariat<int, 512> const& l, int v ) { return l.contains( v ); },
+        "Lariat sorted" );
+
+    std::multiset<int> set;
+    sorted_inserts_and_lookups( set,
+        []( std::multiset<int> & s, int v ) { s.insert( v ); },
+        []( std::multiset<int> const& s, int v ) { return s.count( v ) > 0; },
+        "std::multiset" );
+}
+
+// payload that counts how it is made, copies and moves
+struct Tracked {
+    static int copies, moves;
+    int id;
+    Tracked() : id( 0 ) {}
+    Tracked( int a, int b ) : id( a * 100 + b ) {}
+    struct Refused {};
+    explicit Tracked( Refused ) : id( -1 ) { throw Refused(); }
+    Tracked( Tracked const& rhs ) : id( rhs.id ) { ++copies; }
+    Tracked( Tracked && rhs ) noexcept : id( rhs.id ) { ++moves; }
+    Tracked& operator=( Tracked const& rhs ) { id = rhs.id; ++copies; return *this; }
+    Tracked& operator=( Tracked && rhs ) noexcept { id = rhs.id; ++moves; return *this; }
+    static void report( char const* what ) {
+        std::cout << std::left << std::setw( 28 ) << what << " copies " << copies << " moves " << moves << std::endl;
+        copies = moves = 0;
+    }
+};
+int Tracked::copies = 0;
+int Tracked::moves = 0;
+
+std::ostream& operator<<( std::ostream& os, Tracked const& t ) { return os << t.id; }
+
+#include <memory>
+
+// emplace, range insert and move-only elements
+void test31()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    Lariat<Tracked, 4> lar;
+    for ( int i = 1; i <= 6; ++i ) {
+        lar.emplace_back( 0, i );
+    }
+    Tracked::report( "emplace_back x6" );
+    lar.emplace( 2, 1, 0 );
+    Tracked::report( "emplace(2)" );
+
+    std::vector<Tracked> v;
+    for ( int i = 1; i <= 5; ++i ) {
+        v.push_back( Tracked( 2, i ) );
+    }
+    Tracked::report( "(filling a vector)" );
+    lar.insert( 3, v.begin(), v.end() );
+    Tracked::report( "insert(3, copied range)" );
+    lar.insert( static_cast<int>( lar.size() ), std::make_move_iterator( v.begin() ), std::make_move_iterator( v.end() ) );
+    Tracked::report( "insert(end, moved range)" );
+    std::cout << lar << std::endl;
+    try {
+        lar.emplace( 1, Tracked::Refused() );
+    } catch ( Tracked::Refused const& ) {
+        std::cout << "emplace(1) that throws, size " << lar.size() << ": " << lar[0] << " " << lar[1] << " " << lar[2] << std::endl;
+    }
+    Tracked::report( "(emplace that threw)" );
+
+    Lariat<std::unique_ptr<int>, 3> ptrs;
+    for ( int i = 1; i <= 4; ++i ) {
+        ptrs.emplace_back( new int( i ) );
+    }
+    std::unique_ptr<int> p( new int( 10 ) );
+    ptrs.push_back( std::move( p ) );
+    ptrs.push_front( std::unique_ptr<int>( new int( 0 ) ) );
+    ptrs.emplace( 2, new int( 20 ) );
+    ptrs.insert( 1, std::unique_ptr<int>( new int( 30 ) ) );
+    std::vector<std::unique_ptr<int>> more;
+    for ( int i = 40; i < 43; ++i ) {
+        more.emplace_back( new int( i ) );
+    }
+    ptrs.insert( 4, std::make_move_iterator( more.begin() ), std::make_move_iterator( more.end() ) );
+    ptrs.erase( 3 );
+    ptrs.pop_front();
+    ptrs.pop_back();
+    std::cout << "size " << ptrs.size() << ":";
+    for ( std::unique_ptr<int> const& q : ptrs ) {
+        std::cout << " " << *q;
+    }
+    std::cout << std::endl;
+}
+
+// every allocation of the program is counted, test32 looks at the differences
+#include <new>
+#include <cstdlib>
+static long allocations = 0;
+void* operator new( std::size_t size )
+{
+    ++allocations;
+    if ( void* p = std::malloc( size ? size : 1 ) ) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete( void* p ) noexcept { std::free( p ); }
+
+// node pool: no allocations after reserve, values released with their nodes
+void test32()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    Lariat<int, 16> lar;
+    lar.reserve( 1000 );
+    long before = allocations;
+    for ( int i = 0; i < 1000; ++i ) {
+        lar.push_back( i );
+    }
+    std::cout << "allocations filling 1000 after reserve(1000): " << allocations - before << std::endl;
+
+    before = allocations;
+    for ( int round = 0; round < 100; ++round ) {
+        for ( int i = 0; i < 500; ++i ) {
+            lar.pop_back();
+        }
+        lar.compact();
+        for ( int i = 0; i < 300; ++i ) {
+            lar.erase( i % static_cast<int>( lar.size() ) );
+        }
+        for ( int i = 0; i < 800; ++i ) {
+            lar.insert( i % static_cast<int>( lar.size() + 1 ), i );
+        }
+    }
+    std::cout << "allocations in 100 pop/compact/erase/insert rounds: " << allocations - before
+              << ", size " << lar.size() << std::endl;
+
+    lar.clear();
+    before = allocations;
+    for ( int i = 0; i < 1000; ++i ) {
+        lar.push_back( i );
+    }
+    std::cout << "allocations refilling after clear: " << allocations - before << std::endl;
+
+    std::shared_ptr<int> shared( new int( 7 ) );
+    Lariat<std::shared_ptr<int>, 4> owners;
+    for ( int i = 0; i < 10; ++i ) {
+        owners.push_back( shared );
+    }
+    std::cout << "use_count with 10 copies: " << shared.use_count() << std::endl;
+    owners.clear();
+    std::cout << "use_count after clear: " << shared.use_count() << std::endl;
+    for ( int i = 0; i < 10; ++i ) {
+        owners.push_back( shared );
+    }
+    owners.erase( 5 );
+    owners.pop_front();
+    owners.pop_back();
+    std::cout << "use_count after erase, pop_front, pop_back: " << shared.use_count() << std::endl;
+    while ( owners.size() ) {
+        owners.pop_back();
+    }
+    std::cout << "use_count after popping every element: " << shared.use_count() << std::endl;
+}
+
+// checks that subscripting (which walks the index) agrees with the node walk
+template <typename T, int Size>
+bool IndexAgrees( Lariat<T, Size> const& lar )
+{
+    int i = 0;
+    for ( auto const& value : lar ) {
+        if ( lar[i++] != value ) {
+            return false;
+        }
+    }
+    return i == static_cast<int>( lar.size() );
+}
+
+template <int Size>
+void PrintSplit( char const* what, Lariat<int, Size> const& left, Lariat<int, Size> const& right )
+{
+    std::cout << what << "\nleft (size " << left.size() << ", index "
+              << ( IndexAgrees( left ) ? "ok" : "BAD" ) << ")\n" << left
+              << "right (size " << right.size() << ", index "
+              << ( IndexAgrees( right ) ? "ok" : "BAD" ) << ")\n" << right << std::endl;
+}
+
+template <int Size>
+Lariat<int, Size> Numbers( int first, int count )
+{
+    Lariat<int, Size> lar;
+    for ( int i = 0; i < count; ++i ) {
+        lar.push_back( first + i );
+    }
+    return lar;
+}
+
+// split_at, append and splice
+void test33()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    {
+        Lariat<int, 4> left = Numbers<4>( 1, 10 );
+        Lariat<int, 4> right = left.split_at( 0 );
+        PrintSplit( "split_at(0)", left, right );
+    }
+    {
+        Lariat<int, 4> left = Numbers<4>( 1, 10 );
+        Lariat<int, 4> right = left.split_at( 10 );
+        PrintSplit( "split_at(size)", left, right );
+    }
+    {
+        Lariat<int, 4> left = Numbers<4>( 1, 10 );
+        Lariat<int, 4> right = left.split_at( 8 );
+        PrintSplit( "split_at(8), inside a node", left, right );
+    }
+    {
+        Lariat<int, 4> left = Numbers<4>( 1, 10 );
+        Lariat<int, 4> right = left.split_at( 6 );
+        PrintSplit( "split_at(6), at a node boundary", left, right );
+    }
+    {
+        Lariat<int, 4> lar;
+        Lariat<int, 4> rhs = Numbers<4>( 1, 6 );
+        lar.append( std::move( rhs ) );
+        PrintSplit( "append to an empty list", lar, rhs );
+    }
+    {
+        Lariat<int, 4> lar = Numbers<4>( 1, 6 );
+        Lariat<int, 4> rhs;
+        lar.append( std::move( rhs ) );
+        PrintSplit( "append an empty list", lar, rhs );
+    }
+    {
+        Lariat<int, 4> lar = Numbers<4>( 1, 6 );
+        Lariat<int, 4> rhs = Numbers<4>( 7, 1 );
+        lar.append( std::move( rhs ) );
+        PrintSplit( "append merging the nodes at the seam", lar, rhs );
+    }
+    {
+        Lariat<int, 4> lar = Numbers<4>( 1, 10 );
+        Lariat<int, 4> rhs = Numbers<4>( 100, 5 );
+        lar.splice( 5, std::move( rhs ) );
+        PrintSplit( "splice(5) into the middle", lar, rhs );
+    }
+
+    // random splits, appends and splices against a vector
+    std::mt19937 gen( 33 );
+    Lariat<int, 8> lar;
+    std::vector<int> expected;
+    int next = 0;
+    int failures = 0;
+    for ( int round = 0; round < 2000; ++round ) {
+        int index = static_cast<int>( gen() % ( expected.size() + 1 ) );
+        Lariat<int, 8> piece;
+        std::vector<int> added;
+        int count = static_cast<int>( gen() % 20 );
+        for ( int i = 0; i < count; ++i ) {
+            piece.push_back( next );
+            added.push_back( next++ );
+        }
+        switch ( gen() % 3 ) {
+            case 0: {
+                Lariat<int, 8> rest = lar.split_at( index );
+                std::vector<int> tail( expected.begin() + index, expected.end() );
+                expected.resize( static_cast<size_t>( index ) );
+                if ( !IndexAgrees( rest ) || !std::equal( tail.begin(), tail.end(), rest.begin() ) ) {
+                    ++failures;
+                }
+                lar.append( std::move( rest ) );
+                expected.insert( expected.end(), tail.begin(), tail.end() );
+                break;
+            }
+            case 1:
+                lar.append( std::move( piece ) );
+                expected.insert( expected.end(), added.begin(), added.end() );
+                break;
+            default:
+                lar.splice( index, std::move( piece ) );
+                expected.insert( expected.begin() + index, added.begin(), added.end() );
+                break;
+        }
+        if ( expected.size() > 500 ) {
+            Lariat<int, 8> dropped = lar.split_at( 250 );
+            expected.resize( 250 );
+        }
+        if ( static_cast<int>( lar.size() ) != static_cast<int>( expected.size() ) || !IndexAgrees( lar )
+             || !std::equal( expected.begin(), expected.end(), lar.begin() ) ) {
+            ++failures;
+        }
+    }
+    std::cout << "random split_at/append/splice rounds failed: " << failures << std::endl;
+}
+
+// auto merging is carried by copies, moves, assignments and split_at
+void test34()
+{
+    std::cout << "-------- " << __func__ << " --------\n";
+    Lariat<int, 4> merging = Numbers<4>( 1, 10 );
+    merging.auto_merge( true );
+
+    Lariat<int, 4> copied( merging );
+    Lariat<int, 4> assigned;
+    assigned = merging;
+    Lariat<int, 4> moved_from( merging );
+    Lariat<int, 4> move_assigned;
+    move_assigned = std::move( moved_from );
+    Lariat<int, 4> rest = copied.split_at( 5 );
+    std::cout << "copy " << copied.auto_merge() << ", copy assignment " << assigned.auto_merge()
+              << ", move assignment " << move_assigned.auto_merge() << ", split_at " << rest.auto_merge() << std::endl;
+
+    // and off again when assigned from a list that does not merge
+    Lariat<int, 4> plain = Numbers<4>( 1, 3 );
+    assigned = plain;
+    move_assigned = std::move( plain );
+    std::cout << "after assigning a list that does not merge: " << assigned.auto_merge() << " " << move_assigned.auto_merge() << std::endl;
+
+    // the assigned list merges its underfull nodes
+    assigned = merging;
+    for ( int i = 0; i < 5; ++i ) {
+        assigned.erase( 1 );
+    }
+    std::cout << assigned << std::endl;
+}
 
 void (*pTests[])(void) = { 
 	test0, test1, test2, test3, test4, test5, test6, 
 	test7, test8, test9, test10, test11, test12, test13, 
 	test14, test15, test16, test17, test18, test19, test20,
-	test21, test22, test23, test24, test25, test26
+	test21, test22, test23, test24, test25, test26, test27, test28, test29, test30,
+	test31, test32, test33, test34
 };
 
 void test_all() {
@@ -14,14 +14,291 @@
 #include <iomanip>
 #include "lariat.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h> // _mm_cmpeq_epi32, _mm_cmpeq_ps, _mm_movemask_*
+#endif
+
 #if 1
 
+///-----------------------------------------------------------------------------//
+/// @brief Position of the first element equal to value.
+/// @param values - The node's array.
+/// @param count  - Number of elements in use.
+/// @param value  - The value to look for.
+/// @return The local index of the first match, count if there is none (int).
+///-----------------------------------------------------------------------------//
+template <typename T, bool Arithmetic>
+int LariatScan<T, Arithmetic>::find(const T *values, int count, const T &value)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    if (values[i] == value)
+    {
+      return i;
+    }
+  }
+  return count;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Number of elements equal to value.
+/// @param values - The node's array.
+/// @param count  - Number of elements in use.
+/// @param value  - The value to look for.
+/// @return The number of matches (int).
+///-----------------------------------------------------------------------------//
+template <typename T, bool Arithmetic>
+int LariatScan<T, Arithmetic>::count(const T *values, int count, const T &value)
+{
+  int matches = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    if (values[i] == value)
+    {
+      ++matches;
+    }
+  }
+  return matches;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Position of the first element equal to value. Blocks of 16 are
+///        tested without branches, only a block with a match is searched.
+/// @param values - The node's array.
+/// @param count  - Number of elements in use.
+/// @param value  - The value to look for.
+/// @return The local index of the first match, count if there is none (int).
+///-----------------------------------------------------------------------------//
+template <typename T>
+int LariatScan<T, true>::find(const T *values, int count, const T &value)
+{
+  const T key = value;
+  int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    bool hit = false;
+    for (int j = 0; j < 16; ++j)
+    {
+      hit |= values[i + j] == key;
+    }
+    if (hit)
+    {
+      break;
+    }
+  }
+  for (; i < count; ++i)
+  {
+    if (values[i] == key)
+    {
+      return i;
+    }
+  }
+  return count;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Number of elements equal to value, summed without branches.
+/// @param values - The node's array.
+/// @param count  - Number of elements in use.
+/// @param value  - The value to look for.
+/// @return The number of matches (int).
+///-----------------------------------------------------------------------------//
+template <typename T>
+int LariatScan<T, true>::count(const T *values, int count, const T &value)
+{
+  const T key = value;
+  int matches = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    matches += values[i] == key;
+  }
+  return matches;
+}
+
+#if defined(__SSE2__)
+///-----------------------------------------------------------------------------//
+/// @brief Position of the first int equal to value, 16 per iteration.
+///-----------------------------------------------------------------------------//
+inline int LariatScan<int, true>::find(const int *values, int count, const int &value)
+{
+  const __m128i key = _mm_set1_epi32(value);
+  int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const __m128i *block = reinterpret_cast<const __m128i *>(values + i);
+    __m128i any = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(_mm_loadu_si128(block), key),
+                                            _mm_cmpeq_epi32(_mm_loadu_si128(block + 1), key)),
+                               _mm_or_si128(_mm_cmpeq_epi32(_mm_loadu_si128(block + 2), key),
+                                            _mm_cmpeq_epi32(_mm_loadu_si128(block + 3), key)));
+    if (_mm_movemask_epi8(any))
+    {
+      break;
+    }
+  }
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)), key);
+    int mask = _mm_movemask_epi8(eq);
+    if (mask)
+    {
+      return i + __builtin_ctz(static_cast<unsigned>(mask)) / 4;
+    }
+  }
+  for (; i < count; ++i)
+  {
+    if (values[i] == value)
+    {
+      return i;
+    }
+  }
+  return count;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Number of ints equal to value. Each match subtracts -1 from a lane.
+///-----------------------------------------------------------------------------//
+inline int LariatScan<int, true>::count(const int *values, int count, const int &value)
+{
+  const __m128i key = _mm_set1_epi32(value);
+  __m128i lanes = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)), key);
+    lanes = _mm_sub_epi32(lanes, eq);
+  }
+  int sums[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(sums), lanes);
+  int matches = sums[0] + sums[1] + sums[2] + sums[3];
+  for (; i < count; ++i)
+  {
+    matches += values[i] == value;
+  }
+  return matches;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Position of the first float equal to value, 16 per iteration.
+///-----------------------------------------------------------------------------//
+inline int LariatScan<float, true>::find(const float *values, int count, const float &value)
+{
+  const __m128 key = _mm_set1_ps(value);
+  int i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    __m128 any = _mm_or_ps(_mm_or_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + i), key),
+                                     _mm_cmpeq_ps(_mm_loadu_ps(values + i + 4), key)),
+                           _mm_or_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + i + 8), key),
+                                     _mm_cmpeq_ps(_mm_loadu_ps(values + i + 12), key)));
+    if (_mm_movemask_ps(any))
+    {
+      break;
+    }
+  }
+  for (; i + 4 <= count; i += 4)
+  {
+    int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + i), key));
+    if (mask)
+    {
+      return i + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+  }
+  for (; i < count; ++i)
+  {
+    if (values[i] == value)
+    {
+      return i;
+    }
+  }
+  return count;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Number of floats equal to value. Each match subtracts -1 from a lane.
+///-----------------------------------------------------------------------------//
+inline int LariatScan<float, true>::count(const float *values, int count, const float &value)
+{
+  const __m128 key = _mm_set1_ps(value);
+  __m128i lanes = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    lanes = _mm_sub_epi32(lanes, _mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(values + i), key)));
+  }
+  int sums[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(sums), lanes);
+  int matches = sums[0] + sums[1] + sums[2] + sums[3];
+  for (; i < count; ++i)
+  {
+    matches += values[i] == value;
+  }
+  return matches;
+}
+#endif
+
+///-----------------------------------------------------------------------------//
+/// @brief Deletes the nodes on the free list.
+///-----------------------------------------------------------------------------//
+template <typename Node>
+LariatNodePool<Node>::~LariatNodePool()
+{
+  while (m_Free)
+  {
+    Node *next = m_Free->next;
+    delete m_Free;
+    m_Free = next;
+  }
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Takes a node from the free list, or allocates one if it is empty.
+/// @return The node (Node*).
+///-----------------------------------------------------------------------------//
+template <typename Node>
+Node *LariatNodePool<Node>::allocate()
+{
+  if (!m_Free)
+  {
+    return new Node();
+  }
+
+  Node *node = m_Free;
+  m_Free = node->next;
+  --m_Available;
+  return node;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Puts a node on the free list.
+/// @param node - The node, no longer used by the list.
+///-----------------------------------------------------------------------------//
+template <typename Node>
+void LariatNodePool<Node>::deallocate(Node *node)
+{
+  node->next = m_Free;
+  m_Free = node;
+  ++m_Available;
+}
+
+///-----------------------------------------------------------------------------//
+/// @brief Allocates nodes until the free list holds at least count of them.
+/// @param count - Number of free nodes wanted.
+///-----------------------------------------------------------------------------//
+template <typename Node>
+void LariatNodePool<Node>::reserve(size_t count)
+{
+  while (m_Available < count)
+  {
+    deallocate(new Node());
+  }
+}
+
 ///-----------------------------------------------------------------------------//
 /// @brief Add an element to the back of a node.
 /// @param value
 ///-----------------------------------------------------------------------------//
-template <typename T, int Size>
-void Lariat<T, Size>::LNode::push_back(const T &value)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::LNode::push_back(T &&value)
 {
   // If adding the element would exceed array size throw.
   if (this->count + 1 > Size)
@@ -30,15 +307,15 @@ void Lariat<T, Size>::LNode::push_back(const T &value)
   }
 
   // Add the value to the array.
-  this->values[this->count++] = value;
+  this->values[this->count++] = std::move(value);
 }
 
 ///-----------------------------------------------------------------------------//
 /// @brief Remove an element from the back of a node.
 /// @return The removed value (T).
 ///-----------------------------------------------------------------------------//
-template <typename T, int Size>
-T Lariat<T, Size>::LNode::pop_back()
+template <typename T, int Size, template <typename> class Alloc>
+T Lariat<T, Size, Alloc>::LNode::pop_back()
 {
   // If the node's array is empty.
   if (this->count <= 0)
@@ -46,42 +323,49 @@ T Lariat<T, Size>::LNode::pop_back()
     throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
-  return this->values[--this->count];
+  return std::move(this->values[--this->count]);
 }
 
 //----------------------------------------------------------------------------
 /// @brief Shift all the elements in the given node down
-/// @param node - The node to shift.
-/// @return The overflow from shifting the elements.
+/// @param node  - The node to shift.
+/// @param index - The local index of the element to remove.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-const T Lariat<T, Size>::shiftDown(LNode *node, int index)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::shiftDown(LNode *node, int index)
 {
   // If the node is not null.
   if (node)
   {
-    // Shift all elements in the array to the left.
-    for (int i = index; i < node->count - 1; i++)
-    {
-      std::swap(node->values[i], node->values[i + 1]);
-    }
+    // Move all elements after the index one to the left.
+    std::move(node->values + index + 1, node->values + node->count, node->values + index);
 
     node->count--;
+    resetValues(node->values + node->count, node->values + node->count + 1);
+    indexUpdate(node, -1);
   }
-
-  return node->values[index];
 }
 
 //----------------------------------------------------------------------------
 /// @brief Inserts a value at the end of the list
 /// @param value - Value to insert at the end of the list.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::push_back(T const &value)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::push_back(T const &value)
+{
+  push_back(T(value));
+}
+
+//----------------------------------------------------------------------------
+/// @brief Moves a value to the end of the list
+/// @param value - Value to insert at the end of the list.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::push_back(T &&value)
 {
   if (!m_Tail)
   {
-    push_front(value);
+    push_front(std::move(value));
     return;
   }
   m_Size++;
@@ -92,31 +376,52 @@ void Lariat<T, Size>::push_back(T const &value)
     split(m_Tail);
     // Update the node.
     m_Tail = m_Tail->next;
-    m_Tail->push_back(value);
+    m_Tail->push_back(std::move(value));
+    indexUpdate(m_Tail, 1);
   }
   else
   {
-    insertNode(m_Tail, m_Tail->count, value);
+    insertNode(m_Tail, m_Tail->count, std::move(value));
   }
 }
 
+//----------------------------------------------------------------------------
+/// @brief Constructs a value at the end of the list.
+/// @param args - Arguments for the constructor of T.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+template <typename... Args>
+void Lariat<T, Size, Alloc>::emplace_back(Args &&...args)
+{
+  emplace(m_Size, std::forward<Args>(args)...);
+}
+
 //----------------------------------------------------------------------------
 /// @brief Inserts a value at the front of the list.
 /// @param value - The value to insert at the end of the list.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::push_front(T const &value)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::push_front(T const &value)
+{
+  push_front(T(value));
+}
+
+//----------------------------------------------------------------------------
+/// @brief Moves a value to the front of the list.
+/// @param value - The value to insert at the front of the list.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::push_front(T &&value)
 {
   // If the list is empty.
   if (!m_Head)
   {
-    m_Head = new LNode();
-    m_NodeCount++;
+    m_Head = addNode(nullptr);
     m_Tail = m_Head;
   }
 
   // Insert the node.
-  insertNode(m_Head, 0, value);
+  insertNode(m_Head, 0, std::move(value));
 
  
   if (!m_Tail)
@@ -137,8 +442,8 @@ void Lariat<T, Size>::push_front(T const &value)
 /// @brief Removes an element from the list.
 /// @param index - the global index of the element.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::erase(int index)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::erase(int index)
 {
   // If the index is out of range, throw an exception.
   if (index < 0 || index >= m_Size)
@@ -163,13 +468,15 @@ void Lariat<T, Size>::erase(int index)
   std::tie(node, localIndex) = findElement(index);
   shiftDown(node, localIndex);
   m_Size--;
+
+  mergeUnderfull(node);
 }
 
 //----------------------------------------------------------------------------
 /// @brief Removes an element from the back of the list.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::pop_back()
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::pop_back()
 {
   // Make sure the tail is valid.
   if (!m_Tail)
@@ -177,8 +484,17 @@ void Lariat<T, Size>::pop_back()
     return;
   }
 
+  // Drop empty nodes left at the back by erase.
+  while (m_Tail->count == 0 && m_Tail != m_Head)
+  {
+    m_Tail = m_Tail->prev;
+    deleteNode(m_Tail->next);
+  }
+
   // Update statistics.
   m_Tail->count--;
+  resetValues(m_Tail->values + m_Tail->count, m_Tail->values + m_Tail->count + 1);
+  indexUpdate(m_Tail, -1);
   this->m_Size--;
 
   // If the tail becomes empty delete it.
@@ -197,13 +513,17 @@ void Lariat<T, Size>::pop_back()
       m_Head = nullptr;
     }
   }
+  else
+  {
+    mergeUnderfull(m_Tail);
+  }
 }
 
 //----------------------------------------------------------------------------
 /// @brief Removes the first element in the list.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::pop_front()
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::pop_front()
 {
   // Check if the head is valid.
   if (!m_Head)
@@ -211,6 +531,13 @@ void Lariat<T, Size>::pop_front()
     return;
   }
 
+  // Drop empty nodes left at the front by erase.
+  while (m_Head->count == 0 && m_Head != m_Tail)
+  {
+    m_Head = m_Head->next;
+    deleteNode(m_Head->prev);
+  }
+
   // Shift all elements in the head's array down.
   shiftDown(m_Head, 0);
   m_Size--;
@@ -224,23 +551,33 @@ void Lariat<T, Size>::pop_front()
       m_Head = m_Head->next;
       m_Head->prev = nullptr;
     }
+    else
+    {
+      // That was the only node.
+      m_Head = nullptr;
+      m_Tail = nullptr;
+    }
     deleteNode(temp);
   }
+  else
+  {
+    mergeUnderfull(m_Head);
+  }
 }
 
 //----------------------------------------------------------------------------
 /// @brief Clears all the data in the list.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::clear()
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::clear()
 {
   LNode *node = m_Head;
   // Traverse the list
   while (node != nullptr)
   {
-    // Clear all the data in the node
+    // Give the node back to the allocator
     LNode *next = node->next;
-    delete node;
+    releaseNode(node);
     node = next;
   }
   // Reset the head and tail
@@ -250,13 +587,14 @@ void Lariat<T, Size>::clear()
   m_Size = 0;
   m_NodeCount = 0;
   m_ASize = Size;
+  indexReset();
 }
 
 //----------------------------------------------------------------------------
 /// @brief Uses as few nodes as possible to store the same amount of data.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::compact()
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::compact()
 {
 
   // If the list does not exist.
@@ -296,7 +634,15 @@ void Lariat<T, Size>::compact()
     // Move the values from the next node to the current.
     for (int i = 0; i < nextNodeCount; i++)
     {
-      current->push_back(next->values[i]);
+      // The value may already be in place (moving it onto itself would empty it).
+      if (current == next && current->count == i)
+      {
+        current->count++;
+      }
+      else
+      {
+        current->push_back(std::move(next->values[i]));
+      }
       // Check if the count is full after each.
       if (current->count == m_ASize)
       {
@@ -327,150 +673,373 @@ void Lariat<T, Size>::compact()
   {
     m_Tail = m_Tail->next;
   }
+
+  // Every count changed, recompute the index in one pass.
+  indexRebuild();
 }
 
 //----------------------------------------------------------------------------
-/// @brief Splits a full node in two
-/// @param node  - The node to split.
-/// @param index - Where to split the node.
+/// @brief Prepares enough nodes for a number of elements. Nodes filled by
+///        splitting are at least half full, so that is what is planned for.
+/// @param count - The number of elements the list should hold without allocating.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::split(LNode *node) const
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::reserve(size_t count)
 {
-  // New node to split the original into.
-  LNode *split_node = new LNode();
-
-  // Swap the next pointers
-  std::swap(split_node->next, node->next);
-
-  // Update list.
-  node->next = split_node;
-  split_node->prev = node;
-
-  // Add one to the node, to account for the new value being added.
-  // Add one again to force it to round up.
-  int index = (node->count + 1 + 1) / 2;
+  const size_t half = (Size + 1) / 2;
+  const size_t nodes = (count + half - 1) / half;
+  const size_t current = static_cast<size_t>(m_NodeCount);
 
-  // Move the values at and after the index to the new node.
-  for (int i = index; i < m_ASize; i++)
+  if (nodes > current)
   {
-    split_node->values[i - index] = node->values[i];
-    ++split_node->count;
+    m_Alloc.reserve(nodes - current);
   }
 
-  // Update the original node's count;
-  node->count = index;
-
-  // Update previous pointer of next node.
-  if (split_node->next != nullptr)
+  // Nodes new to the pool have no index links yet, give them theirs now so
+  // taking them later does not allocate. They are chained through next
+  // while they are out of the pool.
+  size_t pooled = m_Alloc.available();
+  LNode *taken = nullptr;
+  for (size_t i = 0; i < pooled; ++i)
   {
-    split_node->next->prev = split_node;
+    LNode *node = m_Alloc.allocate();
+    if (!node->links)
+    {
+      pickLevels(node);
+    }
+    node->next = taken;
+    taken = node;
+  }
+  while (taken)
+  {
+    LNode *next = taken->next;
+    m_Alloc.deallocate(taken);
+    taken = next;
   }
-  m_NodeCount++;
 }
 
 //----------------------------------------------------------------------------
-/// @brief Finds the node and local index of an element in the list.
-/// @param globalIndex - the global index of the element.
-/// @return The node and local index of an element in the list (std::tuple).
+/// @brief Moves the elements from an index on into a new list. Only the node
+///        holding the index is split, every other node is relinked.
+/// @param index - The global index of the first element to move.
+/// @return The list of the elements at and after the index.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-std::tuple<typename Lariat<T, Size>::LNode *, int> Lariat<T, Size>::findElement(int globalIndex) const
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc> Lariat<T, Size, Alloc>::split_at(int index)
 {
-  LNode *current = nullptr;
-
-  if (m_Head)
+  // If the index is out of range, throw an exception.
+  if (index < 0 || index > m_Size)
   {
-    current = m_Head;
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
-  int count = 0;
-
-  // Traverse the lariat, keeping a tally of all elements until global index is reached
-  while (current->count + count <= globalIndex && current != m_Tail)
+  Lariat rest;
+  rest.m_AutoMerge = m_AutoMerge;
+  if (index == m_Size)
   {
-    count += current->count;
-    current = current->next;
+    return rest;
+  }
+  if (index == 0)
+  {
+    rest.take(*this);
+    return rest;
   }
 
-  // The difference between the global index and the tally
-  int difference = globalIndex - count;
+  // Find the element at the given index
+  int localIndex = 0;
+  LNode *node;
+  std::tie(node, localIndex) = findElement(index);
 
-  // If the difference is within the bounds of the lariat.
-  if (difference >= 0)
+  // The last node that stays.
+  LNode *last = node->prev;
+  if (localIndex > 0)
   {
-    return std::make_tuple(current, difference);
+    // The cut is inside the node, its back half goes to a node of its own.
+    LNode *right = addNode(node);
+    int moved = node->count - localIndex;
+    std::move(node->values + localIndex, node->values + node->count, right->values);
+    right->count = moved;
+    indexUpdate(right, moved);
+    node->count = localIndex;
+    indexUpdate(node, -moved);
+    if (node == m_Tail)
+    {
+      m_Tail = right;
+    }
+    last = node;
   }
 
-  return std::make_tuple(nullptr, -1);
+  // Cut the index, then the list.
+  int nodes = indexCut(last, rest);
+  rest.m_Head = last->next;
+  rest.m_Head->prev = nullptr;
+  rest.m_Tail = m_Tail;
+  rest.m_Size = m_Size - index;
+  rest.m_NodeCount = m_NodeCount - nodes;
+
+  last->next = nullptr;
+  m_Tail = last;
+  m_Size = index;
+  m_NodeCount = nodes;
+
+  return rest;
 }
 
 //----------------------------------------------------------------------------
-/// @brief Shfits all the elements in the list up.
-/// @param node  - the index of the element inside the node.
-/// @param index - the local index of the element.
+/// @brief Moves the elements of another list to the end of this one. The
+///        nodes are relinked, the two nodes at the seam are merged if they fit
+///        in one.
+/// @param rhs - The list to take the elements from, left empty.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-const T *Lariat<T, Size>::shiftUp(LNode *node, int index)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::append(Lariat &&rhs)
 {
-  // Index out of bounds.
-  if (index < 0 || index > m_ASize)
+  if (this == &rhs || !rhs.m_Head)
   {
-    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+    return;
+  }
+  if (!m_Head)
+  {
+    take(rhs);
+    return;
   }
 
-  if (node)
+  // Link the index and the nodes.
+  indexJoin(rhs);
+  LNode *seam = m_Tail;
+  seam->next = rhs.m_Head;
+  rhs.m_Head->prev = seam;
+  m_Tail = rhs.m_Tail;
+  m_Size += rhs.m_Size;
+  m_NodeCount += rhs.m_NodeCount;
+
+  rhs.m_Head = nullptr;
+  rhs.m_Tail = nullptr;
+  rhs.m_Size = 0;
+  rhs.m_NodeCount = 0;
+
+  // Merge the nodes at the seam if they fit in one.
+  LNode *next = seam->next;
+  if (seam->count + next->count <= m_ASize)
   {
-    // Swap the values in the array in ascending order.
-    for (int i = index; i < m_ASize; ++i)
+    int moved = next->count;
+    std::move(next->values, next->values + moved, seam->values + seam->count);
+    seam->count += moved;
+    indexUpdate(seam, moved);
+    next->count = 0;
+    indexUpdate(next, -moved);
+    if (next == m_Tail)
     {
-      std::swap(node->values[index], node->values[i]);
+      m_Tail = seam;
     }
+    deleteNode(next);
   }
-
-  return &(node)->values[index];
 }
 
 //----------------------------------------------------------------------------
-/// @brief Swaps two values
-/// @param a - the value to swap.
-/// @param b - the value to swap.
+/// @brief Moves the elements of another list into this one before an index.
+/// @param index - The global index the first moved element ends up at.
+/// @param rhs   - The list to take the elements from, left empty.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::swap(T &a, T &b)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::splice(int index, Lariat &&rhs)
 {
-  T temp = a;
-  a = b;
-  b = temp;
+  // If the index is out of range, throw an exception.
+  if (index < 0 || index > m_Size)
+  {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+  if (this == &rhs)
+  {
+    return;
+  }
+
+  Lariat rest = split_at(index);
+  append(std::move(rhs));
+  append(std::move(rest));
 }
 
 //----------------------------------------------------------------------------
-/// @brief Deletes a specified node.
-/// @param node - the node to be deleted.
+/// @brief With auto merging on, merges a node that fell below a quarter of
+///        the capacity into a neighbour, if the two fit in one node. A node
+///        left underfull therefore sits next to nodes more than 3/4 full,
+///        which keeps the node count within a constant factor of n / Size.
+/// @param node - The node an element was just removed from.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::deleteNode(LNode *node)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::mergeUnderfull(LNode *node)
 {
-  // Prevent double free.
-  if (!node)
+  if (!m_AutoMerge || !node || node->count * 4 >= m_ASize)
   {
     return;
   }
 
-  // If there is a previous node.
-  if (node->next != nullptr)
+  // The node that stays and the node emptied into it.
+  LNode *keep = nullptr;
+  LNode *gone = nullptr;
+  if (node->prev && node->prev->count + node->count <= m_ASize)
   {
-    node->next->prev = node->prev;
+    keep = node->prev;
+    gone = node;
   }
-
-  // If there is a next node.
-  if (node->prev != nullptr)
+  else if (node->next && node->next->count + node->count <= m_ASize)
   {
-    node->prev->next = node->next;
+    keep = node;
+    gone = node->next;
   }
-
-  // Delete the node.
-  delete node;
+  else
+  {
+    return;
+  }
+
+  int moved = gone->count;
+  std::move(gone->values, gone->values + moved, keep->values + keep->count);
+  keep->count += moved;
+  indexUpdate(keep, moved);
+  gone->count = 0;
+  indexUpdate(gone, -moved);
+
+  if (gone == m_Tail)
+  {
+    m_Tail = keep;
+  }
+  deleteNode(gone);
+}
+
+//----------------------------------------------------------------------------
+/// @brief Splits a full node in two
+/// @param node  - The node to split.
+/// @param index - Where to split the node.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::split(LNode *node)
+{
+  // New node to split the original into.
+  LNode *split_node = addNode(node);
+
+  // Add one to the node, to account for the new value being added.
+  // Add one again to force it to round up.
+  int index = (node->count + 1 + 1) / 2;
+
+  // Move the values at and after the index to the new node.
+  for (int i = index; i < m_ASize; i++)
+  {
+    split_node->values[i - index] = std::move(node->values[i]);
+    ++split_node->count;
+  }
+
+  // Update the original node's count;
+  indexUpdate(node, index - node->count);
+  indexUpdate(split_node, split_node->count);
+  node->count = index;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Finds the node and local index of an element in the list.
+/// @param globalIndex - the global index of the element.
+/// @return The node and local index of an element in the list (std::tuple).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+std::tuple<typename Lariat<T, Size, Alloc>::LNode *, int> Lariat<T, Size, Alloc>::findElement(int globalIndex) const
+{
+  // The head links stand in for a node before m_Head.
+  LNode *current = nullptr;
+  int count = 0;
+
+  // Descend the index, skipping every run of nodes that ends at or before the global index
+  for (int level = m_IndexLevels - 1; level >= 0; --level)
+  {
+    const Link *link = linksOf(current) + level;
+    while (link->next && count + link->width <= globalIndex)
+    {
+      count += link->width;
+      current = link->next;
+      link = current->links + level;
+    }
+  }
+
+  // The difference between the global index and the tally
+  int difference = globalIndex - count;
+
+  // If the difference is within the bounds of the lariat.
+  if (current && difference >= 0)
+  {
+    return std::make_tuple(current, difference);
+  }
+
+  return std::make_tuple(nullptr, -1);
+}
+
+//----------------------------------------------------------------------------
+/// @brief Shfits the elements at and after an index up one place. The last
+///        element of a full node is overwritten, move it out first.
+/// @param node  - the node to shift.
+/// @param index - the local index of the first element to shift.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::shiftUp(LNode *node, int index)
+{
+  // Index out of bounds.
+  if (index < 0 || index > m_ASize)
+  {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  if (node)
+  {
+    // Move the values one place up, starting from the back.
+    int last = node->count < m_ASize ? node->count : m_ASize - 1;
+    if (index < last)
+    {
+      std::move_backward(node->values + index, node->values + last, node->values + last + 1);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Swaps two values
+/// @param a - the value to swap.
+/// @param b - the value to swap.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::swap(T &a, T &b)
+{
+  T temp = a;
+  a = b;
+  b = temp;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Deletes a specified node.
+/// @param node - the node to be deleted.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::deleteNode(LNode *node)
+{
+  // Prevent double free.
+  if (!node)
+  {
+    return;
+  }
+
+  // If there is a previous node.
+  if (node->next != nullptr)
+  {
+    node->next->prev = node->prev;
+  }
+
+  // If there is a next node.
+  if (node->prev != nullptr)
+  {
+    node->prev->next = node->next;
+  }
+
+  // Take the node out of the index.
+  indexUpdate(node, -node->count);
+  indexRemove(node);
+
+  // Give the node back to the allocator.
+  releaseNode(node);
   node = nullptr;
   // Update the amount of nodes in the list.
   this->m_NodeCount--;
@@ -482,8 +1051,8 @@ void Lariat<T, Size>::deleteNode(LNode *node)
 /// @param list_index - the position to insert the node at.
 /// @param value      - the value to insert int he node.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::insertNode(LNode *ptr, int list_index, T const &value)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::insertNode(LNode *ptr, int list_index, T &&value)
 {
   // Check Lariat boundaries.
   if (list_index < 0 || list_index > Size)
@@ -491,45 +1060,142 @@ void Lariat<T, Size>::insertNode(LNode *ptr, int list_index, T const &value)
     throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
   }
 
-  // If the node is full.
-  if (ptr->count == m_ASize)
+  *openSlot(ptr, list_index) = std::move(value);
+}
+
+//----------------------------------------------------------------------------
+/// @brief Makes room for one more element at a position in a node. A full node
+///        is split, the slot then ends up in either half.
+/// @param ptr        - The node.
+/// @param list_index - The position in the node.
+/// @return The slot, holding a value that left its place (T*).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+T *Lariat<T, Size, Alloc>::openSlot(LNode *ptr, int list_index)
+{
+  // Check Lariat boundaries.
+  if (list_index < 0 || list_index > Size)
   {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
 
-    T copy;
-    // Shift all elements to the right, saving the overflow.
-    const T *overflow = shiftUp(ptr, list_index);
+  // If the node is not full, shift the elements to the right.
+  if (ptr->count < m_ASize)
+  {
+    shiftUp(ptr, list_index);
+    ptr->count++;
+    indexUpdate(ptr, 1);
+    return ptr->values + list_index;
+  }
 
-    if (overflow)
+  // The node is full. Past its end the slot is the first free one of the new node.
+  if (list_index == m_ASize)
+  {
+    split(ptr);
+    LNode *next = ptr->next;
+    next->count++;
+    indexUpdate(next, 1);
+    if (ptr == m_Tail)
     {
-      copy = *overflow;
+      m_Tail = next;
     }
+    return next->values + next->count - 1;
+  }
 
-    // Insert the value.
-    ptr->values[list_index] = value;
-    // Split the node.
-    split(ptr);
+  // The last element no longer fits, it goes to the new node.
+  T overflow(std::move(ptr->values[m_ASize - 1]));
+  shiftUp(ptr, list_index);
+  split(ptr);
+  LNode *next = ptr->next;
+  next->push_back(std::move(overflow));
+  indexUpdate(next, 1);
+  if (ptr == m_Tail)
+  {
+    m_Tail = next;
+  }
+  return list_index < ptr->count ? ptr->values + list_index : next->values + (list_index - ptr->count);
+}
 
-    // If there is overflow.
-    if (overflow)
-    {
-      // Add the overflow to the new node.
-      ptr->next->push_back(copy);
-    }
+//----------------------------------------------------------------------------
+/// @brief Makes room for one more element at a global index.
+/// @param globalIndex - The index, from 0 to the size.
+/// @return The slot, holding a value that left its place (T*).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+T *Lariat<T, Size, Alloc>::openAt(int globalIndex)
+{
+  // If the list is empty.
+  if (!m_Head)
+  {
+    m_Head = addNode(nullptr);
+    m_Tail = m_Head;
+  }
 
-    // Update tail
-    if (ptr == m_Tail)
-    {
-      m_Tail = ptr->next;
-    }
+  // Index for the element inside the node.
+  int NodeIndex = 0;
+  // Node containing element.
+  LNode *node;
+  if (globalIndex == m_Size)
+  {
+    node = m_Tail;
+    NodeIndex = m_Tail->count;
   }
   else
   {
-    // Shift the elements to right.
-    shiftUp(ptr, list_index);
-    // Add the element to the node's array.
-    ptr->values[list_index] = value;
-    ptr->count++;
+    std::tie(node, NodeIndex) = findElement(globalIndex);
   }
+
+  T *slot = openSlot(node, NodeIndex);
+  m_Size++;
+  return slot;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Links a new, empty node into the list.
+/// @param after - The node it follows (nullptr for the front of the list).
+/// @return The new node (LNode*).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::LNode *Lariat<T, Size, Alloc>::addNode(LNode *after)
+{
+  LNode *node = newNode();
+  indexInsert(after, node);
+
+  // Update list.
+  node->prev = after;
+  node->next = after ? after->next : m_Head;
+  if (node->next != nullptr)
+  {
+    node->next->prev = node;
+  }
+  if (after)
+  {
+    after->next = node;
+  }
+  m_NodeCount++;
+  return node;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Takes over the nodes of another list, leaving it empty.
+/// @param rhs - The list to take from. This list must be empty.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::take(Lariat &rhs)
+{
+  m_Head = rhs.m_Head;
+  m_Tail = rhs.m_Tail;
+  m_Size = rhs.m_Size;
+  m_NodeCount = rhs.m_NodeCount;
+  m_IndexLevels = rhs.m_IndexLevels;
+  // The nodes refer to the head links as nullptr, so they can be copied.
+  std::copy(rhs.m_IndexHead, rhs.m_IndexHead + MaxLevel, m_IndexHead);
+
+  rhs.m_Head = nullptr;
+  rhs.m_Tail = nullptr;
+  rhs.m_Size = 0;
+  rhs.m_NodeCount = 0;
+  rhs.indexReset();
 }
 
 //----------------------------------------------------------------------------
@@ -537,8 +1203,8 @@ void Lariat<T, Size>::insertNode(LNode *ptr, int list_index, T const &value)
 /// @param ptr - the node to find.
 /// @return The index of the node (unsigned).
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-int Lariat<T, Size>::GetNodeIndex(LNode *ptr)
+template <typename T, int Size, template <typename> class Alloc>
+int Lariat<T, Size, Alloc>::GetNodeIndex(LNode *ptr)
 {
   int index = 0;
   LNode *current = m_Head;
@@ -562,8 +1228,8 @@ int Lariat<T, Size>::GetNodeIndex(LNode *ptr)
 /// @param index - index of the value to find
 /// @return The element at the index.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-T &Lariat<T, Size>::operator[](int index)
+template <typename T, int Size, template <typename> class Alloc>
+T &Lariat<T, Size, Alloc>::operator[](int index)
 {
   // Check for bad index.
   if (index < 0 || index > m_Size)
@@ -585,8 +1251,8 @@ T &Lariat<T, Size>::operator[](int index)
 /// @param index - index of the value to find
 /// @return The element at the index (T&).
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-T const &Lariat<T, Size>::operator[](int index) const
+template <typename T, int Size, template <typename> class Alloc>
+T const &Lariat<T, Size, Alloc>::operator[](int index) const
 {
   // Check for bad index.
   if (index < 0 || index > m_Size)
@@ -607,37 +1273,37 @@ T const &Lariat<T, Size>::operator[](int index) const
 /// @brief  Get the first element in the list
 /// @return The first element in the list
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-T &Lariat<T, Size>::first() { return m_Head->values[0]; }
+template <typename T, int Size, template <typename> class Alloc>
+T &Lariat<T, Size, Alloc>::first() { return m_Head->values[0]; }
 
 //----------------------------------------------------------------------------
 /// @brief  Get the first element in the list (const version)
 /// @return The first element in the list (const version)
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-T const &Lariat<T, Size>::first() const { return m_Head->values[0]; }
+template <typename T, int Size, template <typename> class Alloc>
+T const &Lariat<T, Size, Alloc>::first() const { return m_Head->values[0]; }
 
 //----------------------------------------------------------------------------
 /// @brief  Get the last element in the list
 /// @return The last element in the list
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-T &Lariat<T, Size>::last() { return m_Tail->values[m_ASize]; }
+template <typename T, int Size, template <typename> class Alloc>
+T &Lariat<T, Size, Alloc>::last() { return m_Tail->values[m_ASize]; }
 
 //----------------------------------------------------------------------------
 /// @brief  Get the last element in the list (const version)
 /// @return The last element in the list (const version)
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-T const &Lariat<T, Size>::last() const { return m_Tail->values[m_ASize]; }
+template <typename T, int Size, template <typename> class Alloc>
+T const &Lariat<T, Size, Alloc>::last() const { return m_Tail->values[m_ASize]; }
 
 //----------------------------------------------------------------------------
 /// @brief Assignment Operator Overload.
 /// @param rhs - Reference to a lariat instance.
 /// @return A new lariat insatnce.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-Lariat<T, Size> &Lariat<T, Size>::operator=(Lariat<T, Size> const &rhs)
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc> &Lariat<T, Size, Alloc>::operator=(Lariat<T, Size, Alloc> const &rhs)
 {
   //  Check for self assignment.
   if (this == &rhs)
@@ -647,6 +1313,7 @@ Lariat<T, Size> &Lariat<T, Size>::operator=(Lariat<T, Size> const &rhs)
 
   // Clear all data in the list
   clear();
+  m_AutoMerge = rhs.m_AutoMerge;
 
   // Copy all elements in the other lariat.
   for (int i = 0; i < rhs.m_Size; i++)
@@ -657,6 +1324,26 @@ Lariat<T, Size> &Lariat<T, Size>::operator=(Lariat<T, Size> const &rhs)
   return *this;
 }
 
+//----------------------------------------------------------------------------
+/// @brief Move assignment operator.
+/// @param rhs - The lariat to take the nodes from, left empty.
+/// @return A reference to this lariat.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc> &Lariat<T, Size, Alloc>::operator=(Lariat<T, Size, Alloc> &&rhs)
+{
+  //  Check for self assignment.
+  if (this == &rhs)
+  {
+    return *this;
+  }
+
+  clear();
+  m_AutoMerge = rhs.m_AutoMerge;
+  take(rhs);
+  return *this;
+}
+
 //----------------------------------------------------------------------------
 /// @brief Assignment operator overload.
 /// @tparam T     - The type of data being stored in the data structure.
@@ -664,11 +1351,11 @@ Lariat<T, Size> &Lariat<T, Size>::operator=(Lariat<T, Size> const &rhs)
 /// @tparam T2    - The type of data being stored in the other Lariat.
 /// @tparam Size2 - Logical size of the arrays within the nodes of the other Lariat.
 /// @param rhs    - Reference to another Lariat of a different type and size.
-/// @return a reference to a Lariat<T, Size>.
+/// @return a reference to a Lariat<T, Size, Alloc>.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-template <typename T2, int Size2>
-Lariat<T, Size> &Lariat<T, Size>::operator=(Lariat<T2, Size2> const &rhs)
+template <typename T, int Size, template <typename> class Alloc>
+template <typename T2, int Size2, template <typename> class Alloc2>
+Lariat<T, Size, Alloc> &Lariat<T, Size, Alloc>::operator=(Lariat<T2, Size2, Alloc2> const &rhs)
 {
 
   // Clear all data in the list
@@ -687,28 +1374,206 @@ Lariat<T, Size> &Lariat<T, Size>::operator=(Lariat<T2, Size2> const &rhs)
 /// @brief Finds the index of an element in the list
 /// @return The index of an element in the list or the amount of elements if not found
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-unsigned Lariat<T, Size>::find(const T &value) const
+template <typename T, int Size, template <typename> class Alloc>
+unsigned Lariat<T, Size, Alloc>::find(const T &value) const
 {
-  LNode *node = m_Head;
-  int index = 0;
-  // Traverse the list.
-  while (node != m_Tail->next)
+  unsigned index = 0;
+  // Traverse the list, scanning each node's array at once.
+  for (LNode *node = m_Head; node; node = node->next)
+  {
+    int local = LariatScan<T>::find(node->values, node->count, value);
+    // If the value is found, return the index
+    if (local < node->count)
+    {
+      return index + static_cast<unsigned>(local);
+    }
+    index += static_cast<unsigned>(node->count);
+  }
+  // If not found return the amount elements in the lariat.
+  return static_cast<unsigned>(m_Size);
+}
+
+//----------------------------------------------------------------------------
+/// @brief Counts the elements equal to a value
+/// @return The number of elements equal to the value
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+unsigned Lariat<T, Size, Alloc>::count(const T &value) const
+{
+  unsigned total = 0;
+  for (LNode *node = m_Head; node; node = node->next)
+  {
+    total += static_cast<unsigned>(LariatScan<T>::count(node->values, node->count, value));
+  }
+  return total;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Finds where a value goes in a sorted list. The index is descended
+///        comparing the value with the first element of each node, which
+///        finds the last node that starts before it. Empty nodes have no first
+///        element, they are only stepped over on the bottom level.
+/// @param value - The value to look for.
+/// @param upper - false for the first element not less than value (lower
+///                bound), true for the first element greater than it (upper bound).
+/// @return The node, the local index and the global index (std::tuple). The
+///         node is nullptr when the position is the front of the list.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+std::tuple<typename Lariat<T, Size, Alloc>::LNode *, int, int> Lariat<T, Size, Alloc>::findSorted(const T &value,
+                                                                                                   bool upper) const
+{
+  // Current position in the descent (nullptr is the head links) and its global index.
+  LNode *current = nullptr;
+  int count = 0;
+  // Last non-empty node that starts before the value.
+  LNode *best = nullptr;
+  int bestIndex = 0;
+
+  for (int level = m_IndexLevels - 1; level >= 0; --level)
   {
-    // Search the node's array
-    for (int i = 0; i < node->count; i++)
+    const Link *link = linksOf(current) + level;
+    while (link->next)
     {
-      // If the value is found, return the index
-      if (node->values[i] == value)
+      LNode *next = link->next;
+      if (next->count == 0)
       {
-        return index;
+        // Nothing to compare with, only the bottom level may step over it.
+        if (level > 0)
+        {
+          break;
+        }
       }
-      index++;
+      else if (upper ? value < next->values[0] : !(next->values[0] < value))
+      {
+        break;
+      }
+      else
+      {
+        best = next;
+        bestIndex = count + link->width;
+      }
+      count += link->width;
+      current = next;
+      link = current->links + level;
     }
-    node = node->next;
   }
-  // If not found return the amount elements in the lariat.
-  return m_Size;
+
+  if (!best)
+  {
+    return std::make_tuple(nullptr, 0, 0);
+  }
+
+  // Binary search in the node.
+  const T *first = best->values;
+  const T *last = best->values + best->count;
+  const T *found = upper ? std::upper_bound(first, last, value) : std::lower_bound(first, last, value);
+  int local = static_cast<int>(found - first);
+  return std::make_tuple(best, local, bestIndex + local);
+}
+
+//----------------------------------------------------------------------------
+/// @brief First element not less than a value (sorted mode).
+/// @param value - The value to look for.
+/// @return Iterator to the element, end() if there is none.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::iterator Lariat<T, Size, Alloc>::lower_bound(const T &value)
+{
+  LNode *node;
+  int local, index;
+  std::tie(node, local, index) = findSorted(value, false);
+  return node ? iterator(this, node, local, index) : begin();
+}
+
+//----------------------------------------------------------------------------
+/// @brief First element not less than a value (sorted mode, const version).
+/// @param value - The value to look for.
+/// @return Iterator to the element, end() if there is none.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::const_iterator Lariat<T, Size, Alloc>::lower_bound(const T &value) const
+{
+  LNode *node;
+  int local, index;
+  std::tie(node, local, index) = findSorted(value, false);
+  return node ? const_iterator(this, node, local, index) : begin();
+}
+
+//----------------------------------------------------------------------------
+/// @brief First element greater than a value (sorted mode).
+/// @param value - The value to look for.
+/// @return Iterator to the element, end() if there is none.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::iterator Lariat<T, Size, Alloc>::upper_bound(const T &value)
+{
+  LNode *node;
+  int local, index;
+  std::tie(node, local, index) = findSorted(value, true);
+  return node ? iterator(this, node, local, index) : begin();
+}
+
+//----------------------------------------------------------------------------
+/// @brief First element greater than a value (sorted mode, const version).
+/// @param value - The value to look for.
+/// @return Iterator to the element, end() if there is none.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::const_iterator Lariat<T, Size, Alloc>::upper_bound(const T &value) const
+{
+  LNode *node;
+  int local, index;
+  std::tie(node, local, index) = findSorted(value, true);
+  return node ? const_iterator(this, node, local, index) : begin();
+}
+
+//----------------------------------------------------------------------------
+/// @brief Checks for a value (sorted mode).
+/// @param value - The value to look for.
+/// @return Whether an equivalent element is in the list (bool).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+bool Lariat<T, Size, Alloc>::contains(const T &value) const
+{
+  const_iterator it = lower_bound(value);
+  return it != end() && !(value < *it);
+}
+
+//----------------------------------------------------------------------------
+/// @brief Inserts a value after the elements not greater than it (sorted mode).
+/// @param value - The value to insert.
+/// @return Iterator to the inserted element.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::iterator Lariat<T, Size, Alloc>::insert_sorted(T const &value)
+{
+  return insert_sorted(T(value));
+}
+
+//----------------------------------------------------------------------------
+/// @brief Moves a value in after the elements not greater than it (sorted mode).
+///        A full node splits the same way as for insert.
+/// @param value - The value to insert.
+/// @return Iterator to the inserted element.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::iterator Lariat<T, Size, Alloc>::insert_sorted(T &&value)
+{
+  LNode *node;
+  int local, index;
+  std::tie(node, local, index) = findSorted(value, true);
+
+  // Smaller than everything (or the list is empty).
+  if (!node)
+  {
+    push_front(std::move(value));
+    return begin();
+  }
+
+  insertNode(node, local, std::move(value));
+  m_Size++;
+  return begin() + index;
 }
 
 //----------------------------------------------------------------------------
@@ -717,9 +1582,9 @@ unsigned Lariat<T, Size>::find(const T &value) const
 /// @tparam Size - Logical size of the arrays within each node.
 /// @param rhs   - A reference to an instance of the Lariat class.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-Lariat<T, Size>::Lariat(Lariat const &rhs)
-    : m_Head(nullptr), m_Tail(nullptr), m_Size(0), m_NodeCount(0), m_ASize(Size)
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc>::Lariat(Lariat const &rhs)
+    : m_Head(nullptr), m_Tail(nullptr), m_Size(0), m_NodeCount(0), m_ASize(Size), m_AutoMerge(rhs.m_AutoMerge)
 {
   // Copy all elements in the other lariat.
   for (int i = 0; i < rhs.m_Size; i++)
@@ -728,6 +1593,17 @@ Lariat<T, Size>::Lariat(Lariat const &rhs)
   }
 }
 
+//----------------------------------------------------------------------------
+/// @brief Move Constructor for the Lariat class
+/// @param rhs - The lariat to take the nodes from, left empty.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc>::Lariat(Lariat &&rhs)
+    : m_Head(nullptr), m_Tail(nullptr), m_Size(0), m_NodeCount(0), m_ASize(Size), m_AutoMerge(rhs.m_AutoMerge)
+{
+  take(rhs);
+}
+
 //-------------------------------------------------------------------------------------
 /// @brief A copy constructor for Lariats of differen types and sizes.
 /// @tparam T      - The type of data being stored in the data structure.
@@ -736,9 +1612,9 @@ Lariat<T, Size>::Lariat(Lariat const &rhs)
 /// @tparam Length - Logical size of the arrays within each node of the reference.
 /// @param rhs     - Reference to an instance of the Lariat class.
 //-------------------------------------------------------------------------------------
-template <typename T, int Size>
-template <typename T2, int Size2>
-Lariat<T, Size>::Lariat(Lariat<T2, Size2> const &rhs)
+template <typename T, int Size, template <typename> class Alloc>
+template <typename T2, int Size2, template <typename> class Alloc2>
+Lariat<T, Size, Alloc>::Lariat(Lariat<T2, Size2, Alloc2> const &rhs)
     : m_Head(nullptr), m_Tail(nullptr), m_Size(0), m_NodeCount(0), m_ASize(Size)
 {
   // Copy all elements from the other lariat.
@@ -753,8 +1629,8 @@ Lariat<T, Size>::Lariat(Lariat<T2, Size2> const &rhs)
 /// @tparam T    - The type of data being stored in the data structure.
 /// @tparam Size - Logical size of the arrays within each node.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-Lariat<T, Size>::~Lariat()
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc>::~Lariat()
 {
   // Delete all the data used in the linked list.
   clear();
@@ -765,8 +1641,19 @@ Lariat<T, Size>::~Lariat()
 /// @param index - The global index of the element
 /// @param value - The value to insert
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-void Lariat<T, Size>::insert(int globalIndex, T const &value)
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::insert(int globalIndex, T const &value)
+{
+  insert(globalIndex, T(value));
+}
+
+//----------------------------------------------------------------------------
+/// @brief Moves a value into the list at a specific index
+/// @param index - The global index of the element
+/// @param value - The value to insert
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::insert(int globalIndex, T &&value)
 {
   // If the index is out of range, throw an exception.
   if (globalIndex < 0 || globalIndex > m_Size)
@@ -777,14 +1664,14 @@ void Lariat<T, Size>::insert(int globalIndex, T const &value)
   // If the index is 0, push the value to the front
   if (globalIndex == 0)
   {
-    push_front(value);
+    push_front(std::move(value));
     return;
   }
 
   // If the index is the size, push the value to the back
   if (globalIndex == m_Size)
   {
-    push_back(value);
+    push_back(std::move(value));
     return;
   }
 
@@ -796,26 +1683,524 @@ void Lariat<T, Size>::insert(int globalIndex, T const &value)
   std::tie(node, NodeIndex) = findElement(globalIndex);
 
   // Insert a new node containing this value.
-  insertNode(node, NodeIndex, value);
+  insertNode(node, NodeIndex, std::move(value));
   // Increment number of elements in the list.
   m_Size++;
 }
 
+//----------------------------------------------------------------------------
+/// @brief Constructs a value in the list at a specific index
+/// @param index - The global index of the element
+/// @param args  - Arguments for the constructor of T.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+template <typename... Args>
+void Lariat<T, Size, Alloc>::emplace(int globalIndex, Args &&...args)
+{
+  // If the index is out of range, throw an exception.
+  if (globalIndex < 0 || globalIndex > m_Size)
+  {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  // The slot holds a value that left its place, it is replaced by the new one.
+  T *slot = openAt(globalIndex);
+  slot->~T();
+  try
+  {
+    ::new (static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    // Put a value back in the slot and take it out of the list again.
+    ::new (static_cast<void *>(slot)) T();
+    erase(globalIndex);
+    throw;
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Inserts a range of values at a specific index. The values fill the
+///        node at the index, then whole new nodes, instead of being inserted
+///        one at a time.
+/// @param index - The global index of the first value
+/// @param first - Start of the range
+/// @param last  - End of the range
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+template <typename InputIt>
+void Lariat<T, Size, Alloc>::insert(int globalIndex, InputIt first, InputIt last)
+{
+  // If the index is out of range, throw an exception.
+  if (globalIndex < 0 || globalIndex > m_Size)
+  {
+    throw LariatException(LariatException::E_BAD_INDEX, "Subscript is out of range");
+  }
+
+  if (first == last)
+  {
+    return;
+  }
+
+  // The node being filled.
+  LNode *node = nullptr;
+
+  if (!m_Head)
+  {
+    // Empty list, start the first node.
+    m_Head = addNode(nullptr);
+    m_Tail = m_Head;
+    node = m_Head;
+  }
+  else if (globalIndex == m_Size)
+  {
+    // Append, continue filling the tail.
+    node = m_Tail;
+  }
+  else
+  {
+    // Move the elements at and after the index to a node of their own, the
+    // new values go in between.
+    int NodeIndex = 0;
+    std::tie(node, NodeIndex) = findElement(globalIndex);
+
+    LNode *rest = addNode(node);
+    int moved = node->count - NodeIndex;
+    std::move(node->values + NodeIndex, node->values + node->count, rest->values);
+    rest->count = moved;
+    indexUpdate(rest, moved);
+    node->count = NodeIndex;
+    indexUpdate(node, -moved);
+
+    if (node == m_Tail)
+    {
+      m_Tail = rest;
+    }
+  }
+
+  // Values added to the current node, the index is updated once per node.
+  int added = 0;
+  for (; first != last; ++first)
+  {
+    if (node->count == m_ASize)
+    {
+      indexUpdate(node, added);
+      m_Size += added;
+      added = 0;
+
+      LNode *next = addNode(node);
+      if (node == m_Tail)
+      {
+        m_Tail = next;
+      }
+      node = next;
+    }
+
+    node->values[node->count++] = *first;
+    ++added;
+  }
+
+  indexUpdate(node, added);
+  m_Size += added;
+}
+
 //----------------------------------------------------------------------------
 /// @brief Constructor for the Lariat class
 /// @tparam T    - The type of data being stored in the data structure.
 /// @tparam Size - Logical size of the arrays within each node.
 //----------------------------------------------------------------------------
-template <typename T, int Size>
-Lariat<T, Size>::Lariat()
+template <typename T, int Size, template <typename> class Alloc>
+Lariat<T, Size, Alloc>::Lariat()
     : m_Head(nullptr), m_Tail(nullptr), m_Size(0), m_NodeCount(0), m_ASize(Size)
 {
 }
 
-template <typename T, int Size>
-std::ostream &operator<<(std::ostream &os, Lariat<T, Size> const &list)
+//----------------------------------------------------------------------------
+/// @brief Allocates an empty node with a random number of index levels.
+/// @return The new node (LNode*).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::LNode *Lariat<T, Size, Alloc>::newNode()
+{
+  LNode *node = m_Alloc.allocate();
+
+  if (!node->links)
+  {
+    // A brand new node.
+    pickLevels(node);
+  }
+  else
+  {
+    // A recycled node keeps its levels and links.
+    std::fill(node->links, node->links + node->levels, Link());
+  }
+  node->prev = nullptr;
+  node->next = nullptr;
+  node->count = 0;
+
+  indexRaise(node->levels);
+  return node;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Gives a node without index links a random number of levels.
+///        xorshift32, each extra level has a 1 in 4 chance.
+/// @param node - The node.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::pickLevels(LNode *node)
+{
+  m_IndexSeed ^= m_IndexSeed << 13;
+  m_IndexSeed ^= m_IndexSeed >> 17;
+  m_IndexSeed ^= m_IndexSeed << 5;
+
+  int levels = 1;
+  for (unsigned bits = m_IndexSeed; (bits & 3u) == 0 && levels < MaxLevel; bits >>= 2)
+  {
+    ++levels;
+  }
+  node->levels = levels;
+  node->links = new Link[levels]();
+}
+
+//----------------------------------------------------------------------------
+/// @brief Gives a node back to the allocator. Its values are reset first, so
+///        a pooled node does not keep what they own (memory, shared_ptr
+///        counts...) alive.
+/// @param node - The node, no longer in the list.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::releaseNode(LNode *node)
+{
+  resetValues(node->values, node->values + Size);
+  m_Alloc.deallocate(node);
+}
+
+//----------------------------------------------------------------------------
+/// @brief Replaces values that are no longer in the list with T().
+///        Nothing to do for types without a destructor.
+/// @param first - The first value.
+/// @param last  - One past the last value.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::resetValues(T *first, T *last)
+{
+  if (std::is_trivially_destructible<T>::value)
+  {
+    return;
+  }
+  for (; first != last; ++first)
+  {
+    *first = T();
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Index links of a node.
+/// @param node - The node, nullptr for the head links.
+/// @return The links of the node (Link*).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+typename Lariat<T, Size, Alloc>::Link *Lariat<T, Size, Alloc>::linksOf(LNode *node)
+{
+  return node ? node->links : m_IndexHead;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Index links of a node (const version).
+/// @param node - The node, nullptr for the head links.
+/// @return The links of the node (const Link*).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+const typename Lariat<T, Size, Alloc>::Link *Lariat<T, Size, Alloc>::linksOf(LNode *node) const
+{
+  return node ? node->links : m_IndexHead;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Adds an empty node to the index.
+/// @param after - The node it follows in the list (nullptr for the front).
+/// @param node  - The new node, with a count of 0.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexInsert(LNode *after, LNode *node)
+{
+  // The node whose link spans the new position, and the number of elements
+  // and nodes from it (inclusive) up to the new position.
+  LNode *owner = after;
+  int distance = after ? after->count : 0;
+  int nodes = after ? 1 : 0;
+
+  for (int level = 0; level < m_IndexLevels; ++level)
+  {
+    // Step back to the closest node that reaches this level.
+    while (owner && owner->levels <= level)
+    {
+      owner = owner->links[level - 1].prev;
+      distance += linksOf(owner)[level - 1].width;
+      nodes += linksOf(owner)[level - 1].nodes;
+    }
+
+    Link &link = linksOf(owner)[level];
+    if (level >= node->levels)
+    {
+      // The link passes over the new node.
+      link.nodes++;
+      continue;
+    }
+
+    // Split the owner's link around the new node.
+    Link &mine = node->links[level];
+    mine.next = link.next;
+    mine.prev = owner;
+    mine.width = link.width - distance;
+    mine.nodes = link.nodes - nodes + 1;
+    if (link.next)
+    {
+      link.next->links[level].prev = node;
+    }
+    link.next = node;
+    link.width = distance;
+    link.nodes = nodes;
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Takes an empty node out of the index.
+/// @param node - The node to remove, with a count of 0.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexRemove(LNode *node)
+{
+  // Links above the node's levels pass over it.
+  LNode *owner = node;
+  for (int level = node->levels; level < m_IndexLevels; ++level)
+  {
+    while (owner && owner->levels <= level)
+    {
+      owner = owner->links[level - 1].prev;
+    }
+    linksOf(owner)[level].nodes--;
+  }
+
+  for (int level = 0; level < node->levels; ++level)
+  {
+    Link &mine = node->links[level];
+    Link &before = linksOf(mine.prev)[level];
+
+    // The link before now covers what this node's link covered.
+    before.next = mine.next;
+    before.width += mine.width;
+    before.nodes += mine.nodes - 1;
+    if (mine.next)
+    {
+      mine.next->links[level].prev = mine.prev;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Cuts the index after a node, the part after it goes to another list.
+/// @param last - The last node that stays in this list.
+/// @param rest - The list that takes the nodes after last (its index is replaced).
+/// @return The number of nodes that stay in this list (int).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+int Lariat<T, Size, Alloc>::indexCut(LNode *last, Lariat &rest)
+{
+  LNode *owner = last;
+  int distance = last->count;
+  int nodes = 1;
+
+  for (int level = 0; level < m_IndexLevels; ++level)
+  {
+    // Step back to the closest node that reaches this level.
+    while (owner && owner->levels <= level)
+    {
+      owner = owner->links[level - 1].prev;
+      distance += linksOf(owner)[level - 1].width;
+      nodes += linksOf(owner)[level - 1].nodes;
+    }
+
+    // The part of the link after the cut becomes the head link of rest.
+    Link &link = linksOf(owner)[level];
+    Link &head = rest.m_IndexHead[level];
+    head.next = link.next;
+    head.prev = nullptr;
+    head.width = link.width - distance;
+    head.nodes = link.nodes - nodes;
+    if (link.next)
+    {
+      link.next->links[level].prev = nullptr;
+    }
+    link.next = nullptr;
+    link.width = distance;
+    link.nodes = nodes;
+  }
+  rest.m_IndexLevels = m_IndexLevels;
+
+  // Nodes before the owner on the top level.
+  while (owner)
+  {
+    owner = owner->links[m_IndexLevels - 1].prev;
+    nodes += linksOf(owner)[m_IndexLevels - 1].nodes;
+  }
+  return nodes;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Joins the index of another list after the tail of this one.
+/// @param rhs - The list whose nodes follow m_Tail (its index is cleared).
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexJoin(Lariat &rhs)
+{
+  // Both indexes need the same levels before they can be joined.
+  int levels = std::max(m_IndexLevels, rhs.m_IndexLevels);
+  indexRaise(levels);
+  rhs.indexRaise(levels);
+
+  LNode *owner = m_Tail;
+  for (int level = 0; level < levels; ++level)
+  {
+    // Step back to the last node that reaches this level.
+    while (owner && owner->levels <= level)
+    {
+      owner = owner->links[level - 1].prev;
+    }
+
+    // The link ran to the end of this list, now it runs into rhs.
+    Link &link = linksOf(owner)[level];
+    Link &head = rhs.m_IndexHead[level];
+    link.next = head.next;
+    link.width += head.width;
+    link.nodes += head.nodes;
+    if (head.next)
+    {
+      head.next->links[level].prev = owner;
+    }
+  }
+
+  rhs.indexReset();
+}
+
+//----------------------------------------------------------------------------
+/// @brief Records a change in a node's count in every link that spans it.
+/// @param node  - The node whose count changed.
+/// @param delta - The change.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexUpdate(LNode *node, int delta)
+{
+  if (delta == 0)
+  {
+    return;
+  }
+
+  LNode *owner = node;
+  for (int level = 0; level < m_IndexLevels; ++level)
+  {
+    // Step back to the closest node that reaches this level.
+    while (owner && owner->levels <= level)
+    {
+      owner = owner->links[level - 1].prev;
+    }
+    linksOf(owner)[level].width += delta;
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Recomputes every width of the index from the node counts.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexRebuild()
+{
+  // Last node seen on each level and the elements and nodes counted since.
+  LNode *last[MaxLevel] = {};
+  int widths[MaxLevel] = {};
+  int nodes[MaxLevel] = {};
+
+  for (LNode *node = m_Head; node; node = node->next)
+  {
+    for (int level = 0; level < node->levels; ++level)
+    {
+      linksOf(last[level])[level].width = widths[level];
+      linksOf(last[level])[level].nodes = nodes[level];
+      last[level] = node;
+      widths[level] = 0;
+      nodes[level] = 0;
+    }
+    for (int level = 0; level < m_IndexLevels; ++level)
+    {
+      widths[level] += node->count;
+      nodes[level]++;
+    }
+  }
+
+  for (int level = 0; level < m_IndexLevels; ++level)
+  {
+    linksOf(last[level])[level].width = widths[level];
+    linksOf(last[level])[level].nodes = nodes[level];
+  }
+}
+
+//----------------------------------------------------------------------------
+/// @brief Brings more levels into use. Links are only kept up to date on the
+///        levels in use, so a new level starts as one head link over the
+///        whole list (the totals of the current top level).
+/// @param levels - Number of levels needed.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexRaise(int levels)
+{
+  if (levels <= m_IndexLevels)
+  {
+    return;
+  }
+
+  int top = m_IndexLevels - 1;
+  int width = 0;
+  int nodes = 0;
+  for (const Link *link = m_IndexHead + top; ; link = link->next->links + top)
+  {
+    width += link->width;
+    nodes += link->nodes;
+    if (!link->next)
+    {
+      break;
+    }
+  }
+
+  for (int level = m_IndexLevels; level < levels; ++level)
+  {
+    m_IndexHead[level].next = nullptr;
+    m_IndexHead[level].prev = nullptr;
+    m_IndexHead[level].width = width;
+    m_IndexHead[level].nodes = nodes;
+  }
+  m_IndexLevels = levels;
+}
+
+//----------------------------------------------------------------------------
+/// @brief Clears the head links of the index.
+//----------------------------------------------------------------------------
+template <typename T, int Size, template <typename> class Alloc>
+void Lariat<T, Size, Alloc>::indexReset()
+{
+  for (Link &link : m_IndexHead)
+  {
+    link.next = nullptr;
+    link.prev = nullptr;
+    link.width = 0;
+    link.nodes = 0;
+  }
+  m_IndexLevels = 1;
+}
+
+template <typename T, int Size, template <typename> class Alloc>
+std::ostream &operator<<(std::ostream &os, Lariat<T, Size, Alloc> const &list)
 {
-  typename Lariat<T, Size>::LNode *current = list.m_Head;
+  typename Lariat<T, Size, Alloc>::LNode *current = list.m_Head;
   int index = 0;
   while (current)
   {
@@ -14,6 +14,12 @@
 #include <string>  // error strings
 #include <utility> // error strings
 #include <cstring> // memcpy
+#include <algorithm> // std::move, std::move_backward
+#include <tuple>     // std::tuple, std::tie
+#include <iterator>  // std::random_access_iterator_tag
+#include <type_traits>
+#include <cstddef>   // std::ptrdiff_t
+#include <new>       // placement new
 #include <iostream>
 
 class LariatException : public std::exception
@@ -35,23 +41,242 @@ public:
 };
 
 
-template<typename T, int Size>
+/// @brief Default node allocator of the Lariat. Released nodes are kept on a
+///        free list (linked through their next pointers) and handed out again
+///        before any new node is allocated.
+/// @tparam Node - the node type, needs a default constructor and a next pointer.
+template<typename Node>
+class LariatNodePool
+{
+public:
+  LariatNodePool() {}
+  // A copy starts with an empty free list.
+  LariatNodePool(LariatNodePool const&) {}
+  LariatNodePool& operator=(LariatNodePool const&) { return *this; }
+  ~LariatNodePool();
+
+  // A node from the free list, or a new one. Recycled nodes keep their index
+  // links, the Lariat resets their values before handing them back.
+  Node* allocate();
+  // Puts a node on the free list.
+  void deallocate(Node* node);
+  // Makes sure at least count nodes are on the free list.
+  void reserve(size_t count);
+  // Number of nodes on the free list.
+  size_t available() const { return m_Available; }
+
+private:
+  Node* m_Free = nullptr;
+  size_t m_Available = 0;
+};
+
+/// @brief Node allocator without pooling, every node goes through new/delete.
+/// @tparam Node - the node type.
+template<typename Node>
+struct LariatNewDelete
+{
+  Node* allocate() { return new Node(); }
+  void deallocate(Node* node) { delete node; }
+  void reserve(size_t) {}
+  size_t available() const { return 0; }
+};
+
+/// @brief Searching a node's array for a value, used by Lariat::find and count.
+///        Compares with operator== one element at a time.
+/// @tparam T - the data type of the lariat.
+template<typename T, bool Arithmetic = std::is_arithmetic<T>::value>
+struct LariatScan
+{
+  // Position of the first match in values[0, count), count if there is none.
+  static int find(const T* values, int count, const T& value);
+  // Number of matches in values[0, count).
+  static int count(const T* values, int count, const T& value);
+};
+
+/// @brief Arithmetic types are compared a block at a time without branches,
+///        which the compiler turns into vector compares.
+template<typename T>
+struct LariatScan<T, true>
+{
+  static int find(const T* values, int count, const T& value);
+  static int count(const T* values, int count, const T& value);
+};
+
+#if defined(__SSE2__)
+/// @brief SSE2 compares, four elements per instruction.
+template<>
+struct LariatScan<int, true>
+{
+  static int find(const int* values, int count, const int& value);
+  static int count(const int* values, int count, const int& value);
+};
+
+template<>
+struct LariatScan<float, true>
+{
+  static int find(const float* values, int count, const float& value);
+  static int count(const float* values, int count, const float& value);
+};
+#endif
+
+template<typename T, int Size, template<typename> class Alloc = LariatNodePool>
 class Lariat;
 
-template<typename T, int Size>
-std::ostream& operator<<(std::ostream& os, Lariat<T, Size> const& rhs);
+/// @brief Node capacity that makes a node's array fill a byte budget.
+/// @tparam T     - the data type of the lariat.
+/// @tparam Bytes - the byte budget of the array in a node (256 B, 4 KB...).
+template<typename T, int Bytes>
+struct LariatCapacity
+{
+  static const int value = Bytes / static_cast<int>(sizeof(T)) > 0 ? Bytes / static_cast<int>(sizeof(T)) : 1;
+};
+
+/// @brief A Lariat whose node capacity comes from a byte budget instead of a
+///        fixed element count, e.g. LariatBytes<std::string, 256>.
+template<typename T, int Bytes = 4096, template<typename> class Alloc = LariatNodePool>
+using LariatBytes = Lariat<T, LariatCapacity<T, Bytes>::value, Alloc>;
+
+template<typename T, int Size, template<typename> class Alloc>
+std::ostream& operator<<(std::ostream& os, Lariat<T, Size, Alloc> const& rhs);
 
 /// @brief Linked List of Arrays Class
 /// @tparam T - the data type of the lariat.
 /// @tparam Size - the logical size of the each array in a node.
-template<typename T, int Size>
+/// @tparam Alloc - the node allocator (LariatNodePool or LariatNewDelete).
+template<typename T, int Size, template<typename> class Alloc>
 class Lariat
 {
 public:
 
-  template<typename T3, int Size3>
+  template<typename T3, int Size3, template<typename> class Alloc3>
   friend class Lariat;
 
+private:
+  struct LNode;
+
+public:
+  /// @brief Bidirectional iterator over the elements, holding the node and the
+  ///        local index. It also keeps the global index, so random access
+  ///        jumps out of the node go through the node index.
+  /// @tparam V - T or const T.
+  template<typename V>
+  class Iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef V* pointer;
+    typedef V& reference;
+
+    Iterator() : m_List(nullptr), m_Node(nullptr), m_Local(0), m_Index(0) {}
+    // Copy, or iterator to const_iterator.
+    Iterator(Iterator<T> const& rhs)
+        : m_List(rhs.m_List), m_Node(rhs.m_Node), m_Local(rhs.m_Local), m_Index(rhs.m_Index) {}
+    Iterator& operator=(Iterator const& rhs) = default;
+
+    reference operator*() const { return m_Node->values[m_Local]; }
+    pointer operator->() const { return &m_Node->values[m_Local]; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    Iterator& operator++()
+    {
+      ++m_Index;
+      ++m_Local;
+      skipEmpty();
+      return *this;
+    }
+    Iterator operator++(int) { Iterator old(*this); ++*this; return old; }
+
+    Iterator& operator--()
+    {
+      --m_Index;
+      // From end(), start at the back of the tail.
+      if (!m_Node)
+      {
+        m_Node = m_List->m_Tail;
+        m_Local = m_Node->count;
+      }
+      while (m_Local == 0)
+      {
+        m_Node = m_Node->prev;
+        m_Local = m_Node->count;
+      }
+      --m_Local;
+      return *this;
+    }
+    Iterator operator--(int) { Iterator old(*this); --*this; return old; }
+
+    Iterator& operator+=(difference_type n)
+    {
+      int index = m_Index + static_cast<int>(n);
+      if (m_Node && m_Local + n >= 0 && m_Local + n < m_Node->count)
+      {
+        // Still in the same node.
+        m_Local += static_cast<int>(n);
+      }
+      else if (index >= m_List->m_Size)
+      {
+        m_Node = nullptr;
+        m_Local = 0;
+      }
+      else
+      {
+        std::tie(m_Node, m_Local) = m_List->findElement(index);
+      }
+      m_Index = index;
+      return *this;
+    }
+    Iterator& operator-=(difference_type n) { return *this += -n; }
+    Iterator operator+(difference_type n) const { Iterator it(*this); return it += n; }
+    Iterator operator-(difference_type n) const { Iterator it(*this); return it += -n; }
+    friend Iterator operator+(difference_type n, Iterator const& it) { return it + n; }
+    difference_type operator-(Iterator const& rhs) const { return m_Index - rhs.m_Index; }
+
+    bool operator==(Iterator const& rhs) const { return m_Index == rhs.m_Index; }
+    bool operator!=(Iterator const& rhs) const { return m_Index != rhs.m_Index; }
+    bool operator<(Iterator const& rhs) const { return m_Index < rhs.m_Index; }
+    bool operator>(Iterator const& rhs) const { return m_Index > rhs.m_Index; }
+    bool operator<=(Iterator const& rhs) const { return m_Index <= rhs.m_Index; }
+    bool operator>=(Iterator const& rhs) const { return m_Index >= rhs.m_Index; }
+
+  private:
+    friend class Lariat;
+    template<typename W>
+    friend class Iterator;
+
+    Iterator(Lariat const* list, LNode* node, int local, int index)
+        : m_List(list), m_Node(node), m_Local(local), m_Index(index)
+    {
+      skipEmpty();
+    }
+
+    // Moves past the end of the node (and any empty nodes), to end() after the tail.
+    void skipEmpty()
+    {
+      while (m_Node && m_Local >= m_Node->count)
+      {
+        m_Node = m_Node->next;
+        m_Local = 0;
+      }
+    }
+
+    Lariat const* m_List; // The list, for jumps and for stepping back from end()
+    LNode* m_Node;        // Node of the element, nullptr at end()
+    int m_Local;          // Index in the node
+    int m_Index;          // Global index
+  };
+
+  typedef Iterator<T> iterator;
+  typedef Iterator<const T> const_iterator;
+
+  iterator begin() { return iterator(this, m_Head, 0, 0); }
+  iterator end() { return iterator(this, nullptr, 0, m_Size); }
+  const_iterator begin() const { return const_iterator(this, m_Head, 0, 0); }
+  const_iterator end() const { return const_iterator(this, nullptr, 0, m_Size); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
 
   // Default constructor
   Lariat();
@@ -59,8 +284,11 @@ public:
   // Copy constructor
   Lariat(Lariat const& rhs);
   // template copy constructor
-  template<typename T2, int Size2>
-  Lariat(Lariat<T2, Size2> const& rhs);
+  template<typename T2, int Size2, template<typename> class Alloc2>
+  Lariat(Lariat<T2, Size2, Alloc2> const& rhs);
+
+  // Move constructor
+  Lariat(Lariat&& rhs);
 
   // Destructor
   ~Lariat();
@@ -69,8 +297,22 @@ public:
 
   // Inserts
   void insert(int index, T const& value);
+  void insert(int index, T&& value);
   void push_back(T const& value);
+  void push_back(T&& value);
   void push_front(T const& value);
+  void push_front(T&& value);
+
+  // Makes room at the index and constructs the value there from args. T is
+  // still moved when later inserts and erases shift the elements.
+  template<typename... Args>
+  void emplace(int index, Args&&... args);
+  template<typename... Args>
+  void emplace_back(Args&&... args);
+
+  // Inserts a range, filling whole nodes directly.
+  template<typename InputIt>
+  void insert(int index, InputIt first, InputIt last);
  
   // Erases
   void erase(int index);
@@ -87,29 +329,77 @@ public:
 
   // Assignment
   Lariat& operator=(Lariat const& rhs);
+  Lariat& operator=(Lariat&& rhs);
   
   // template assignment operator.
-  template<typename T2, int Size2>
-  Lariat& operator=(Lariat<T2, Size2> const& rhs);
+  template<typename T2, int Size2, template<typename> class Alloc2>
+  Lariat& operator=(Lariat<T2, Size2, Alloc2> const& rhs);
 
   unsigned find(const T& value) const;
+  // Number of elements equal to value.
+  unsigned count(const T& value) const;
+
+  // Sorted mode: a list filled only through insert_sorted stays in ascending
+  // order (operator<). The searches descend the node index comparing the
+  // first element of each node, then binary search inside one node.
+  iterator lower_bound(const T& value);
+  const_iterator lower_bound(const T& value) const;
+  iterator upper_bound(const T& value);
+  const_iterator upper_bound(const T& value) const;
+  bool contains(const T& value) const;
+  iterator insert_sorted(T const& value);
+  iterator insert_sorted(T&& value);
 
   friend std::ostream& operator<< <>(std::ostream& os, Lariat const& list);
 
   size_t size() const { return m_Size; }
+  // Number of nodes and the bytes each one takes (without its index links).
+  size_t node_count() const { return static_cast<size_t>(m_NodeCount); }
+  static size_t node_bytes() { return sizeof(LNode); }
+  // Merge nodes that fall below a quarter full into a neighbour during
+  // erase/pop_back/pop_front (off by default).
+  void auto_merge(bool enable) { m_AutoMerge = enable; }
+  bool auto_merge() const { return m_AutoMerge; }
   void clear();
   void compact();
+  // Prepares enough nodes for count elements, so filling the list up to
+  // count does not allocate.
+  void reserve(size_t count);
+
+  // Moves the elements from index on into a new list. Splits at most one node.
+  Lariat split_at(int index);
+  // Moves the elements of rhs to the end of this list (rhs is left empty).
+  void append(Lariat&& rhs);
+  // Moves the elements of rhs into this list before index (rhs is left empty).
+  void splice(int index, Lariat&& rhs);
   
 
 private:
+  // Most levels a node can have in the index (p = 1/4, enough for 4^16 nodes).
+  static const int MaxLevel = 16;
+
+  // One level of a node in the index: the neighbouring nodes on that level
+  // and the number of elements and nodes from this node (inclusive) up to next.
+  struct Link
+  {
+    LNode* next;
+    LNode* prev;
+    int width;
+    int nodes;
+  };
+
   struct LNode
   {
     LNode* prev;
     LNode* next;
     int count = 0;
+    int levels = 0;        // Number of index levels of this node
+    Link* links = nullptr; // Index links, one per level
     T values[Size];
 
-    void push_back(const T& value);
+    ~LNode() { delete[] links; }
+
+    void push_back(T&& value);
     T pop_back();
   };
 
@@ -120,23 +410,74 @@ private:
   int m_Size = 0;              // Number of items (not nodes) in the list
   mutable int m_NodeCount = 0; // Number of nodes int he list
   int m_ASize = Size;          // The Size of the array within the nodes.
+  bool m_AutoMerge = false;    // Merge underfull nodes when removing
+
+  // Skip list over the nodes, weighted by their counts, so a global index is
+  // found in O(log nodes). The head links act as a node before m_Head. Only
+  // the levels in use are kept up to date, so a count change costs
+  // O(log nodes) and a list of a few nodes pays for one or two levels.
+  Link m_IndexHead[MaxLevel] = {};
+  int m_IndexLevels = 1;              // Highest level in use
+  unsigned m_IndexSeed = 2463534242u; // State for the random node levels
+
+  Alloc<LNode> m_Alloc; // Hands out and takes back the nodes
 
   // Splits a node into two. 
-  void split(LNode* node) const; 
+  void split(LNode* node); 
   // Finds the node and local index of an element.
   std::tuple<LNode*, int> findElement(int globalIndex) const; 
-  // Shifts an element up the list.
-  const T* shiftUp(LNode* node, int index);
+  // Finds the sorted position of a value: node, local index and global index.
+  std::tuple<LNode*, int, int> findSorted(const T& value, bool upper) const;
+  // Shifts the elements from index up one place (the last falls off a full node).
+  void shiftUp(LNode* node, int index);
   // Shfits the entire array down.
-  const T shiftDown(LNode* node, int index);
+  void shiftDown(LNode* node, int index);
   // Swaps two elements.
   void swap(T& a, T& b); 
   // Deletes a node.
   void deleteNode(LNode* node);
   // Insert node at a position in the list.
-  void insertNode(LNode* ptr, int list_index, T const& value);
+  void insertNode(LNode* ptr, int list_index, T&& value);
+  // Makes room at a position in a node, splitting it when full. Returns the slot.
+  T* openSlot(LNode* ptr, int list_index);
+  // Makes room at a global index. Returns the slot.
+  T* openAt(int globalIndex);
+  // Merges an underfull node into a neighbour (when auto merging).
+  void mergeUnderfull(LNode* node);
+  // Links a new, empty node into the list after another (nullptr for the front).
+  LNode* addNode(LNode* after);
+  // Takes over the nodes of another list, leaving it empty.
+  void take(Lariat& rhs);
   // Iterates through the lariat and gets the index of a node.
   int GetNodeIndex(LNode* ptr);
+
+  // Allocates an empty node with a random number of index levels.
+  LNode* newNode();
+  // Gives a node without index links its random levels.
+  void pickLevels(LNode* node);
+  // Resets a node's values and gives it back to the allocator.
+  void releaseNode(LNode* node);
+  // Replaces values that left the list with T().
+  static void resetValues(T* first, T* last);
+  // Index links of a node (the head links for nullptr).
+  Link* linksOf(LNode* node);
+  const Link* linksOf(LNode* node) const;
+  // Adds an empty node to the index after another (nullptr for the front).
+  void indexInsert(LNode* after, LNode* node);
+  // Takes an empty node out of the index.
+  void indexRemove(LNode* node);
+  // Records that a node's count changed by delta.
+  void indexUpdate(LNode* node, int delta);
+  // Cuts the index after a node, the rest goes to another list.
+  int indexCut(LNode* last, Lariat& rest);
+  // Joins the index of another list after the tail.
+  void indexJoin(Lariat& rhs);
+  // Recomputes every width from the node counts.
+  void indexRebuild();
+  // Brings more levels into use.
+  void indexRaise(int levels);
+  // Clears the head links.
+  void indexReset();
 };
 
 
@@ -0,0 +1,349 @@
+/// --------------------------------------------------------------------------
+/// @file FastHash.cpp
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+
+/// @brief Word-at-a-time 64-bit hash functions for the hash table.
+///        All loads go through std::memcpy so unaligned keys are fine and
+///        no byte past the end of the key is ever read. Little-endian
+///        loads are assumed (x86/ARM).
+
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+
+#include "FastHash.h"
+#include <cstring> // std::memcpy, std::strlen
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h> // _mm_crc32_u64, _mm_crc32_u8
+#endif
+
+namespace
+{
+  //------------------------------------------------------------------------
+  /// @brief Unaligned 8 byte load
+  //------------------------------------------------------------------------
+  inline std::uint64_t Read64(const unsigned char *p)
+  {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  //------------------------------------------------------------------------
+  /// @brief Unaligned 4 byte load
+  //------------------------------------------------------------------------
+  inline std::uint64_t Read32(const unsigned char *p)
+  {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  //------------------------------------------------------------------------
+  /// @brief Rotate left
+  //------------------------------------------------------------------------
+  inline std::uint64_t Rotl(std::uint64_t x, int r)
+  {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  //------------------------------------------------------------------------
+  /// @brief 64x64 -> 128 bit multiply, low half in A, high half in B.
+  //------------------------------------------------------------------------
+  inline void Mum(std::uint64_t &A, std::uint64_t &B)
+  {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    uint128 r = static_cast<uint128>(A) * B;
+    A = static_cast<std::uint64_t>(r);
+    B = static_cast<std::uint64_t>(r >> 64);
+#else
+    std::uint64_t ha = A >> 32, hb = B >> 32, la = A & 0xFFFFFFFFull, lb = B & 0xFFFFFFFFull;
+    std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    std::uint64_t t = rl + (rm0 << 32);
+    std::uint64_t c = t < rl;
+    std::uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    A = lo;
+    B = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+  }
+
+  //------------------------------------------------------------------------
+  /// @brief Multiply and fold the two halves together
+  //------------------------------------------------------------------------
+  inline std::uint64_t Mix(std::uint64_t A, std::uint64_t B)
+  {
+    Mum(A, B);
+    return A ^ B;
+  }
+
+  //------------------------------------------------------------------------
+  /// @brief Final avalanche (murmur3 fmix64)
+  //------------------------------------------------------------------------
+  inline std::uint64_t Avalanche(std::uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  /// @brief wyhash secret
+  const std::uint64_t WY[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                               0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+  /// @brief xxHash64 primes
+  const std::uint64_t XXP1 = 0x9E3779B185EBCA87ull;
+  const std::uint64_t XXP2 = 0xC2B2AE3D27D4EB4Full;
+  const std::uint64_t XXP3 = 0x165667B19E3779F9ull;
+  const std::uint64_t XXP4 = 0x85EBCA77C2B2AE63ull;
+  const std::uint64_t XXP5 = 0x27D4EB2F165667C5ull;
+
+  //------------------------------------------------------------------------
+  /// @brief One xxHash64 lane step
+  //------------------------------------------------------------------------
+  inline std::uint64_t XXRound(std::uint64_t acc, std::uint64_t input)
+  {
+    acc += input * XXP2;
+    acc = Rotl(acc, 31);
+    return acc * XXP1;
+  }
+
+  //------------------------------------------------------------------------
+  /// @brief Folds a lane into the final xxHash64 accumulator
+  //------------------------------------------------------------------------
+  inline std::uint64_t XXMerge(std::uint64_t acc, std::uint64_t lane)
+  {
+    acc ^= XXRound(0, lane);
+    return acc * XXP1 + XXP4;
+  }
+
+#if !defined(__SSE4_2__)
+  /// @brief Table for the byte-wise CRC32-C (Castagnoli, reflected 0x82F63B78)
+  struct CRC32CTable
+  {
+    std::uint32_t Entries[256];
+
+    CRC32CTable() : Entries()
+    {
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+          crc = (crc & 1u) ? (crc >> 1) ^ 0x82F63B78u : (crc >> 1);
+        }
+        Entries[i] = crc;
+      }
+    }
+  };
+#endif
+}
+
+//---------------------------------------------------------------------------
+/// @brief wyhash
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t WyHash64(const void *Data, std::size_t Len, std::uint64_t Seed)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(Data);
+  Seed ^= Mix(Seed ^ WY[0], WY[1]);
+  std::uint64_t a, b;
+
+  if (Len <= 16)
+  {
+    if (Len >= 4)
+    {
+      // Two overlapping 4 byte reads from each end cover 4..16 bytes
+      std::size_t shift = (Len >> 3) << 2;
+      a = (Read32(p) << 32) | Read32(p + shift);
+      b = (Read32(p + Len - 4) << 32) | Read32(p + Len - 4 - shift);
+    }
+    else if (Len > 0)
+    {
+      a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[Len >> 1]) << 8) | p[Len - 1];
+      b = 0;
+    }
+    else
+    {
+      a = b = 0;
+    }
+  }
+  else
+  {
+    std::size_t i = Len;
+    if (i > 48)
+    {
+      // Three independent streams of 16 bytes
+      std::uint64_t see1 = Seed, see2 = Seed;
+      do
+      {
+        Seed = Mix(Read64(p) ^ WY[1], Read64(p + 8) ^ Seed);
+        see1 = Mix(Read64(p + 16) ^ WY[2], Read64(p + 24) ^ see1);
+        see2 = Mix(Read64(p + 32) ^ WY[3], Read64(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      Seed ^= see1 ^ see2;
+    }
+    while (i > 16)
+    {
+      Seed = Mix(Read64(p) ^ WY[1], Read64(p + 8) ^ Seed);
+      i -= 16;
+      p += 16;
+    }
+    a = Read64(p + i - 16);
+    b = Read64(p + i - 8);
+  }
+
+  a ^= WY[1];
+  b ^= Seed;
+  Mum(a, b);
+  return Mix(a ^ WY[0] ^ Len, b ^ WY[1]);
+}
+
+//---------------------------------------------------------------------------
+/// @brief xxHash64
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t XXHash64(const void *Data, std::size_t Len, std::uint64_t Seed)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(Data);
+  const unsigned char *end = p + Len;
+  std::uint64_t h;
+
+  if (Len >= 32)
+  {
+    // Four lanes with no dependency between them
+    std::uint64_t v1 = Seed + XXP1 + XXP2;
+    std::uint64_t v2 = Seed + XXP2;
+    std::uint64_t v3 = Seed;
+    std::uint64_t v4 = Seed - XXP1;
+    const unsigned char *limit = end - 32;
+    do
+    {
+      v1 = XXRound(v1, Read64(p));
+      v2 = XXRound(v2, Read64(p + 8));
+      v3 = XXRound(v3, Read64(p + 16));
+      v4 = XXRound(v4, Read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+
+    h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+    h = XXMerge(h, v1);
+    h = XXMerge(h, v2);
+    h = XXMerge(h, v3);
+    h = XXMerge(h, v4);
+  }
+  else
+  {
+    h = Seed + XXP5;
+  }
+
+  h += Len;
+
+  // Remaining whole words
+  while (p + 8 <= end)
+  {
+    h ^= XXRound(0, Read64(p));
+    h = Rotl(h, 27) * XXP1 + XXP4;
+    p += 8;
+  }
+  if (p + 4 <= end)
+  {
+    h ^= Read32(p) * XXP1;
+    h = Rotl(h, 23) * XXP2 + XXP3;
+    p += 4;
+  }
+  while (p < end)
+  {
+    h ^= (*p) * XXP5;
+    h = Rotl(h, 11) * XXP1;
+    ++p;
+  }
+
+  h ^= h >> 33;
+  h *= XXP2;
+  h ^= h >> 29;
+  h *= XXP3;
+  h ^= h >> 32;
+  return h;
+}
+
+//---------------------------------------------------------------------------
+/// @brief CRC32-C spread to 64 bits
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t CRC32CHash64(const void *Data, std::size_t Len, std::uint64_t Seed)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(Data);
+  std::uint64_t crc = static_cast<std::uint32_t>(Seed) ^ 0xFFFFFFFFu;
+
+#if defined(__SSE4_2__)
+  // 8 bytes per instruction
+  std::size_t i = 0;
+  for (; i + 8 <= Len; i += 8)
+  {
+    crc = _mm_crc32_u64(crc, Read64(p + i));
+  }
+  std::uint32_t crc32 = static_cast<std::uint32_t>(crc);
+  for (; i < Len; ++i)
+  {
+    crc32 = _mm_crc32_u8(crc32, p[i]);
+  }
+#else
+  static const CRC32CTable table;
+  std::uint32_t crc32 = static_cast<std::uint32_t>(crc);
+  for (std::size_t i = 0; i < Len; ++i)
+  {
+    crc32 = table.Entries[(crc32 ^ p[i]) & 0xFFu] ^ (crc32 >> 8);
+  }
+#endif
+
+  crc32 ^= 0xFFFFFFFFu;
+  return Avalanche((static_cast<std::uint64_t>(Len) << 32) | crc32);
+}
+
+//---------------------------------------------------------------------------
+/// @brief FNV-1a, byte at a time
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t FNV1aHash64(const void *Data, std::size_t Len, std::uint64_t Seed)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(Data);
+  std::uint64_t hash = 0xcbf29ce484222325ull ^ Seed;
+
+  for (std::size_t i = 0; i < Len; ++i)
+  {
+    hash ^= p[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+//---------------------------------------------------------------------------
+/// @brief HASHFUNC64 adapters
+//---------------------------------------------------------------------------
+std::uint64_t WyHash64(const char *Key) { return WyHash64(Key, std::strlen(Key)); }
+std::uint64_t XXHash64(const char *Key) { return XXHash64(Key, std::strlen(Key)); }
+std::uint64_t CRC32CHash64(const char *Key) { return CRC32CHash64(Key, std::strlen(Key)); }
+std::uint64_t FNV1aHash64(const char *Key) { return FNV1aHash64(Key, std::strlen(Key)); }
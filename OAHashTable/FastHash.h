@@ -0,0 +1,77 @@
+/// --------------------------------------------------------------------------
+/// @file FastHash.h
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+
+/// @brief Word-at-a-time 64-bit hash functions for the hash table. Each
+///        function returns the full 64-bit hash of the key, the table
+///        reduces it to an index once (instead of every client function
+///        paying for its own modulo).
+
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+
+//---------------------------------------------------------------------------
+#ifndef FASTHASHH
+#define FASTHASHH
+//---------------------------------------------------------------------------
+#include <cstdint> // std::uint64_t
+#include <cstddef> // std::size_t
+
+//---------------------------------------------------------------------------
+/// @brief Client-provided 64-bit hash function
+/// @param const char* - key (NUL terminated)
+/// @return The full, unreduced hash of the key (std::uint64_t).
+//---------------------------------------------------------------------------
+typedef std::uint64_t (*HASHFUNC64)(const char *);
+
+//---------------------------------------------------------------------------
+/// @brief wyhash: two 64x64->128 bit multiplies per 16 bytes of input.
+///        The fastest general purpose choice for short keys.
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t WyHash64(const void *Data, std::size_t Len, std::uint64_t Seed = 0);
+
+//---------------------------------------------------------------------------
+/// @brief xxHash64: four independent accumulator lanes of 8 bytes each,
+///        which the compiler keeps in separate registers (or vector lanes).
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t XXHash64(const void *Data, std::size_t Len, std::uint64_t Seed = 0);
+
+//---------------------------------------------------------------------------
+/// @brief CRC32-C of the data, using the SSE4.2 crc32 instruction when the
+///        target supports it (a table-driven version otherwise), spread to
+///        64 bits by a final mix. Only 32 bits of the result are entropy.
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t CRC32CHash64(const void *Data, std::size_t Len, std::uint64_t Seed = 0);
+
+//---------------------------------------------------------------------------
+/// @brief FNV-1a, one byte at a time. Kept as the byte-wise baseline.
+/// @param Data - Pointer to the bytes to hash
+/// @param Len  - Number of bytes
+/// @param Seed - Seed value
+/// @return The 64-bit hash (std::uint64_t).
+//---------------------------------------------------------------------------
+std::uint64_t FNV1aHash64(const void *Data, std::size_t Len, std::uint64_t Seed = 0);
+
+/// @brief HASHFUNC64 adapters for NUL terminated keys
+std::uint64_t WyHash64(const char *Key);
+std::uint64_t XXHash64(const char *Key);
+std::uint64_t CRC32CHash64(const char *Key);
+std::uint64_t FNV1aHash64(const char *Key);
+
+#endif
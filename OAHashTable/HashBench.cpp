@@ -0,0 +1,334 @@
+/// --------------------------------------------------------------------------
+/// @file HashBench.cpp
+/// @author Aidan Straker (aidan.straker@digipen.edu)
+
+/// @brief Throughput and collision/probe statistics of the driver's hash
+///        functions (baseline) and the 64-bit hash functions on the driver's
+///        key sets and on synthetic million-key sets.
+///        Usage: bench.exe [keys]   (default 1000000)
+
+/// @version 0.1
+/// @date 2024-03-22
+///
+/// @copyright Copyright (c) 2024
+///
+///---------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "OAHashTable.h"
+
+/// @brief The hash functions of driver.cpp, copied here as the baseline
+unsigned PJWHash(const char *Key, unsigned TableSize)
+{
+  unsigned hash = 0;
+  while (*Key)
+  {
+    hash = (hash << 4) + static_cast<unsigned>(*Key);
+    unsigned bits = hash & 0xF0000000;
+    if (bits)
+    {
+      hash = hash ^ (bits >> 24);
+      hash = hash ^ bits;
+    }
+    Key++;
+  }
+  return hash % TableSize;
+}
+
+unsigned SimpleHash(const char *Key, unsigned TableSize)
+{
+  unsigned hash = 0;
+  while (*Key)
+    hash += static_cast<unsigned>(*Key++);
+  return hash % TableSize;
+}
+
+unsigned RSHash(const char *Key, unsigned TableSize)
+{
+  unsigned hash = 0;
+  unsigned multiplier = 127;
+  while (*Key)
+    hash = (hash * multiplier + static_cast<unsigned>(*Key++)) % TableSize;
+  return hash;
+}
+
+unsigned UHash(const char *Key, unsigned TableSize)
+{
+  unsigned hash = 0;
+  unsigned rand1 = 31415;
+  unsigned rand2 = 27183;
+  while (*Key)
+  {
+    hash = (hash * rand1 + static_cast<unsigned>(*Key++)) % TableSize;
+    rand1 = (rand1 * rand2) % (TableSize - 1);
+  }
+  return hash;
+}
+
+struct HashData
+{
+  HASHFUNC Fn;
+  const char *Name;
+};
+
+HashData HashingFuncs[] = {
+  {SimpleHash, "Simple (driver)"}
+ ,{RSHash, "RS (driver)"}
+ ,{UHash, "Universal (driver)"}
+ ,{PJWHash, "PJW (driver)"}
+};
+
+struct HashData64
+{
+  HASHFUNC64 Fn;
+  const char *Name;
+};
+
+HashData64 HashingFuncs64[] = {
+  {FNV1aHash64, "FNV-1a (bytewise)"}
+ ,{WyHash64, "wyhash"}
+ ,{XXHash64, "xxHash64"}
+ ,{CRC32CHash64, "CRC32-C"}
+};
+
+/// @brief Calls either kind of hash function. The driver's functions reduce
+///        to the table size themselves, the 64-bit ones leave that to the table.
+inline std::uint64_t Hash(HASHFUNC fn, const char *key, unsigned size)
+{
+  return fn(key, size);
+}
+
+inline std::uint64_t Hash(HASHFUNC64 fn, const char *key, unsigned)
+{
+  return fn(key);
+}
+
+/// @brief The table size used for a key set (LF 0.5)
+unsigned TableSizeFor(std::size_t keys)
+{
+  return GetClosestPrime(static_cast<unsigned>(keys * 2 + 1));
+}
+
+/// @brief A key set: storage for the strings plus pointers the table can use
+struct KeySet
+{
+  std::string Name;
+  std::vector<std::string> Storage;
+  std::vector<const char *> Keys;
+
+  void Finish()
+  {
+    Keys.clear();
+    for (const std::string &s : Storage)
+      Keys.push_back(s.c_str());
+  }
+};
+
+/// @brief The IDs used by the driver ("101001" ... "123001")
+KeySet PeopleKeys()
+{
+  KeySet set;
+  set.Name = "driver people IDs";
+  for (unsigned i = 101; i <= 123; i++)
+    set.Storage.push_back(std::to_string(i) + "001");
+  set.Finish();
+  return set;
+}
+
+/// @brief Reversed, zero padded numbers like TestSimpleDispose/TestSimpleGrow
+KeySet ReversedKeys(unsigned count)
+{
+  KeySet set;
+  set.Name = "driver reversed IDs";
+  char buffer[16];
+  for (unsigned i = 0; i < count; i++)
+  {
+    std::snprintf(buffer, sizeof(buffer), "%07u", i);
+    std::string s(buffer);
+    set.Storage.push_back(std::string(s.rbegin(), s.rend()));
+  }
+  set.Finish();
+  return set;
+}
+
+/// @brief Sequential keys with a common prefix (the usual weak spot)
+KeySet SequentialKeys(unsigned count)
+{
+  KeySet set;
+  set.Name = "sequential";
+  char buffer[MAX_KEYLEN];
+  for (unsigned i = 0; i < count; i++)
+  {
+    std::snprintf(buffer, sizeof(buffer), "user:%09u", i);
+    set.Storage.push_back(buffer);
+  }
+  set.Finish();
+  return set;
+}
+
+/// @brief Random alphanumeric keys, 4 to 31 characters
+KeySet RandomKeys(unsigned count)
+{
+  static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  KeySet set;
+  set.Name = "random";
+  std::mt19937 gen(280);
+  std::uniform_int_distribution<unsigned> length(4, MAX_KEYLEN - 1);
+  std::uniform_int_distribution<unsigned> letter(0, static_cast<unsigned>(sizeof(alphabet) - 2));
+  for (unsigned i = 0; i < count; i++)
+  {
+    std::string s(length(gen), ' ');
+    for (char &c : s)
+      c = alphabet[letter(gen)];
+    set.Storage.push_back(s);
+  }
+  set.Finish();
+  return set;
+}
+
+/// @brief Hashes every key in the set repeatedly
+/// @return Nanoseconds per key and MB/s
+template <typename HashFn>
+void Throughput(const KeySet &set, HashFn fn, double &nsPerKey, double &mbPerSec)
+{
+  unsigned size = TableSizeFor(set.Keys.size());
+  std::size_t bytes = 0;
+  for (const std::string &s : set.Storage)
+    bytes += s.size();
+
+  // At least ~4M hashes so the tiny sets are measurable
+  std::size_t reps = 1 + 4000000 / set.Keys.size();
+  volatile std::uint64_t sink = 0;
+
+  std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < reps; r++)
+  {
+    std::uint64_t acc = 0;
+    for (const char *key : set.Keys)
+      acc += Hash(fn, key, size);
+    sink = sink + acc;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  double hashes = static_cast<double>(reps) * static_cast<double>(set.Keys.size());
+  nsPerKey = elapsed.count() * 1e9 / hashes;
+  mbPerSec = static_cast<double>(bytes) * static_cast<double>(reps) / elapsed.count() / 1e6;
+}
+
+/// @brief Number of keys that land on an already used home slot (table at LF 0.5)
+template <typename HashFn>
+unsigned HomeCollisions(const KeySet &set, HashFn fn)
+{
+  unsigned size = TableSizeFor(set.Keys.size());
+  std::vector<bool> used(size, false);
+  unsigned collisions = 0;
+  for (const char *key : set.Keys)
+  {
+    std::size_t slot = static_cast<std::size_t>(Hash(fn, key, size) % size);
+    if (used[slot])
+      collisions++;
+    used[slot] = true;
+  }
+  return collisions;
+}
+
+/// @brief Average probes per insert and per successful find in an OAHashTable
+template <typename HashFn>
+void ProbeStats(const KeySet &set, HashFn primary, HashFn secondary, double &insertProbes, double &findProbes,
+                double &seconds)
+{
+  typedef unsigned T;
+  unsigned size = TableSizeFor(set.Keys.size());
+  OAHashTable<T> ht(OAHashTable<T>::OAHTConfig(size, primary, secondary, 0.5, 2.0, secondary ? MARK : PACK, 0));
+
+  std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+  T value = 0;
+  for (const char *key : set.Keys)
+  {
+    try
+    {
+      ht.insert(key, value++);
+    }
+    catch (OAHashTableException &)
+    {
+      // Duplicate keys in the generated set are not interesting here
+    }
+  }
+  unsigned afterInsert = ht.GetStats().Probes_;
+
+  for (const char *key : set.Keys)
+    ht.find(key);
+  seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double count = static_cast<double>(set.Keys.size());
+  insertProbes = afterInsert / count;
+  findProbes = (ht.GetStats().Probes_ - afterInsert) / count;
+}
+
+/// @brief One row of the report. Probing is skipped (shown as -) when more
+///        than half of the keys collide, the tables would take hours to fill.
+template <typename HashFn>
+void ReportRow(const KeySet &set, const char *name, HashFn fn, HashFn secondary)
+{
+  double ns = 0, mb = 0, lpIns = 0, lpFind = 0, dhIns = 0, dhFind = 0, lpTime = 0, dhTime = 0;
+  Throughput(set, fn, ns, mb);
+  unsigned collisions = HomeCollisions(set, fn);
+
+  std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+            << std::setw(10) << ns << std::setw(10) << std::setprecision(0) << mb << std::setw(12) << collisions;
+  if (collisions > set.Keys.size() / 2)
+  {
+    std::cout << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-" << std::setw(12) << "-"
+              << std::setw(12) << "-" << std::endl;
+    return;
+  }
+
+  ProbeStats(set, fn, HashFn(nullptr), lpIns, lpFind, lpTime);
+  ProbeStats(set, fn, secondary, dhIns, dhFind, dhTime);
+  std::cout << std::setprecision(3) << std::setw(12) << lpIns << std::setw(12) << lpFind << std::setw(12) << dhIns
+            << std::setw(12) << dhFind << std::setw(12) << lpTime + dhTime << std::endl;
+}
+
+void Report(const KeySet &set)
+{
+  std::cout << std::endl << "==================== " << set.Name << " (" << set.Keys.size() << " keys) ===================="
+            << std::endl;
+  std::cout << std::left << std::setw(20) << "Hash" << std::right << std::setw(10) << "ns/key" << std::setw(10) << "MB/s"
+            << std::setw(12) << "collisions" << std::setw(12) << "LP ins" << std::setw(12) << "LP find"
+            << std::setw(12) << "DH ins" << std::setw(12) << "DH find" << std::setw(12) << "table s" << std::endl;
+
+  // Secondary for double hashing: the next function in the same list
+  const unsigned count = sizeof(HashingFuncs) / sizeof(*HashingFuncs);
+  for (unsigned i = 0; i < count; i++)
+    ReportRow(set, HashingFuncs[i].Name, HashingFuncs[i].Fn, HashingFuncs[(i + 1) % count].Fn);
+
+  const unsigned count64 = sizeof(HashingFuncs64) / sizeof(*HashingFuncs64);
+  for (unsigned i = 0; i < count64; i++)
+    ReportRow(set, HashingFuncs64[i].Name, HashingFuncs64[i].Fn, HashingFuncs64[(i + 1) % count64].Fn);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned count = 1000000;
+  if (argc > 1)
+    count = static_cast<unsigned>(std::atoi(argv[1]));
+
+  std::cout << "collisions: keys whose home slot is already taken (LF 0.5)" << std::endl;
+  std::cout << "LP/DH ins/find: average probes per operation, linear probing / double hashing" << std::endl;
+  std::cout << "(driver): the hash functions of driver.cpp, as the baseline" << std::endl;
+
+  Report(PeopleKeys());
+  Report(ReversedKeys(10000));
+  Report(SequentialKeys(count));
+  Report(RandomKeys(count));
+
+  return 0;
+}
@@ -15,14 +15,18 @@
 
 #include "OAHashTable.h"
 
+/// @brief Template header and class name shared by the member definitions below
+#define OAHT_TEMPLATE template <typename T, typename KeyType, typename Hash, typename KeyEqual>
+#define OAHT OAHashTable<T, KeyType, Hash, KeyEqual>
+
 ///--------------------------------OAHTSlot Function Definitions--------------------------------------------------------
 
 ///---------------------------------------------------------------------------------------------------------------------
 /// @brief Slot Default Constructor
 /// @tparam T - The data type of the value in the pair
 ///---------------------------------------------------------------------------------------------------------------------
-template<typename T>
-OAHashTable<T>::OAHTSlot::OAHTSlot()
+OAHT_TEMPLATE
+OAHT::OAHTSlot::OAHTSlot()
     : Key()
     , Data()
     , State(UNOCCUPIED)
@@ -35,14 +39,14 @@ OAHashTable<T>::OAHTSlot::OAHTSlot()
 /// @param Key  - The Key for the slot
 /// @param data - The client data associated with the key
 ///---------------------------------------------------------------------------------------------------------------------
-template<typename T>
-OAHashTable<T>::OAHTSlot::OAHTSlot(const char *Key, T data)
-    : State(OCCUPIED)
+OAHT_TEMPLATE
+OAHT::OAHTSlot::OAHTSlot(const KeyType& Key, T data)
+    : Key()
+    , Data(std::move(data))
+    , State(OCCUPIED)
     , probes(0)
-    , Key()
-    , Data(data)
 {
-    std::strncpy(this->Key, Key, MAX_KEYLEN);
+    KeyTraits::Store(this->Key, Key);
 }
 
 ///--------------------------------OAHashTable Function Definitions-----------------------------------------------------
@@ -52,16 +56,20 @@ OAHashTable<T>::OAHTSlot::OAHTSlot(const char *Key, T data)
 /// @tparam T     - Data type of the data in the pair
 /// @param Config - Reference to another instance of OAHTConfig
 ///---------------------------------------------------------------------------------------------------------------------
-template<typename T>
-OAHashTable<T>::OAHashTable(const OAHashTable::OAHTConfig &Config)
+OAHT_TEMPLATE
+OAHT::OAHashTable(const OAHashTable::OAHTConfig &Config, const Hash& Hasher, const KeyEqual& Equal)
         : m_table_config(Config)
         , m_table_stats()
         , m_Table(Config.m_initial_table_size)
+        , m_hash(Hasher)
+        , m_key_equal(Equal)
 {
 
     // Update the pointers to the primary and secondary hashing functions.
     m_table_stats.PrimaryHashFunc_ = m_table_config.m_primary_hash_func;
     m_table_stats.SecondaryHashFunc_ = m_table_config.m_secondary_hash_func;
+    m_table_stats.PrimaryHashFunc64_ = m_table_config.m_primary_hash_func64;
+    m_table_stats.SecondaryHashFunc64_ = m_table_config.m_secondary_hash_func64;
 
     // Update the size of the table.
     m_table_stats.TableSize_ += m_table_config.m_initial_table_size;
@@ -71,8 +79,8 @@ OAHashTable<T>::OAHashTable(const OAHashTable::OAHTConfig &Config)
 /// @brief Destructor
 /// @tparam T - The data type of the data in the key/data pair
 //----------------------------------------------------------------------------------------------------------------------
-template<typename T>
-OAHashTable<T>::~OAHashTable()
+OAHT_TEMPLATE
+OAHT::~OAHashTable()
 {
     clear();
 }
@@ -83,8 +91,91 @@ OAHashTable<T>::~OAHashTable()
 /// @param Key  - The key
 /// @param Data - Client data associated with the key
 //----------------------------------------------------------------------------------------------------------------------
-template<typename T>
-void OAHashTable<T>::insert(const char *Key, const T &Data)
+OAHT_TEMPLATE
+void OAHT::insert(const KeyType& Key, const T &Data)
+{
+    int emptyIndex = PrepareInsert(Key);
+
+    // Add the key/data pair to the table
+    KeyTraits::Store(m_Table[emptyIndex].Key, Key);
+    m_Table[emptyIndex].Data = Data;
+    m_Table[emptyIndex].State = OAHTSlot::OCCUPIED;
+    m_table_stats.Count_++;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief Insert a new key/data pair into the Hash Table, moving the data
+/// @tparam T   - Data type of the data in the key/data pair
+/// @param Key  - The key
+/// @param Data - Client data associated with the key
+//----------------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+void OAHT::insert(const KeyType& Key, T &&Data)
+{
+    int emptyIndex = PrepareInsert(Key);
+
+    KeyTraits::Store(m_Table[emptyIndex].Key, Key);
+    m_Table[emptyIndex].Data = std::move(Data);
+    m_Table[emptyIndex].State = OAHTSlot::OCCUPIED;
+    m_table_stats.Count_++;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief Insert a new key/data pair into the Hash Table, moving the key and the data
+/// @tparam T   - Data type of the data in the key/data pair
+/// @param Key  - The key
+/// @param Data - Client data associated with the key
+//----------------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+void OAHT::insert(KeyType&& Key, T &&Data)
+{
+    int emptyIndex = PrepareInsert(Key);
+
+    KeyTraits::Store(m_Table[emptyIndex].Key, std::move(Key));
+    m_Table[emptyIndex].Data = std::move(Data);
+    m_Table[emptyIndex].State = OAHTSlot::OCCUPIED;
+    m_table_stats.Count_++;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief Construct the data in its slot once the key is known to be new. The slot's
+///        default constructed T is destroyed and the new one built in its place, so T
+///        is neither copied nor moved.
+/// @tparam Args - Types of the constructor arguments
+/// @param Key   - The key
+/// @param args  - Arguments forwarded to the constructor of T
+//----------------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+template <typename... Args>
+void OAHT::emplace(const KeyType& Key, Args&&... args)
+{
+    int emptyIndex = PrepareInsert(Key);
+
+    T* data = &m_Table[emptyIndex].Data;
+    data->~T();
+    try
+    {
+        ::new (static_cast<void*>(data)) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        // Leave a live object behind for the slot to destroy later
+        ::new (static_cast<void*>(data)) T();
+        throw;
+    }
+
+    KeyTraits::Store(m_Table[emptyIndex].Key, Key);
+    m_Table[emptyIndex].State = OAHTSlot::OCCUPIED;
+    m_table_stats.Count_++;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief Grows the table if needed and finds the slot a new key goes in.
+/// @param Key - The key about to be inserted
+/// @return Index of the slot to fill (int)
+//----------------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+int OAHT::PrepareInsert(const KeyType& Key)
 {
     // If adding the key/data pair makes the load factor exceed the maximum
     if (LoadFactor(m_table_stats.Count_ + 1) > m_table_config.m_max_load_factor)
@@ -105,10 +196,24 @@ void OAHashTable<T>::insert(const char *Key, const T &Data)
         throw OAHashTableException(OAHashTableException::E_DUPLICATE, "Insert: Duplicate");
     }
 
-    // Add the key/data pair to the table
-    std::strncpy(m_Table[emptyIndex].Key, Key, MAX_KEYLEN - 1);
-    m_Table[emptyIndex].Data = Data;
-    m_Table[emptyIndex].State = OAHTSlot::OCCUPIED;
+    return emptyIndex;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief Moves a slot's key and data into this table. The key is known not to be in the table
+///        and the load factor is known to be fine (GrowTable and PACK only ever reinsert fewer items).
+/// @param Slot - The slot to move from
+//----------------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+void OAHT::Reinsert(OAHTSlot& Slot)
+{
+    int emptyIndex = 0;
+    IndexOf(KeyTraits::Get(Slot.Key), emptyIndex);
+
+    OAHTSlot& dest = m_Table[emptyIndex];
+    KeyTraits::Move(dest.Key, Slot.Key);
+    dest.Data = std::move(Slot.Data);
+    dest.State = OAHTSlot::OCCUPIED;
     m_table_stats.Count_++;
 }
 
@@ -117,8 +222,8 @@ void OAHashTable<T>::insert(const char *Key, const T &Data)
 ///        Compacts the table by moving key/data pairs, if necessary
 /// @param Key - The key of the pair to remove
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-void OAHashTable<T>::remove(const char *Key)
+OAHT_TEMPLATE
+void OAHT::remove(const KeyType& Key)
 {
     int emptyIndex = 0;
     // Search for the key
@@ -143,17 +248,18 @@ void OAHashTable<T>::remove(const char *Key)
     std::vector<OAHTSlot> backup;
     m_Table[index].State = OAHTSlot::UNOCCUPIED;
     // Backup every slot in the table after the one to be deleted
-    for (int i = index + 1; m_Table[i].State == OAHTSlot::OCCUPIED; i = (i + 1) % m_table_stats.TableSize_)
+    int next = static_cast<int>((static_cast<unsigned>(index) + 1) % m_table_stats.TableSize_);
+    for (int i = next; m_Table[i].State == OAHTSlot::OCCUPIED; i = (i + 1) % m_table_stats.TableSize_)
     {
-         backup.push_back(m_Table[i]);
+         backup.push_back(std::move(m_Table[i]));
          m_Table[i].State = OAHTSlot::UNOCCUPIED;
          m_table_stats.Count_--;
     }
 
-    // Add the backed up slots to the table
+    // Move the backed up slots back into the table
     for (OAHTSlot& slot : backup)
     {
-        insert(slot.Key, slot.Data);
+        Reinsert(slot);
     }
 }
 
@@ -162,8 +268,8 @@ void OAHashTable<T>::remove(const char *Key)
 /// @param Key - The key to find
 /// @return The data or an exception if the key is not found (const T&)
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-const T &OAHashTable<T>::find(const char *Key) const
+OAHT_TEMPLATE
+const T &OAHT::find(const KeyType& Key) const
 {
     int emptyIndex = 0;
     int index = IndexOf(Key, emptyIndex);
@@ -181,8 +287,8 @@ const T &OAHashTable<T>::find(const char *Key) const
 //----------------------------------------------------------------------------------------------------------------
 /// @brief Removes all items from the table, but does not deallocate it
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-void OAHashTable<T>::clear()
+OAHT_TEMPLATE
+void OAHT::clear()
 {
     // Set every slot in the table to unoccupied
     for(OAHTSlot& slot : m_Table)
@@ -190,8 +296,8 @@ void OAHashTable<T>::clear()
         // Call the client-provided free function, if it exists
         if(slot.State == OAHTSlot::OCCUPIED && m_table_config.m_free_proc)
         {
-            // Free the data associated with the key
-            m_table_config.m_free_proc(slot.Data);
+            // Free the data associated with the key (the slot is dead, so hand it over)
+            m_table_config.m_free_proc(std::move(slot.Data));
         }
         slot.State = OAHTSlot::UNOCCUPIED;
         slot.probes = 0;
@@ -204,23 +310,23 @@ void OAHashTable<T>::clear()
 /// @brief Allow the client to peer into the table.
 /// @return The statistical data of an OAHashTable (OAHSTStats)
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-OAHTStats OAHashTable<T>::GetStats() const { return m_table_stats; }
+OAHT_TEMPLATE
+typename OAHT::OAHTStats OAHT::GetStats() const { return m_table_stats; }
 
 //----------------------------------------------------------------------------------------------------------------
 /// @brief  Allow the client to see a slot in the table
 /// @return The data of a slot in the table (OAHTSlot*)
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-const typename OAHashTable<T>::OAHTSlot *OAHashTable<T>::GetTable() const { return m_Table.data(); }
+OAHT_TEMPLATE
+const typename OAHT::OAHTSlot *OAHT::GetTable() const { return m_Table.data(); }
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @brief Calculates the load factor of this hash table.
 /// @tparam T - The data type of the data in the key/data pair.
 /// @return The load factor of this hash table (double).
 //----------------------------------------------------------------------------------------------------------------------
-template<typename T>
-double OAHashTable<T>::LoadFactor(double num_elements) { return num_elements / m_table_stats.TableSize_; }
+OAHT_TEMPLATE
+double OAHT::LoadFactor(double num_elements) { return num_elements / m_table_stats.TableSize_; }
 
 
 //----------------------------------------------------------------------------------------------------------------
@@ -228,8 +334,8 @@ double OAHashTable<T>::LoadFactor(double num_elements) { return num_elements / m
 ///        (greater than MaxLoadFactor) Grows the table by GrowthFactor,
 ///        making sure the new size is prime by calling GetClosestPrime
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-void OAHashTable<T>::GrowTable()
+OAHT_TEMPLATE
+void OAHT::GrowTable()
 {
     double factor = std::ceil(m_table_stats.TableSize_ * m_table_config.m_growth_factor);
 
@@ -247,11 +353,12 @@ void OAHashTable<T>::GrowTable()
     m_table_stats.TableSize_ = static_cast<unsigned int>(new_size);
     m_table_stats.Expansions_++;
 
+    // Move (not copy) every item into the new table
     for(OAHTSlot& slot : localCopy)
     {
         if(slot.State == OAHTSlot::OCCUPIED)
         {
-            insert(slot.Key, slot.Data);
+            Reinsert(slot);
         }
     }
 }
@@ -262,12 +369,12 @@ void OAHashTable<T>::GrowTable()
 /// @param Slot - Pointer to address of the slot in the table of the key
 /// @return Index if it exists, -1 if not (int)
 //----------------------------------------------------------------------------------------------------------------
-template<typename T>
-int OAHashTable<T>::IndexOf(const char *Key, int& emptyIndex) const
+OAHT_TEMPLATE
+int OAHT::IndexOf(const KeyType& Key, int& emptyIndex) const
 {
 
     // Compute the hash value which will serve as the index
-    unsigned hashValue = m_table_config.m_primary_hash_func(Key, m_table_stats.TableSize_);;
+    unsigned hashValue = HomeIndex(Key);
 
     int index = static_cast<int>(hashValue);
 
@@ -282,13 +389,13 @@ int OAHashTable<T>::IndexOf(const char *Key, int& emptyIndex) const
             m_Table[index].State == OAHTSlot::DELETED ||
             (
                 m_Table[index].State == OAHTSlot::OCCUPIED &&
-                std::strncmp(m_Table[index].Key, Key, MAX_KEYLEN) != 0
+                !m_key_equal(KeyTraits::Get(m_Table[index].Key), Key)
             )
         )
-        && m_table_config.m_secondary_hash_func
+        && IsDoubleHashing()
     )
     {
-        stride = 1 + m_table_config.m_secondary_hash_func(Key, m_table_stats.TableSize_ - 1);
+        stride = Stride(Key);
     }
 
     emptyIndex = -1;
@@ -317,7 +424,7 @@ int OAHashTable<T>::IndexOf(const char *Key, int& emptyIndex) const
                 emptyIndex = index;
             }
         }
-        else if (m_Table[index].State == OAHTSlot::OCCUPIED && std::strcmp(m_Table[index].Key, Key) == 0)
+        else if (m_Table[index].State == OAHTSlot::OCCUPIED && m_key_equal(KeyTraits::Get(m_Table[index].Key), Key))
         {
             // Key found, return index
 
@@ -328,3 +435,56 @@ int OAHashTable<T>::IndexOf(const char *Key, int& emptyIndex) const
         loopCount++;
     }
 }
+
+//----------------------------------------------------------------------------------------------------------------
+/// @brief Computes the home slot of a key with whichever primary hash function is configured
+/// @param Key - The key to hash
+/// @return The home index of the key (unsigned)
+//----------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+unsigned OAHT::HomeIndex(const KeyType& Key) const
+{
+    // 64-bit functions return the full hash, reduce it here (the only modulo paid).
+    if (m_table_config.m_primary_hash_func64)
+    {
+        return static_cast<unsigned>(m_table_config.m_primary_hash_func64(Key) % m_table_stats.TableSize_);
+    }
+    if (m_table_config.m_primary_hash_func)
+    {
+        return m_table_config.m_primary_hash_func(Key, m_table_stats.TableSize_);
+    }
+    // No client function: the Hash functor of the table
+    return static_cast<unsigned>(m_hash(Key) % m_table_stats.TableSize_);
+}
+
+//----------------------------------------------------------------------------------------------------------------
+/// @brief Computes the probe stride of a key (1 when linear probing)
+/// @param Key - The key to hash
+/// @return The stride used for double hashing (unsigned)
+//----------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+unsigned OAHT::Stride(const KeyType& Key) const
+{
+    if (m_table_config.m_secondary_hash_func64)
+    {
+        return 1 + static_cast<unsigned>(m_table_config.m_secondary_hash_func64(Key) % (m_table_stats.TableSize_ - 1));
+    }
+    if (m_table_config.m_secondary_hash_func)
+    {
+        return 1 + m_table_config.m_secondary_hash_func(Key, m_table_stats.TableSize_ - 1);
+    }
+    return 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+/// @brief Is a secondary hash function configured?
+/// @return True if the table uses double hashing (bool)
+//----------------------------------------------------------------------------------------------------------------
+OAHT_TEMPLATE
+bool OAHT::IsDoubleHashing() const
+{
+    return m_table_config.m_secondary_hash_func || m_table_config.m_secondary_hash_func64;
+}
+
+#undef OAHT
+#undef OAHT_TEMPLATE
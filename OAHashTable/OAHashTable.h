@@ -22,7 +22,10 @@
 #include <cstring>   // std::strncpy
 #include <vector>    // std::vector
 #include "Support.h" // GetClosestPrime
+#include "FastHash.h" // HASHFUNC64
 #include <cmath>     // std::ceil
+#include <functional> // std::hash
+#include <new>       // placement new
 
 //---------------------------------------------------------------------------
 /// @brief Client-provided function
@@ -74,11 +77,103 @@ class OAHashTableException
 /// @brief The policy used during a deletion
 enum OAHTDeletionPolicy {MARK, PACK};
 
+//---------------------------------------------------------------------------
+/// @brief Describes how a key type is stored in a slot and which client
+///        hash function signatures it accepts.
+/// @tparam Key - The key type
+//---------------------------------------------------------------------------
+template <typename Key>
+struct OAHTKeyTraits
+{
+  /// @brief What a slot stores for the key
+  typedef Key StoredKey;
+  /// @brief Client-provided hash function returning an index in the table
+  typedef unsigned (*HashFunc)(const Key &, unsigned);
+  /// @brief Client-provided hash function returning the full 64-bit hash
+  typedef std::uint64_t (*HashFunc64)(const Key &);
+
+  /// @brief View of a stored key
+  static const Key &Get(const StoredKey &Stored) { return Stored; }
+  /// @brief Copy a key into a slot
+  static void Store(StoredKey &Stored, const Key &K) { Stored = K; }
+  /// @brief Move a key into a slot
+  static void Store(StoredKey &Stored, Key &&K) { Stored = std::move(K); }
+  /// @brief Move a key from one slot to another
+  static void Move(StoredKey &Dest, StoredKey &Source) { Dest = std::move(Source); }
+};
+
+//---------------------------------------------------------------------------
+/// @brief C-string keys are copied into a fixed char array in the slot
+//---------------------------------------------------------------------------
+template <>
+struct OAHTKeyTraits<const char *>
+{
+  typedef char StoredKey[MAX_KEYLEN];
+  typedef HASHFUNC HashFunc;
+  typedef HASHFUNC64 HashFunc64;
+
+  static const char *Get(const StoredKey &Stored) { return Stored; }
+  static void Store(StoredKey &Stored, const char *K) { std::strncpy(Stored, K, MAX_KEYLEN - 1); }
+  static void Move(StoredKey &Dest, StoredKey &Source) { std::memcpy(Dest, Source, MAX_KEYLEN); }
+};
+
+//---------------------------------------------------------------------------
+/// @brief Default hash: the full 64-bit hash of the key, reduced by the table
+/// @tparam Key - The key type
+//---------------------------------------------------------------------------
+template <typename Key>
+struct OAHTHash
+{
+  std::uint64_t operator()(const Key &K) const
+  {
+    // std::hash is the identity for integers, so finish with a mix
+    std::uint64_t h = static_cast<std::uint64_t>(std::hash<Key>()(K));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+  }
+};
+
+/// @brief Default hash for C-string keys
+template <>
+struct OAHTHash<const char *>
+{
+  std::uint64_t operator()(const char *K) const { return WyHash64(K); }
+};
+
+/// @brief Default hash for std::string keys
+template <>
+struct OAHTHash<std::string>
+{
+  std::uint64_t operator()(const std::string &K) const { return WyHash64(K.data(), K.size()); }
+};
+
+//---------------------------------------------------------------------------
+/// @brief Default key comparison
+/// @tparam Key - The key type
+//---------------------------------------------------------------------------
+template <typename Key>
+struct OAHTKeyEqual
+{
+  bool operator()(const Key &Lhs, const Key &Rhs) const { return Lhs == Rhs; }
+};
+
+/// @brief C-string keys compare by contents
+template <>
+struct OAHTKeyEqual<const char *>
+{
+  bool operator()(const char *Lhs, const char *Rhs) const { return std::strncmp(Lhs, Rhs, MAX_KEYLEN) == 0; }
+};
+
 /// @brief OAHashTable statistical info
-struct OAHTStats
+/// @tparam Key - The key type of the table
+template <typename Key>
+struct OAHTKeyStats
 {
   /// @brief Default Constructor
-  OAHTStats() : Count_(0), TableSize_(0), Probes_(0), Expansions_(0), PrimaryHashFunc_(nullptr), SecondaryHashFunc_(nullptr) {};
+  OAHTKeyStats() : Count_(0), TableSize_(0), Probes_(0), Expansions_(0), PrimaryHashFunc_(nullptr), SecondaryHashFunc_(nullptr),
+                   PrimaryHashFunc64_(nullptr), SecondaryHashFunc64_(nullptr) {};
 
   /// @brief Number of elements in the table
   unsigned Count_;
@@ -89,18 +184,37 @@ struct OAHTStats
   /// @brief Number of times the table grew
   unsigned Expansions_;
   /// @brief Pointer to the primary hash function
-  HASHFUNC PrimaryHashFunc_;
+  typename OAHTKeyTraits<Key>::HashFunc PrimaryHashFunc_;
   /// @brief Pointer to the secondary hash function
-  HASHFUNC SecondaryHashFunc_;
+  typename OAHTKeyTraits<Key>::HashFunc SecondaryHashFunc_;
+  /// @brief Pointer to the primary 64-bit hash function (if used)
+  typename OAHTKeyTraits<Key>::HashFunc64 PrimaryHashFunc64_;
+  /// @brief Pointer to the secondary 64-bit hash function (if used)
+  typename OAHTKeyTraits<Key>::HashFunc64 SecondaryHashFunc64_;
 };
 
+/// @brief Statistics of a table with C-string keys
+typedef OAHTKeyStats<const char *> OAHTStats;
+
 /// @brief Hash table definition (open-addressing)
-/// @tparam T - data type
-template <typename T>
+/// @tparam T        - data type
+/// @tparam KeyType  - key type (C-strings by default)
+/// @tparam Hash     - hash used when the config provides no hash function
+/// @tparam KeyEqual - key comparison
+template <typename T, typename KeyType = const char *, typename Hash = OAHTHash<KeyType>, typename KeyEqual = OAHTKeyEqual<KeyType> >
 class OAHashTable
 {
   public:
 
+    /// @brief How keys are stored and hashed
+    typedef OAHTKeyTraits<KeyType> KeyTraits;
+
+    /// @brief Client-provided hash function (returns an index)
+    typedef typename KeyTraits::HashFunc KEYHASHFUNC;
+
+    /// @brief Client-provided hash function (returns the full 64-bit hash)
+    typedef typename KeyTraits::HashFunc64 KEYHASHFUNC64;
+
     /// @brief Client-provided free proc (we own the data)
     typedef void (*FREEPROC)(T);
 
@@ -117,20 +231,61 @@ class OAHashTable
       /// @param Policy            - MARK or PACK
       /// @param FreeProc          - Client-provided free function
       //----------------------------------------------------------------------------------------------------------------
-      OAHTConfig(unsigned InitialTableSize, HASHFUNC PrimaryHashFunc, HASHFUNC SecondaryHashFunc = nullptr,
+      OAHTConfig(unsigned InitialTableSize, KEYHASHFUNC PrimaryHashFunc, KEYHASHFUNC SecondaryHashFunc = nullptr,
                  double MaxLoadFactor = 0.5, double GrowthFactor = 2.0, OAHTDeletionPolicy Policy = PACK,
                  FREEPROC FreeProc = 0) :
 
               m_initial_table_size(InitialTableSize), m_primary_hash_func(PrimaryHashFunc),
-              m_secondary_hash_func(SecondaryHashFunc), m_max_load_factor(MaxLoadFactor),
+              m_secondary_hash_func(SecondaryHashFunc), m_primary_hash_func64(nullptr),
+              m_secondary_hash_func64(nullptr), m_max_load_factor(MaxLoadFactor),
+              m_growth_factor(GrowthFactor), m_oaht_deletion_policy(Policy), m_free_proc(FreeProc) {}
+
+      //----------------------------------------------------------------------------------------------------------------
+      /// @brief Non-default Constructor for 64-bit hash functions. The functions return the full hash and the
+      ///        table reduces it to an index once per lookup.
+      /// @param InitialTableSize    - The starting table size
+      /// @param PrimaryHashFunc64   - First hash function
+      /// @param SecondaryHashFunc64 - Hash function resolve collisions
+      /// @param MaxLoadFactor       - Maximum LF before growing
+      /// @param GrowthFactor        - The amount to grow the table
+      /// @param Policy              - MARK or PACK
+      /// @param FreeProc            - Client-provided free function
+      //----------------------------------------------------------------------------------------------------------------
+      OAHTConfig(unsigned InitialTableSize, KEYHASHFUNC64 PrimaryHashFunc64, KEYHASHFUNC64 SecondaryHashFunc64 = nullptr,
+                 double MaxLoadFactor = 0.5, double GrowthFactor = 2.0, OAHTDeletionPolicy Policy = PACK,
+                 FREEPROC FreeProc = 0) :
+
+              m_initial_table_size(InitialTableSize), m_primary_hash_func(nullptr),
+              m_secondary_hash_func(nullptr), m_primary_hash_func64(PrimaryHashFunc64),
+              m_secondary_hash_func64(SecondaryHashFunc64), m_max_load_factor(MaxLoadFactor),
+              m_growth_factor(GrowthFactor), m_oaht_deletion_policy(Policy), m_free_proc(FreeProc) {}
+
+      //----------------------------------------------------------------------------------------------------------------
+      /// @brief Non-default Constructor using the Hash functor of the table (linear probing)
+      /// @param InitialTableSize - The starting table size
+      /// @param MaxLoadFactor    - Maximum LF before growing
+      /// @param GrowthFactor     - The amount to grow the table
+      /// @param Policy           - MARK or PACK
+      /// @param FreeProc         - Client-provided free function
+      //----------------------------------------------------------------------------------------------------------------
+      explicit OAHTConfig(unsigned InitialTableSize, double MaxLoadFactor = 0.5, double GrowthFactor = 2.0,
+                          OAHTDeletionPolicy Policy = PACK, FREEPROC FreeProc = 0) :
+
+              m_initial_table_size(InitialTableSize), m_primary_hash_func(nullptr),
+              m_secondary_hash_func(nullptr), m_primary_hash_func64(nullptr),
+              m_secondary_hash_func64(nullptr), m_max_load_factor(MaxLoadFactor),
               m_growth_factor(GrowthFactor), m_oaht_deletion_policy(Policy), m_free_proc(FreeProc) {}
 
       /// @brief The starting size of the table
       unsigned m_initial_table_size;
-      /// @brief The hash function used in all cases
-      HASHFUNC m_primary_hash_func;
+      /// @brief The hash function used in all cases (the Hash functor is used if no function is set)
+      KEYHASHFUNC m_primary_hash_func;
       /// @brief The hush function used in double hashing, if null then linear probing will be used
-      HASHFUNC m_secondary_hash_func;
+      KEYHASHFUNC m_secondary_hash_func;
+      /// @brief 64-bit hash function used instead of m_primary_hash_func, if set
+      KEYHASHFUNC64 m_primary_hash_func64;
+      /// @brief 64-bit hash function used instead of m_secondary_hash_func, if set
+      KEYHASHFUNC64 m_secondary_hash_func64;
       /// @brief Maximum LF before growing
       double m_max_load_factor;
       /// @brief The amount to grow the table
@@ -147,8 +302,8 @@ class OAHashTable
       /// @brief The 3 possible states the slot can be in
       enum OAHTSlot_State {OCCUPIED, UNOCCUPIED, DELETED};
 
-      /// @brief Key is a string
-      char Key[MAX_KEYLEN];
+      /// @brief Key (a char array for C-string keys)
+      typename KeyTraits::StoredKey Key;
       /// @brief Client data
       T Data;
       /// @brief The state of the slot
@@ -166,14 +321,19 @@ class OAHashTable
       /// @param Key  - The key
       /// @param data - The data
       //----------------------------------------------------------------------------------------------------------------
-      OAHTSlot(const char* Key, T data);
+      OAHTSlot(const KeyType& Key, T data);
     };
 
+    /// @brief Statistics of this table
+    typedef OAHTKeyStats<KeyType> OAHTStats;
+
     //----------------------------------------------------------------------------------------------------------------
     /// @brief Non-Default Constructor
     /// @param Config - Reference to an instance of OAHTConfig
+    /// @param Hasher - Hash functor (used when the config has no hash function)
+    /// @param Equal  - Key comparison functor
     //----------------------------------------------------------------------------------------------------------------
-    explicit OAHashTable(const OAHTConfig& Config);
+    explicit OAHashTable(const OAHTConfig& Config, const Hash& Hasher = Hash(), const KeyEqual& Equal = KeyEqual());
 
     //----------------------------------------------------------------------------------------------------------------
     /// @brief Destructor
@@ -185,21 +345,44 @@ class OAHashTable
     /// @param Key  - The string key
     /// @param Data - The data to add to the table
     //----------------------------------------------------------------------------------------------------------------
-    void insert(const char *Key, const T& Data);
+    void insert(const KeyType& Key, const T& Data);
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Insert a key/data pair, moving the data into the table.
+    /// @param Key  - The key
+    /// @param Data - The data to move into the table
+    //----------------------------------------------------------------------------------------------------------------
+    void insert(const KeyType& Key, T&& Data);
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Insert a key/data pair, moving both into the table.
+    /// @param Key  - The key to move into the table
+    /// @param Data - The data to move into the table
+    //----------------------------------------------------------------------------------------------------------------
+    void insert(KeyType&& Key, T&& Data);
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Construct the data from Args in its slot once the key is known to be new (no copy or move).
+    ///        Throws an exception if the key is a duplicate (the data is never constructed in that case).
+    /// @param Key  - The key
+    /// @param args - Arguments forwarded to the constructor of T
+    //----------------------------------------------------------------------------------------------------------------
+    template <typename... Args>
+    void emplace(const KeyType& Key, Args&&... args);
 
     //----------------------------------------------------------------------------------------------------------------
     /// @brief Removes an item by key. Throws an exception if the key doesn't exist.
     ///        Compacts the table by moving key/data pairs, if necessary
     /// @param Key - The key of the pair to remove
     //----------------------------------------------------------------------------------------------------------------
-    void remove(const char *Key);
+    void remove(const KeyType& Key);
 
     //----------------------------------------------------------------------------------------------------------------
     /// @brief Find and return the data in the table by key
     /// @param Key - The key to find
     /// @return The data or an exception if the key is not found (const T&)
     //----------------------------------------------------------------------------------------------------------------
-    const T& find(const char *Key) const;
+    const T& find(const KeyType& Key) const;
 
     //----------------------------------------------------------------------------------------------------------------
     /// @brief Removes all items from the table, but does not deallocate it
@@ -234,7 +417,41 @@ class OAHashTable
     /// @param Slot - Pointer to address of the slot in the table of the key
     /// @return Index if it exists, -1 if not (int)
     //----------------------------------------------------------------------------------------------------------------
-    int IndexOf(const char *Key, int& emptyIndex) const;
+    int IndexOf(const KeyType& Key, int& emptyIndex) const;
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Grows the table if needed and finds the slot a new key goes in.
+    ///        Throws an exception if the key already exists.
+    /// @param Key - The key about to be inserted
+    /// @return Index of the slot to fill (int)
+    //----------------------------------------------------------------------------------------------------------------
+    int PrepareInsert(const KeyType& Key);
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Moves an existing slot's key and data into this table (used by GrowTable and PACK)
+    /// @param Slot - The slot to move from
+    //----------------------------------------------------------------------------------------------------------------
+    void Reinsert(OAHTSlot& Slot);
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Computes the home slot of a key with whichever primary hash function is configured
+    /// @param Key - The key to hash
+    /// @return The home index of the key (unsigned)
+    //----------------------------------------------------------------------------------------------------------------
+    unsigned HomeIndex(const KeyType& Key) const;
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Computes the probe stride of a key (1 when linear probing)
+    /// @param Key - The key to hash
+    /// @return The stride used for double hashing (unsigned)
+    //----------------------------------------------------------------------------------------------------------------
+    unsigned Stride(const KeyType& Key) const;
+
+    //----------------------------------------------------------------------------------------------------------------
+    /// @brief Is a secondary hash function configured?
+    /// @return True if the table uses double hashing (bool)
+    //----------------------------------------------------------------------------------------------------------------
+    bool IsDoubleHashing() const;
 
     //----------------------------------------------------------------------------------------------------------------
     /// @brief  Calculate the load factor of the hash table.
@@ -252,8 +469,11 @@ class OAHashTable
     /// @brief The table
     std::vector<OAHTSlot> m_Table;
 
-    /// @brief First available slot in the list
-    OAHTSlot m_available_slot;
+    /// @brief Hash functor
+    Hash m_hash;
+
+    /// @brief Key comparison functor
+    KeyEqual m_key_equal;
 };
 
 #include "OAHashTable.cpp"
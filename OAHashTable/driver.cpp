@@ -946,6 +946,115 @@ void TestSimpleMarkPack(HashData *phd, HashData *shd,  OAHTDeletionPolicy policy
   }
 }
 
+/// @brief Data that counts how it was made
+struct Counted
+{
+  static unsigned constructs, copies, moves;
+  std::string name;
+
+  Counted() : name() {}
+  Counted(const char *first, const char *last) : name(std::string(first) + " " + last) { constructs++; }
+  Counted(const Counted &rhs) : name(rhs.name) { copies++; }
+  Counted(Counted &&rhs) : name(std::move(rhs.name)) { moves++; }
+  Counted &operator=(const Counted &rhs) { name = rhs.name; copies++; return *this; }
+  Counted &operator=(Counted &&rhs) { name = std::move(rhs.name); moves++; return *this; }
+
+  static void Report(const char *what)
+  {
+    cout << what << ": constructed " << constructs << ", copied " << copies << ", moved " << moves << endl;
+    constructs = copies = moves = 0;
+  }
+};
+unsigned Counted::constructs = 0;
+unsigned Counted::copies = 0;
+unsigned Counted::moves = 0;
+
+/// @brief Integer keys, the hash is the last two digits
+struct LastTwoDigitsHash
+{
+  std::uint64_t operator()(int Key) const { return static_cast<std::uint64_t>(Key % 100); }
+};
+
+/// @brief Integer keys that are equal when their last two digits are
+struct LastTwoDigitsEqual
+{
+  bool operator()(int Lhs, int Rhs) const { return Lhs % 100 == Rhs % 100; }
+};
+
+void TestGenericKeys()
+{
+  cout << endl << "==================== TestGenericKeys ====================" << endl;
+
+  // std::string keys with the default hash, moving inserts and emplace
+  {
+    typedef Counted T;
+    OAHashTable<T, std::string> ht(OAHashTable<T, std::string>::OAHTConfig(7, 0.5, 2.0, PACK));
+
+    T faith("Ian", "Faith");
+    Counted::Report("made");
+    ht.insert(std::string(PEOPLE[0].ID), faith);
+    Counted::Report("insert copy");
+    T tufnel("Nigel", "Tufnel");
+    T savage("Viv", "Savage");
+    Counted::Report("made");
+    ht.insert(std::string(PEOPLE[1].ID), std::move(tufnel));
+    Counted::Report("insert(const Key&, T&&)");
+    std::string key = PEOPLE[2].ID;
+    ht.insert(std::move(key), std::move(savage));
+    Counted::Report("insert(Key&&, T&&)");
+    for (unsigned i = 3; i < 10; i++)
+      ht.emplace(std::string(PEOPLE[i].ID), PEOPLE[i].firstName, PEOPLE[i].lastName);
+    Counted::Report("emplace x7 (moves are the table growing twice)");
+
+    try
+    {
+      ht.emplace(std::string(PEOPLE[5].ID), "No", "Body");
+    }
+    catch (OAHashTableException &e)
+    {
+      cout << "errno: " << e.code() << ", " << e.what() << endl;
+    }
+    Counted::Report("emplace duplicate");
+
+    for (unsigned i = 0; i < 10; i++)
+      cout << PEOPLE[i].ID << ": " << ht.find(PEOPLE[i].ID).name << endl;
+    cout << "Items: " << ht.GetStats().Count_ << ", TableSize: " << ht.GetStats().TableSize_ << ", expansions: "
+         << ht.GetStats().Expansions_ << endl;
+    Counted::Report("find");
+  }
+
+  // int keys with a custom hash and a custom equality
+  {
+    typedef int T;
+    typedef OAHashTable<T, int, LastTwoDigitsHash, LastTwoDigitsEqual> Table;
+    Table ht(Table::OAHTConfig(7, 1.0, 2.0, PACK));
+
+    // 6 and 13 both hash to slot 6, 13 wraps around to slot 0
+    ht.insert(6, 600);
+    ht.insert(13, 1300);
+    ht.insert(20, 2000);
+    try
+    {
+      ht.insert(106, 10600);
+    }
+    catch (OAHashTableException &e)
+    {
+      cout << "insert 106: errno: " << e.code() << ", " << e.what() << endl;
+    }
+    cout << "find 113: " << ht.find(113) << endl;
+
+    // Removing the last slot packs the cluster that wrapped around
+    ht.remove(6);
+    cout << "after remove 6: find 13: " << ht.find(13) << ", find 20: " << ht.find(20) << ", items: "
+         << ht.GetStats().Count_ << endl;
+    for (unsigned i = 0; i < ht.GetStats().TableSize_; i++)
+    {
+      if (ht.GetTable()[i].State == Table::OAHTSlot::OCCUPIED)
+        cout << "Slot: " << i << ", Key: " << ht.GetTable()[i].Key << endl;
+    }
+  }
+}
+
 /*
   Why are the hashes so different when the same function is used for
   both primary and secondary hash? e.g. TableSize is 13:
@@ -1043,6 +1152,10 @@ int main(int argc, char **argv)
       TestDoubleHashing(&HashingFuncs[PJW], &HashingFuncs[SIMPLE]);
       break;
 
+    case 15:
+      TestGenericKeys();
+      break;
+
     default:
       TestALot(&HashingFuncs[SIMPLE], &HashingFuncs[NONE]);
       TestSimpleGrow1();         